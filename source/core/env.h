@@ -27,6 +27,38 @@
  */
 #define GLADIUS_ENV_TOOL_FE_VERBOSE_NAME "GLADIUS_TOOL_FE_VERBOSE"
 
+/**
+ * If this environment variable is set, then the tool tree and its daemons stay
+ * up between plugin sessions (see the terminal's session command).
+ */
+#define GLADIUS_ENV_TOOL_FE_PERSISTENT_NAME "GLADIUS_TOOL_FE_PERSISTENT"
+
+/**
+ * If this environment variable is set, then the tool front-end builds its
+ * tree from the specified MRNet topology file instead of generating one.
+ */
+#define GLADIUS_ENV_TOOL_FE_TOPO_FILE_NAME "GLADIUS_TOOL_FE_TOPO_FILE"
+
+/**
+ * How plugin streams that support it gather results from the back-ends: "all"
+ * (wait for all), "window:MS" (whatever arrives within MS milliseconds), or
+ * "first:K:MS" (the first K back-ends, or whatever arrives within MS
+ * milliseconds). See mrnet/sync-stream.h.
+ */
+#define GLADIUS_ENV_TOOL_STREAM_SYNC_NAME "GLADIUS_TOOL_STREAM_SYNC"
+
+/**
+ * Milliseconds between top plugin redraws (and back-end samples). Default:
+ * 1000.
+ */
+#define GLADIUS_ENV_TOP_REFRESH_MS_NAME "GLADIUS_TOP_REFRESH_MS"
+
+/**
+ * The TCP port that the lprof plugin serves Legion profiling records on.
+ * Default: 41414.
+ */
+#define GLADIUS_ENV_LPROF_PORT_NAME "GLADIUS_LPROF_PORT"
+
 /**
  * If this environment variable is set, then the tool back-end will be verbose
  * about its actions.
@@ -40,6 +72,27 @@
  */
 #define GLADIUS_ENV_TOOL_BE_LOG_DIR_NAME "GLADIUS_TOOL_BE_LOG_DIR"
 
+/**
+ * How long (in seconds) a tool back-end waits for its connection info to be
+ * published. The application may be launched before the tool tree is up.
+ */
+#define GLADIUS_ENV_TOOL_BE_CONNECT_TIMEOUT_NAME \
+    "GLADIUS_TOOL_BE_CONNECT_TIMEOUT_S"
+
+/**
+ * How often (in seconds) tool back-ends tell the front-end that they are still
+ * alive. 0 disables heartbeats.
+ */
+#define GLADIUS_ENV_TOOL_HEARTBEAT_INTERVAL_NAME \
+    "GLADIUS_TOOL_HEARTBEAT_INTERVAL_S"
+
+/**
+ * The number of heartbeats in a row that a tool back-end may miss before the
+ * front-end considers it lost.
+ */
+#define GLADIUS_ENV_TOOL_HEARTBEAT_MAX_MISSED_NAME \
+    "GLADIUS_TOOL_HEARTBEAT_MAX_MISSED"
+
 
 /**
  * If this environment variable is set, then the tool will not colorize its
@@ -62,6 +115,16 @@
  */
 #define GLADIUS_ENV_GLADIUS_SESSION_KEY "GLADIUS_SESSION_KEY"
 
+/**
+ * Set by the local launcher: the rank of a locally forked process.
+ */
+#define GLADIUS_ENV_LOCAL_RANK_NAME "GLADIUS_LOCAL_RANK"
+
+/**
+ * Set by the local launcher: the number of locally forked processes.
+ */
+#define GLADIUS_ENV_LOCAL_SIZE_NAME "GLADIUS_LOCAL_SIZE"
+
 namespace gladius {
 namespace core {
 /**
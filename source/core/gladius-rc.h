@@ -21,5 +21,7 @@ enum {
     GLADIUS_ERR_MRNET,
     GLADIUS_ENV_NOT_SET,
     GLADIUS_NOT_CONNECTED,
-    GLADIUS_PLUGIN_NOT_FOUND
+    GLADIUS_PLUGIN_NOT_FOUND,
+    GLADIUS_TIMEOUT,
+    GLADIUS_EOF
 };
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Implements a buffered, non-blocking line reader. Data are read from the file
+ * descriptor in large chunks into a ring buffer and newlines are found with
+ * memchr(3), so we no longer pay a read(2) per byte. Timeouts are implemented
+ * with poll(2).
+ */
+
+#include "core/line-reader.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+using namespace gladius::core;
+
+namespace {
+
+/**
+ * Returns the smallest power of two that is >= n.
+ */
+size_t
+roundUpPow2(size_t n)
+{
+    size_t res = 1;
+    while (res < n) res <<= 1;
+    return res;
+}
+
+/**
+ * Returns the number of milliseconds left until deadline. -1 means no
+ * deadline.
+ */
+int
+msLeft(
+    bool hasDeadline,
+    const std::chrono::steady_clock::time_point &deadline
+) {
+    using namespace std::chrono;
+    if (!hasDeadline) return -1;
+    const auto left = duration_cast<milliseconds>(
+                          deadline - steady_clock::now()
+                      ).count();
+    return (left > 0) ? int(left) : 0;
+}
+
+} // end namespace
+
+/**
+ *
+ */
+LineReader::~LineReader(void)
+{
+    if (mBuf) free(mBuf);
+    mBuf = nullptr;
+}
+
+/**
+ * Initializes the reader. Sets O_NONBLOCK on fd; the reader does not take
+ * ownership of it.
+ */
+int
+LineReader::init(
+    int fd,
+    size_t initBufSize
+) {
+    mFD = fd;
+    mHead = mTail = mScanned = 0;
+    mEOF = false;
+    //
+    mCap = roundUpPow2(initBufSize ? initBufSize : sDefaultBufSize);
+    if (mBuf) free(mBuf);
+    mBuf = (char *)malloc(mCap);
+    if (!mBuf) GLADIUS_THROW_OOR();
+    //
+    const int flags = fcntl(mFD, F_GETFL);
+    if (-1 == flags || -1 == fcntl(mFD, F_SETFL, flags | O_NONBLOCK)) {
+        int err = errno;
+        GLADIUS_CERR << utils::formatCallFailed(
+                            "fcntl(2): " + utils::getStrError(err),
+                            GLADIUS_WHERE
+                        )
+                     << std::endl;
+        return GLADIUS_ERR_SYS;
+    }
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Looks for a newline in the buffered data. Returns true and sets lineLen (not
+ * including the newline) if one was found. Bytes that have already been
+ * scanned are not scanned again.
+ */
+bool
+LineReader::mFindNewline(
+    size_t &lineLen
+) {
+    const size_t mask = mCap - 1;
+    const size_t nBuffered = mNBuffered();
+    while (mScanned < nBuffered) {
+        const size_t start = (mHead + mScanned) & mask;
+        // Contiguous bytes that we can search from start.
+        size_t n = nBuffered - mScanned;
+        if (start + n > mCap) n = mCap - start;
+        //
+        const char *nl = (const char *)memchr(mBuf + start, '\n', n);
+        if (nl) {
+            lineLen = mScanned + (nl - (mBuf + start));
+            return true;
+        }
+        mScanned += n;
+    }
+    return false;
+}
+
+/**
+ * Doubles the size of the ring buffer, linearizing its contents.
+ */
+void
+LineReader::mGrow(void)
+{
+    const size_t newCap = mCap * 2;
+    char *newBuf = (char *)malloc(newCap);
+    if (!newBuf) GLADIUS_THROW_OOR();
+    //
+    const size_t nBuffered = mNBuffered();
+    const size_t start = mHead & (mCap - 1);
+    const size_t first = std::min(nBuffered, mCap - start);
+    memcpy(newBuf, mBuf + start, first);
+    memcpy(newBuf + first, mBuf, nBuffered - first);
+    //
+    free(mBuf);
+    mBuf = newBuf;
+    mCap = newCap;
+    mHead = 0;
+    mTail = nBuffered;
+}
+
+/**
+ * Waits up to timeoutInMS for data and reads as much as will fit into the ring
+ * buffer with a single readv(2).
+ */
+int
+LineReader::mFill(int timeoutInMS)
+{
+    if (mNBuffered() == mCap) mGrow();
+    //
+    struct pollfd pfd;
+    pfd.fd = mFD;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int prc = 0;
+    do {
+        prc = poll(&pfd, 1, timeoutInMS);
+    } while (-1 == prc && EINTR == errno);
+    if (-1 == prc) {
+        int err = errno;
+        GLADIUS_CERR << utils::formatCallFailed(
+                            "poll(2): " + utils::getStrError(err),
+                            GLADIUS_WHERE
+                        )
+                     << std::endl;
+        return GLADIUS_ERR_IO;
+    }
+    if (0 == prc) return GLADIUS_TIMEOUT;
+    // Free space is (at most) two contiguous regions.
+    const size_t mask = mCap - 1;
+    const size_t nFree = mCap - mNBuffered();
+    const size_t tail = mTail & mask;
+    struct iovec iov[2];
+    iov[0].iov_base = mBuf + tail;
+    iov[0].iov_len = std::min(nFree, mCap - tail);
+    iov[1].iov_base = mBuf;
+    iov[1].iov_len = nFree - iov[0].iov_len;
+    const int iovcnt = (0 == iov[1].iov_len) ? 1 : 2;
+    //
+    ssize_t nRead = 0;
+    do {
+        nRead = readv(mFD, iov, iovcnt);
+    } while (-1 == nRead && EINTR == errno);
+    if (-1 == nRead) {
+        int err = errno;
+        // Spurious wakeup. Let the caller try again.
+        if (EAGAIN == err || EWOULDBLOCK == err) return GLADIUS_SUCCESS;
+        GLADIUS_CERR << utils::formatCallFailed(
+                            "readv(2): " + utils::getStrError(err),
+                            GLADIUS_WHERE
+                        )
+                     << std::endl;
+        return GLADIUS_ERR_IO;
+    }
+    if (0 == nRead) {
+        mEOF = true;
+        return GLADIUS_EOF;
+    }
+    mTail += nRead;
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Appends n bytes from the front of the ring buffer to out and consumes them.
+ */
+void
+LineReader::mConsumeInto(
+    std::string &out,
+    size_t n
+) {
+    const size_t start = mHead & (mCap - 1);
+    const size_t first = std::min(n, mCap - start);
+    out.append(mBuf + start, first);
+    out.append(mBuf, n - first);
+    mHead += n;
+}
+
+/**
+ * Reads a single line (without its trailing newline) into line. Returns
+ * GLADIUS_TIMEOUT if a complete line did not arrive within timeoutInMS (-1
+ * means wait forever) and GLADIUS_EOF at end of file. A final unterminated
+ * line is returned as a line.
+ */
+int
+LineReader::readLine(
+    std::string &line,
+    int timeoutInMS
+) {
+    using namespace std::chrono;
+    //
+    const bool hasDeadline = (timeoutInMS >= 0);
+    const auto deadline = steady_clock::now() + milliseconds(timeoutInMS);
+    //
+    line.clear();
+    do {
+        size_t lineLen = 0;
+        if (mFindNewline(lineLen)) {
+            mConsumeInto(line, lineLen);
+            // Skip the newline.
+            mHead += 1;
+            mScanned = 0;
+            return GLADIUS_SUCCESS;
+        }
+        if (mEOF) {
+            if (0 == mNBuffered()) return GLADIUS_EOF;
+            mConsumeInto(line, mNBuffered());
+            mScanned = 0;
+            return GLADIUS_SUCCESS;
+        }
+        const int rc = mFill(msLeft(hasDeadline, deadline));
+        if (GLADIUS_SUCCESS != rc && GLADIUS_EOF != rc) return rc;
+    } while (true);
+}
+
+/**
+ * Reads lines into result (each terminated by a newline) until a line equal to
+ * endLine is read. Lines are appended straight from the ring buffer, so no
+ * intermediate strings are built.
+ */
+int
+LineReader::readUntilLine(
+    const std::string &endLine,
+    std::string &result,
+    bool includeEndLine,
+    int timeoutInMS
+) {
+    using namespace std::chrono;
+    //
+    const bool hasDeadline = (timeoutInMS >= 0);
+    const auto deadline = steady_clock::now() + milliseconds(timeoutInMS);
+    //
+    result.clear();
+    do {
+        size_t lineLen = 0;
+        if (mFindNewline(lineLen)) {
+            const size_t lineStart = result.size();
+            mConsumeInto(result, lineLen);
+            mHead += 1;
+            mScanned = 0;
+            const bool atEnd = (lineLen == endLine.size())
+                            && (0 == result.compare(lineStart, lineLen,
+                                                    endLine));
+            if (atEnd && !includeEndLine) {
+                result.resize(lineStart);
+                return GLADIUS_SUCCESS;
+            }
+            result.push_back('\n');
+            if (atEnd) return GLADIUS_SUCCESS;
+            continue;
+        }
+        if (mEOF) return GLADIUS_EOF;
+        const int rc = mFill(msLeft(hasDeadline, deadline));
+        if (GLADIUS_SUCCESS != rc && GLADIUS_EOF != rc) return rc;
+    } while (true);
+}
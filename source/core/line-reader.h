@@ -0,0 +1,111 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * A buffered, non-blocking line reader for file descriptors. Used by the
+ * components that talk to line-oriented child processes (e.g. GDB/MI, dsys).
+ */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace gladius {
+namespace core {
+
+class LineReader {
+private:
+    // Default ring buffer capacity. Must be a power of two.
+    static constexpr size_t sDefaultBufSize = 1024 * 64;
+    // File descriptor we are reading from.
+    int mFD = -1;
+    // Ring buffer storage.
+    char *mBuf = nullptr;
+    // Ring buffer capacity (always a power of two).
+    size_t mCap = 0;
+    // Read position. Free-running; masked on use.
+    size_t mHead = 0;
+    // Write position. Free-running; masked on use.
+    size_t mTail = 0;
+    // Number of bytes past mHead that are known not to contain a newline.
+    size_t mScanned = 0;
+    // Whether or not we have seen EOF on mFD.
+    bool mEOF = false;
+    //
+    size_t
+    mNBuffered(void) const {
+        return mTail - mHead;
+    }
+    //
+    bool
+    mFindNewline(size_t &lineLen);
+    //
+    void
+    mGrow(void);
+    //
+    int
+    mFill(int timeoutInMS);
+    //
+    void
+    mConsumeInto(
+        std::string &out,
+        size_t n
+    );
+
+public:
+    //
+    LineReader(void) = default;
+    //
+    ~LineReader(void);
+    //
+    LineReader(const LineReader &other) = delete;
+    //
+    LineReader &
+    operator=(const LineReader &other) = delete;
+    //
+    int
+    init(
+        int fd,
+        size_t initBufSize = sDefaultBufSize
+    );
+    //
+    int
+    readLine(
+        std::string &line,
+        int timeoutInMS = -1
+    );
+    //
+    int
+    readUntilLine(
+        const std::string &endLine,
+        std::string &result,
+        bool includeEndLine,
+        int timeoutInMS = -1
+    );
+
+    /**
+     * Returns the file descriptor that we are reading from.
+     */
+    int
+    fd(void) const {
+        return mFD;
+    }
+
+    /**
+     * Returns whether or not EOF has been reached on the underlying file
+     * descriptor and all buffered data have been consumed.
+     */
+    bool
+    eof(void) const {
+        return mEOF && 0 == mNBuffered();
+    }
+};
+
+} // end core namespace
+} // end gladius namespace
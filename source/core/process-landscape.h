@@ -8,81 +8,221 @@
 
 /**
  * Gives the 'process landscape' of a parallel and distributed application
- * wherein the used hosts and number of targets for each host is maintained.
+ * wherein the used hosts, the number of targets for each host, and (when
+ * known) the ranks that each host is running are maintained.
  */
 
 #pragma once
 
 #include "core/core.h"
 #include "core/macros.h"
+#include "core/rank-set.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
-#include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace gladius {
 namespace core {
 
 class ProcessLandscape {
-    // Mapping between hostnames and the number of processes they'll be hosting.
-    // Guaranteed to be unique by host name.
-    std::map<std::string, int> mLandscape;
+public:
+    //
+    typedef core::RankSet RankSet;
+
+    /**
+     * What we know about a host.
+     */
+    struct Host {
+        // The host's name.
+        std::string name;
+        // The number of processes that it will be hosting.
+        int nProcs = 0;
+        // The ranks of those processes. Empty if the ranks are not known.
+        RankSet ranks;
+    };
+
+private:
+    // Hosts in insertion order. A host's index is its ID.
+    std::vector<Host> mHosts;
+    // Mapping between host names and host IDs. Guaranteed to be unique by host
+    // name.
+    std::unordered_map<std::string, size_t> mHostIDs;
+    // Cached total number of processes across all the hosts.
+    size_t mNProcesses = 0;
+    // Cached set of all the host names.
+    std::set<std::string> mHostNames;
+    //
+    struct RankRange {
+        RankSet::Rank lo;
+        RankSet::Rank hi;
+        size_t hostID;
+    };
+    // Rank ranges of all the hosts sorted by first rank, for hostIDOfRank.
+    // Built lazily.
+    mutable std::vector<RankRange> mRankRanges;
+    //
+    mutable bool mRankRangesDirty = true;
+
+    /**
+     *
+     */
+    void
+    mBuildRankRanges(void) const {
+        mRankRanges.clear();
+        for (size_t hid = 0; hid < mHosts.size(); ++hid) {
+            mHosts[hid].ranks.forEachRange(
+                [&](RankSet::Rank lo, RankSet::Rank hi) {
+                    mRankRanges.push_back(RankRange{lo, hi, hid});
+                }
+            );
+        }
+        std::sort(
+            mRankRanges.begin(),
+            mRankRanges.end(),
+            [](const RankRange &a, const RankRange &b) { return a.lo < b.lo; }
+        );
+        mRankRangesDirty = false;
+    }
+
 public:
     /**
      *
      */
     ProcessLandscape(void) { ; }
+
     /**
-     * Returns a const reference to the current landscape.
+     * Returns all the hosts in the current landscape. A host's index is its
+     * ID.
      */
-    const std::map<std::string, int> &
-    landscape(void) const {
-        return mLandscape;
+    const std::vector<Host> &
+    hosts(void) const {
+        return mHosts;
     }
+
     /**
      * Returns a set of all the host names in the current landscape.
      */
-    const std::set<std::string>
+    const std::set<std::string> &
     hostNames(void) const {
-        std::set<std::string> res;
-        for (const auto mi : mLandscape) {
-            res.insert(mi.first);
-        }
-        return res;
+        return mHostNames;
     }
+
     /**
      * Returns the number of hosts.
      */
     size_t
     nHosts(void) const {
-        return mLandscape.size();
+        return mHosts.size();
     }
+
     /**
      * Returns the total number of tasks across all the hosts.
      */
     size_t
     nProcesses(void) const {
-        size_t res = 0;
-        for (const auto &mi : mLandscape) {
-            res += mi.second;
+        return mNProcesses;
+    }
+
+    /**
+     * Returns the ID of the given host, or -1 if it is not in the landscape.
+     */
+    int
+    hostID(const std::string &hn) const {
+        const auto found = mHostIDs.find(hn);
+        return (found == mHostIDs.end()) ? -1 : int(found->second);
+    }
+
+    /**
+     * Returns the host with the given ID.
+     */
+    const Host &
+    host(size_t hid) const {
+        return mHosts.at(hid);
+    }
+
+    /**
+     * Returns the number of processes on the given host (0 if the host is not
+     * in the landscape).
+     */
+    int
+    nProcsOnHost(const std::string &hn) const {
+        const int hid = hostID(hn);
+        return (-1 == hid) ? 0 : mHosts[hid].nProcs;
+    }
+
+    /**
+     * Returns the ID of the host running the given rank, or -1 if that is not
+     * known. O(log(number of rank ranges)).
+     */
+    int
+    hostIDOfRank(RankSet::Rank rank) const {
+        if (mRankRangesDirty) mBuildRankRanges();
+        auto it = std::upper_bound(
+                      mRankRanges.begin(),
+                      mRankRanges.end(),
+                      rank,
+                      [](RankSet::Rank r, const RankRange &rr) {
+                          return r < rr.lo;
+                      }
+                  );
+        if (it == mRankRanges.begin()) return -1;
+        --it;
+        return (rank <= it->hi) ? int(it->hostID) : -1;
+    }
+
+    /**
+     * Returns whether or not every host's ranks are known.
+     */
+    bool
+    haveRanks(void) const {
+        for (const auto &h : mHosts) {
+            if (size_t(h.nProcs) != h.ranks.size()) return false;
         }
-        return res;
+        return !mHosts.empty();
     }
+
     /**
-     *
+     * Adds (or updates) a host that will be running nProc processes whose ranks
+     * are given by ranks (which may be empty if they are not known).
      */
     int
     insert(
         const std::string &hn,
-        int nProc
+        int nProc,
+        const RankSet &ranks = RankSet()
     ) {
         using namespace std;
+        //
+        if (nProc < 0) return GLADIUS_ERR;
+        if (!ranks.empty() && ranks.size() != size_t(nProc)) {
+            GLADIUS_CERR << hn << ": rank count does not match process count"
+                         << endl;
+            return GLADIUS_ERR;
+        }
+        auto found = mHostIDs.find(hn);
         // Already in the table. Warn and just update.
-        if (0 != mLandscape.count(hn)) {
+        if (found != mHostIDs.end()) {
             GLADIUS_CERR_WARN << hn << " already in table..." << endl;
+            Host &h = mHosts[found->second];
+            mNProcesses -= h.nProcs;
+            h.nProcs = nProc;
+            h.ranks = ranks;
+        }
+        else {
+            mHostIDs.insert(make_pair(hn, mHosts.size()));
+            mHosts.push_back(Host());
+            Host &h = mHosts.back();
+            h.name = hn;
+            h.nProcs = nProc;
+            h.ranks = ranks;
+            mHostNames.insert(hn);
         }
-        mLandscape[hn] = nProc;
+        mNProcesses += nProc;
+        mRankRangesDirty = true;
         //
         return GLADIUS_SUCCESS;
     }
@@ -0,0 +1,480 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * A compressed set of ranks for results that are aggregated on their way up
+ * the MRNet tree. Header-only, so filters can use it without extra link-time
+ * dependencies.
+ */
+
+#pragma once
+
+#include "core/gladius-rc.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace gladius {
+namespace core {
+
+/**
+ * The MRNet packet format of a serialized RankSet (see RankSet::serialize).
+ */
+#define GLADIUS_RANK_SET_PACKET_FORMAT "%auld"
+
+/**
+ * A set of ranks stored as sorted segments, each of which is either a run of
+ * at least sMinIntervalLen consecutive ranks (an interval) or a 64-bit bitmap
+ * of nearby ranks. Dense blocks cost 16 B no matter their size, and scattered
+ * ranks cost about a bit each, so sets stay small at the root of large trees.
+ * Ranks must be less than 2^31.
+ */
+class RankSet {
+public:
+    //
+    typedef uint32_t Rank;
+
+private:
+    //
+    struct Segment {
+        // Interval: first rank. Bitmap: rank of bit 0 (a multiple of 64).
+        Rank lo;
+        // Interval: last rank. Unused by bitmaps.
+        Rank hi;
+        // Bitmap of ranks [lo, lo + 63]. Always 0 for intervals.
+        uint64_t bits;
+    };
+    // Runs at least this long are stored as intervals.
+    static constexpr Rank sMinIntervalLen = 64;
+    // Tags a serialized bitmap header word.
+    static constexpr uint64_t sBitmapTag = uint64_t(1) << 63;
+    // Segments in ascending order. Segments never overlap.
+    std::vector<Segment> mSegs;
+    // Number of ranks in the set.
+    size_t mSize = 0;
+
+    /**
+     * Returns the smallest rank in seg.
+     */
+    static Rank
+    sMin(const Segment &seg) {
+        return seg.bits ? seg.lo + __builtin_ctzll(seg.bits) : seg.lo;
+    }
+
+    /**
+     * Returns the largest rank in seg.
+     */
+    static Rank
+    sMax(const Segment &seg) {
+        return seg.bits ? seg.lo + 63 - __builtin_clzll(seg.bits) : seg.hi;
+    }
+
+    /**
+     * Calls f(lo, hi) for each run of consecutive ranks in a bitmap segment.
+     */
+    template <typename F>
+    static void
+    sForEachBitmapRun(
+        const Segment &seg,
+        F f
+    ) {
+        uint64_t w = seg.bits;
+        while (w) {
+            const int s = __builtin_ctzll(w);
+            const uint64_t inv = ~(w >> s);
+            const int len = inv ? __builtin_ctzll(inv) : 64 - s;
+            f(seg.lo + s, seg.lo + s + len - 1);
+            w = (s + len >= 64) ? 0 : (w & ~(((uint64_t(1) << len) - 1) << s));
+        }
+    }
+
+    /**
+     * Adds rank to the set. rank must be greater than every rank in the set.
+     */
+    void
+    mAppendBit(Rank rank) {
+        const Rank base = rank & ~Rank(63);
+        if (mSegs.empty() || !mSegs.back().bits || mSegs.back().lo != base) {
+            mSegs.push_back(Segment{base, 0, 0});
+        }
+        mSegs.back().bits |= uint64_t(1) << (rank - base);
+        ++mSize;
+    }
+
+    /**
+     * Returns the first rank of the run of consecutive ranks that ends at the
+     * set's maximum, which must be held in a bitmap.
+     */
+    Rank
+    mTrailingBitmapRunStart(void) const {
+        Rank start = sMax(mSegs.back());
+        for (size_t s = mSegs.size(); s-- > 0 && mSegs[s].bits; ) {
+            const Segment &seg = mSegs[s];
+            if (start > sMax(seg) + 1) break;
+            while (start > seg.lo && (seg.bits >> (start - 1 - seg.lo)) & 1) {
+                --start;
+            }
+            if (start != seg.lo) break;
+        }
+        return start;
+    }
+
+    /**
+     * Removes every rank >= from that is held in trailing bitmaps.
+     */
+    void
+    mClearBitmapTail(Rank from) {
+        while (!mSegs.empty() && mSegs.back().bits) {
+            Segment &seg = mSegs.back();
+            if (from <= seg.lo) {
+                mSize -= __builtin_popcountll(seg.bits);
+                mSegs.pop_back();
+                continue;
+            }
+            if (from <= seg.lo + 63) {
+                const uint64_t keep = (uint64_t(1) << (from - seg.lo)) - 1;
+                mSize -= __builtin_popcountll(seg.bits & ~keep);
+                seg.bits &= keep;
+                // A segment without bits would read as an interval.
+                if (!seg.bits) mSegs.pop_back();
+            }
+            break;
+        }
+    }
+
+    /**
+     * Adds [lo, hi] to the set. lo must be greater than every rank in the set.
+     * Keeps the representation canonical: runs of at least sMinIntervalLen
+     * are intervals and everything else is in bitmaps.
+     */
+    void
+    mAppendRange(
+        Rank lo,
+        Rank hi
+    ) {
+        if (!mSegs.empty()) {
+            Segment &last = mSegs.back();
+            if (!last.bits && lo == last.hi + 1) {
+                mSize += hi - lo + 1;
+                last.hi = hi;
+                return;
+            }
+            if (last.bits && lo == sMax(last) + 1) {
+                // This range extends a run that is (so far) held in bitmaps.
+                const Rank runLo = mTrailingBitmapRunStart();
+                if (hi - runLo + 1 >= sMinIntervalLen) {
+                    mClearBitmapTail(runLo);
+                    mSegs.push_back(Segment{runLo, hi, 0});
+                    mSize += hi - runLo + 1;
+                    return;
+                }
+            }
+        }
+        if (hi - lo + 1 >= sMinIntervalLen) {
+            mSegs.push_back(Segment{lo, hi, 0});
+            mSize += hi - lo + 1;
+            return;
+        }
+        for (Rank r = lo; r <= hi; ++r) mAppendBit(r);
+    }
+
+public:
+    //
+    RankSet(void) = default;
+
+    /**
+     * Returns whether or not the set is empty.
+     */
+    bool
+    empty(void) const {
+        return mSegs.empty();
+    }
+
+    /**
+     * Returns the number of ranks in the set.
+     */
+    size_t
+    size(void) const {
+        return mSize;
+    }
+
+    /**
+     * Returns the number of segments used to store the set.
+     */
+    size_t
+    nSegments(void) const {
+        return mSegs.size();
+    }
+
+    /**
+     * Returns the smallest rank in the set. The set must not be empty.
+     */
+    Rank
+    min(void) const {
+        return sMin(mSegs.front());
+    }
+
+    /**
+     * Returns the largest rank in the set. The set must not be empty.
+     */
+    Rank
+    max(void) const {
+        return sMax(mSegs.back());
+    }
+
+    /**
+     *
+     */
+    void
+    clear(void) {
+        mSegs.clear();
+        mSize = 0;
+    }
+
+    /**
+     * Calls f(lo, hi) for each maximal run of consecutive ranks in ascending
+     * order.
+     */
+    template <typename F>
+    void
+    forEachRange(F f) const {
+        bool pending = false;
+        Rank plo = 0, phi = 0;
+        auto visit = [&](Rank lo, Rank hi) {
+            if (pending && lo == phi + 1) {
+                phi = hi;
+                return;
+            }
+            if (pending) f(plo, phi);
+            pending = true;
+            plo = lo;
+            phi = hi;
+        };
+        for (const auto &seg : mSegs) {
+            if (seg.bits) sForEachBitmapRun(seg, visit);
+            else visit(seg.lo, seg.hi);
+        }
+        if (pending) f(plo, phi);
+    }
+
+    /**
+     * Returns whether or not rank is in the set. O(log(nSegments)).
+     */
+    bool
+    contains(Rank rank) const {
+        size_t lo = 0, hi = mSegs.size();
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (sMax(mSegs[mid]) < rank) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo == mSegs.size()) return false;
+        const Segment &seg = mSegs[lo];
+        if (!seg.bits) return rank >= seg.lo && rank <= seg.hi;
+        return rank >= seg.lo && ((seg.bits >> (rank - seg.lo)) & 1);
+    }
+
+    /**
+     * Adds [lo, hi] to the set. Constant time when ranks arrive in ascending
+     * order; otherwise linear in the number of segments.
+     */
+    void
+    insert(
+        Rank lo,
+        Rank hi
+    ) {
+        if (lo > hi) return;
+        if (empty() || lo > max()) {
+            mAppendRange(lo, hi);
+            return;
+        }
+        RankSet other;
+        other.mAppendRange(lo, hi);
+        merge(other);
+    }
+
+    /**
+     * Adds rank to the set.
+     */
+    void
+    insert(Rank rank) {
+        if (!empty() && rank <= max() && contains(rank)) return;
+        insert(rank, rank);
+    }
+
+    /**
+     * Set union. Linear in the number of segments of both sets, and
+     * proportional to other's size alone when other's ranks all follow ours
+     * (the common case when merging children in rank order).
+     */
+    void
+    merge(const RankSet &other) {
+        if (other.empty()) return;
+        if (empty()) {
+            *this = other;
+            return;
+        }
+        if (other.min() > max()) {
+            other.forEachRange([this](Rank lo, Rank hi) {
+                mAppendRange(lo, hi);
+            });
+            return;
+        }
+        // Merge the two range streams.
+        std::vector<std::pair<Rank, Rank> > a, b;
+        forEachRange([&a](Rank lo, Rank hi) { a.emplace_back(lo, hi); });
+        other.forEachRange([&b](Rank lo, Rank hi) { b.emplace_back(lo, hi); });
+        RankSet res;
+        bool pending = false;
+        Rank plo = 0, phi = 0;
+        size_t ai = 0, bi = 0;
+        while (ai < a.size() || bi < b.size()) {
+            const bool takeA = (bi == b.size())
+                            || (ai < a.size() && a[ai].first <= b[bi].first);
+            const auto next = takeA ? a[ai++] : b[bi++];
+            if (pending && next.first <= phi + 1) {
+                if (next.second > phi) phi = next.second;
+                continue;
+            }
+            if (pending) res.mAppendRange(plo, phi);
+            pending = true;
+            plo = next.first;
+            phi = next.second;
+        }
+        if (pending) res.mAppendRange(plo, phi);
+        *this = std::move(res);
+    }
+
+    /**
+     * Returns the set in range notation, e.g. [0-1023,2048-4095].
+     */
+    std::string
+    str(void) const {
+        std::string res = "[";
+        bool first = true;
+        forEachRange([&](Rank lo, Rank hi) {
+            if (!first) res += ",";
+            first = false;
+            res += std::to_string(lo);
+            if (hi != lo) res += "-" + std::to_string(hi);
+        });
+        return res + "]";
+    }
+
+    /**
+     * Replaces the set with one read from range notation (see str). The
+     * brackets are optional. Returns GLADIUS_ERR (and leaves the set empty) if
+     * s is malformed.
+     */
+    int
+    fromStr(const std::string &s) {
+        clear();
+        size_t b = 0, e = s.size();
+        if (b < e && '[' == s[b]) ++b;
+        if (b < e && ']' == s[e - 1]) --e;
+        while (b < e) {
+            char *end = nullptr;
+            const unsigned long lo = strtoul(s.c_str() + b, &end, 10);
+            if (end == s.c_str() + b) goto bad;
+            b = end - s.c_str();
+            unsigned long hi = lo;
+            if (b < e && '-' == s[b]) {
+                const char *hs = s.c_str() + ++b;
+                hi = strtoul(hs, &end, 10);
+                if (end == hs) goto bad;
+                b = end - s.c_str();
+            }
+            if (lo > hi || hi >= (1UL << 31) || b > e) goto bad;
+            insert(Rank(lo), Rank(hi));
+            if (b < e && ',' != s[b++]) goto bad;
+        }
+        return GLADIUS_SUCCESS;
+    bad:
+        clear();
+        return GLADIUS_ERR;
+    }
+
+    /**
+     * Appends the set's wire form to out. An interval is one word,
+     * (hi << 32) | lo. A bitmap is two words: a header, sBitmapTag | base,
+     * followed by the bitmap itself. Pack with GLADIUS_RANK_SET_PACKET_FORMAT.
+     */
+    void
+    serialize(std::vector<uint64_t> &out) const {
+        for (const auto &seg : mSegs) {
+            if (seg.bits) {
+                out.push_back(sBitmapTag | seg.lo);
+                out.push_back(seg.bits);
+            }
+            else {
+                out.push_back((uint64_t(seg.hi) << 32) | seg.lo);
+            }
+        }
+    }
+
+    /**
+     * Replaces the set with one read from its wire form. Returns GLADIUS_ERR
+     * (and leaves the set empty) if words is malformed.
+     */
+    int
+    deserialize(
+        const uint64_t *words,
+        size_t nWords
+    ) {
+        clear();
+        for (size_t w = 0; w < nWords; ++w) {
+            Segment seg;
+            if (words[w] & sBitmapTag) {
+                if (w + 1 == nWords || 0 == words[w + 1]) goto bad;
+                seg.lo = Rank(words[w]);
+                seg.hi = 0;
+                seg.bits = words[++w];
+                if (seg.lo & 63) goto bad;
+            }
+            else {
+                seg.lo = Rank(words[w]);
+                seg.hi = Rank(words[w] >> 32);
+                seg.bits = 0;
+                if (seg.lo > seg.hi) goto bad;
+            }
+            if (!mSegs.empty() && sMin(seg) <= sMax(mSegs.back())) goto bad;
+            mSize += seg.bits ? __builtin_popcountll(seg.bits)
+                              : size_t(seg.hi - seg.lo) + 1;
+            mSegs.push_back(seg);
+        }
+        return GLADIUS_SUCCESS;
+    bad:
+        clear();
+        return GLADIUS_ERR;
+    }
+
+    /**
+     *
+     */
+    bool
+    operator==(const RankSet &other) const {
+        if (mSize != other.mSize) return false;
+        std::vector<std::pair<Rank, Rank> > a, b;
+        forEachRange([&a](Rank lo, Rank hi) { a.emplace_back(lo, hi); });
+        other.forEachRange([&b](Rank lo, Rank hi) { b.emplace_back(lo, hi); });
+        return a == b;
+    }
+
+    /**
+     *
+     */
+    bool
+    operator!=(const RankSet &other) const {
+        return !(*this == other);
+    }
+};
+
+} // end core namespace
+} // end gladius namespace
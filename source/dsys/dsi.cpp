@@ -18,10 +18,12 @@
 
 #include "core/core.h"
 #include "core/utils.h"
+#include "tool-common/gladius-tli.h"
 
 #include <cstdio>
 #include <cassert>
 #include <iostream>
+#include <map>
 
 #include <errno.h>
 #include <sstream>
@@ -67,8 +69,7 @@ const char DSI::sDSysName[] = "gladius-dsys";
  */
 DSI::DSI(
     void
-) : mCurLineBufSize(sInitBufSize)
-  , mApplPID(-1)
+) : mApplPID(-1)
 {
     memset(mToAppl,   -1, sizeof(mToAppl));
     memset(mFromAppl, -1, sizeof(mFromAppl));
@@ -97,8 +98,6 @@ DSI::mChildCleanup(void)
     //
     if (mToAppl[1]   != -1) close(mToAppl[1]);
     if (mFromAppl[0] != -1) close(mFromAppl[0]);
-    //
-    if (mFromDSysLineBuf) free(mFromDSysLineBuf);
     // Nothing to do for child.
     if (-1 == mApplPID) return;
     // Wait for dsys child process
@@ -170,11 +169,15 @@ DSI::init(
     mLauncherPersonality = palp;
     //
     VCOMP_COUT("Initializing the DSI..." << std::endl);
-    // Allocate initial string buffer.
-    mFromDSysLineBuf = (char *)calloc(
-                           mCurLineBufSize, sizeof(*mFromDSysLineBuf)
-                       );
-    if (!mFromDSysLineBuf) GLADIUS_THROW_OOR();
+    //
+    // Everything is on this host, so we answer dsys requests ourselves.
+    if (mIsLocal()) {
+        VCOMP_COUT(
+            "Local launch of " << mLauncherPersonality.nLocal()
+            << " process(es). Not starting " << sDSysName << "." << endl
+        );
+        return GLADIUS_SUCCESS;
+    }
     //
     if (-1 == pipe(mToAppl) || -1 == pipe(mFromAppl)) {
         int err = errno;
@@ -246,9 +249,16 @@ DSI::init(
         return GLADIUS_ERR_IO;
     }
     //
-    mWaitForPrompt();
+    int rc = mFromDSysReader.init(mFromAppl[0], sInitBufSize);
+    if (GLADIUS_SUCCESS != rc) return rc;
+    //
+    if (GLADIUS_SUCCESS != (rc = mWaitForPrompt())) {
+        GLADIUS_CERR << sDSysName << " exited before presenting its prompt."
+                     << endl;
+        return rc;
+    }
     //
-    assert(std::string(mFromDSysLineBuf) == sPromptString);
+    assert(mFromDSysLine == sPromptString);
     //
     VCOMP_COUT("Done initializing the DSI..." << std::endl);
     //
@@ -258,59 +268,36 @@ DSI::init(
 /**
  *
  */
-void
+int
 DSI::mWaitForPrompt(void)
 {
     VCOMP_COUT("Waiting for parallel job..." << std::endl);
-    while (0 != strcmp(mFromDSysLineBuf, sPromptString)) {
-        mGetRespLine();
-    }
+    int rc = GLADIUS_SUCCESS;
+    do {
+        if (GLADIUS_SUCCESS != (rc = mGetRespLine())) return rc;
+    } while (mFromDSysLine != sPromptString);
+    //
+    return GLADIUS_SUCCESS;
 }
 
 /**
- *
+ * Reads the next line of dsys output into mFromDSysLine.
  */
-size_t
+int
 DSI::mGetRespLine(void)
 {
-    char charBuf = '\0';
-    size_t nRead = 0;
-    while (1 == read(mFromAppl[0], &charBuf, 1)) {
-        // Need more memory.
-        if (nRead == mCurLineBufSize) {
-            // Double the size.
-            mCurLineBufSize *= 2;
-            mFromDSysLineBuf = (char *)realloc(
-                                   mFromDSysLineBuf, mCurLineBufSize
-                               );
-            if (!mFromDSysLineBuf) GLADIUS_THROW_OOR();
-        }
-        mFromDSysLineBuf[nRead] = charBuf;
-        if (charBuf == '\n') {
-            // Don't forget to update nRead before we break.
-            mFromDSysLineBuf[nRead++] = '\0';
-            break;
-        }
-        ++nRead;
-    }
-    return nRead;
+    return mFromDSysReader.readLine(mFromDSysLine);
 }
 
 /**
- *
+ * Reads dsys output up to (but not including) the next prompt.
  */
 int
 DSI::mDrainToString(
     std::string &result
 ) {
-    result.clear();
-    //
-    mGetRespLine();
-    while (0 != strcmp(mFromDSysLineBuf, sPromptString)) {
-        result += std::string(mFromDSysLineBuf) + "\n";
-        mGetRespLine();
-    }
-    return GLADIUS_SUCCESS;
+    static const bool includePrompt = false;
+    return mFromDSysReader.readUntilLine(sPromptString, result, includePrompt);
 }
 
 /**
@@ -344,6 +331,8 @@ DSI::getProcessLandscape(
     core::ProcessLandscape &pl
 ) {
     using namespace std;
+    //
+    if (mIsLocal()) return mLocalGetProcessLandscape(pl);
     // Gather info from dsys
     int rc = GLADIUS_SUCCESS;
     if (GLADIUS_SUCCESS != (rc = mSendCommand("h"))) {
@@ -353,18 +342,41 @@ DSI::getProcessLandscape(
     if (GLADIUS_SUCCESS != (rc = mRecvResp(respStr))) {
         return rc;
     }
+    // Then where each host's ranks are.
+    string ranksRespStr;
+    if (GLADIUS_SUCCESS != (rc = mSendCommand("r"))) {
+        return rc;
+    }
+    if (GLADIUS_SUCCESS != (rc = mRecvResp(ranksRespStr))) {
+        return rc;
+    }
+    string line;
+    map<string, core::ProcessLandscape::RankSet> hostRanks;
+    stringstream rss(ranksRespStr);
+    while (std::getline(rss, line)) {
+        // Form: [hostname] [ranks]
+        stringstream ls(line);
+        string hn, rankStr;
+        core::ProcessLandscape::RankSet ranks;
+        if (!(ls >> hn >> rankStr) ||
+            GLADIUS_SUCCESS != ranks.fromStr(rankStr)) {
+            GLADIUS_CERR << "Invalid rank list detected: " << line << endl;
+            return GLADIUS_ERR;
+        }
+        hostRanks[hn] = ranks;
+    }
     // Now process and populate the landscape object.
     stringstream ss(respStr);
-    string line;
-    char hnbuf[HOST_NAME_MAX] = {'\0'};
-    int hnn = 0;
     while (std::getline(ss, line)) {
-        int n = sscanf(line.c_str(), "%s %d", hnbuf, &hnn);
-        if (2 != n) {
+        // Form: [hostname] [number of expected tasks]
+        stringstream ls(line);
+        string hn;
+        int hnn = 0;
+        if (!(ls >> hn >> hnn)) {
             GLADIUS_CERR << "Invalid response detected: " << line << endl;
             return GLADIUS_ERR;
         }
-        if (GLADIUS_SUCCESS != (rc = pl.insert(hnbuf, hnn))) {
+        if (GLADIUS_SUCCESS != (rc = pl.insert(hn, hnn, hostRanks[hn]))) {
             GLADIUS_CERR << "Could not update process landscape!" << endl;
             return rc;
         }
@@ -382,6 +394,8 @@ DSI::shutdown(void)
     using namespace std;
     //
     VCOMP_COUT("Shutting down..." << endl);
+    // No dsys to shut down.
+    if (mIsLocal()) return GLADIUS_SUCCESS;
     //
     int rc = GLADIUS_SUCCESS;
     if (GLADIUS_SUCCESS != (rc = mSendCommand("q"))) {
@@ -403,6 +417,8 @@ DSI::publishConnectionInfo(
     using namespace std;
     //
     VCOMP_COUT("Publishing connection info..." << endl);
+    //
+    if (mIsLocal()) return mLocalPublishConnectionInfo(sessionKey, leafInfos);
     // See protocol in dsys.cpp
     int rc = GLADIUS_SUCCESS;
     string resp;
@@ -445,3 +461,82 @@ DSI::publishConnectionInfo(
     //
     return rc;
 }
+
+/**
+ * Local equivalent of dsys' 'h' and 'r': all mLauncherPersonality.nLocal() processes
+ * run on this host with ranks [0, nLocal).
+ */
+int
+DSI::mLocalGetProcessLandscape(
+    core::ProcessLandscape &pl
+) {
+    const int nLocal = mLauncherPersonality.nLocal();
+    core::ProcessLandscape::RankSet ranks;
+    ranks.insert(0, nLocal - 1);
+    //
+    return pl.insert(core::utils::getHostname(), nLocal, ranks);
+}
+
+/**
+ * Local equivalent of dsys' 'c': decodes the connection infos and writes each
+ * target's file. The file format and naming scheme are to be kept in sync with
+ * dsys.cpp and MRNetBE.
+ */
+int
+DSI::mLocalPublishConnectionInfo(
+    toolcommon::SessionKey sessionKey,
+    const std::vector<std::string> &leafInfos
+) {
+    using namespace std;
+    using namespace core;
+    using toolcommon::ToolLeafInfoT;
+    //
+    const string prefix = utils::getTmpDir() + utils::osPathSep
+                        + string(sessionKey) + "-";
+    //
+    for (const auto &li : leafInfos) {
+        const string res = utils::base64Decode(li);
+        if (sizeof(ToolLeafInfoT) != res.size()) {
+            GLADIUS_CERR << "Invalid connection info detected." << endl;
+            return GLADIUS_ERR;
+        }
+        ToolLeafInfoT info;
+        memmove(&info, res.data(), sizeof(info));
+        //
+        const string infoFile = prefix + to_string(info.rank);
+        // Back-ends may already be polling for infoFile.
+        const string tmpInfoFile = infoFile + ".tmp";
+        FILE *connectionInfo = fopen(tmpInfoFile.c_str(), "wb+");
+        if (!connectionInfo) {
+            int err = errno;
+            GLADIUS_CERR << utils::formatCallFailed(
+                                "fopen(3): " + utils::getStrError(err),
+                                GLADIUS_WHERE
+                            )
+                         << endl;
+            return GLADIUS_ERR_IO;
+        }
+        const size_t nWritten = fwrite(&info, sizeof(info), 1, connectionInfo);
+        if (0 != fclose(connectionInfo) || 1 != nWritten) {
+            GLADIUS_CERR << utils::formatCallFailed(
+                                "fwrite(3): ", GLADIUS_WHERE
+                            )
+                         << endl;
+            return GLADIUS_ERR_IO;
+        }
+        if (0 != rename(tmpInfoFile.c_str(), infoFile.c_str())) {
+            int err = errno;
+            GLADIUS_CERR << utils::formatCallFailed(
+                                "rename(2): " + utils::getStrError(err),
+                                GLADIUS_WHERE
+                            )
+                         << endl;
+            return GLADIUS_ERR_IO;
+        }
+    }
+    VCOMP_COUT(
+        "Wrote " << leafInfos.size() << " connection info file(s)." << endl
+    );
+    //
+    return GLADIUS_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include "dsys/palp.h"
 
 #include "core/process-landscape.h"
+#include "core/line-reader.h"
 #include "tool-common/session-key.h"
 
 #include <string>
@@ -32,13 +33,11 @@ private:
     static const char sDSysName[];
     //
     static const char sPromptString[];
-     //The initial size of the output buffer. 16k should be plenty.
+    // The initial size of the output buffer. Grows as needed.
     static constexpr size_t sInitBufSize = 1024 * 16;
     //
     dsys::AppLauncherPersonality mLauncherPersonality;
     //
-    size_t mCurLineBufSize = 0;
-    //
     bool mBeVerbose = false;
     //
     int mToAppl[2];
@@ -46,15 +45,17 @@ private:
     int mFromAppl[2];
     // PID of application launcher process.
     pid_t mApplPID = 0;
-    //
-    char *mFromDSysLineBuf = nullptr;
+    // Buffered reader for dsys output.
+    core::LineReader mFromDSysReader;
+    // The last line read from dsys (without its newline).
+    std::string mFromDSysLine;
     //
     FILE *mTo = nullptr;
     //
-    size_t
+    int
     mGetRespLine(void);
     //
-    void
+    int
     mWaitForPrompt(void);
     //
     int
@@ -74,6 +75,23 @@ private:
     //
     void
     mChildCleanup(void);
+    //
+    bool
+    mIsLocal(void) const {
+        return dsys::AppLauncherPersonality::LOCAL
+               == mLauncherPersonality.getPersonality();
+    }
+    //
+    int
+    mLocalGetProcessLandscape(
+        core::ProcessLandscape &pl
+    );
+    //
+    int
+    mLocalPublishConnectionInfo(
+        toolcommon::SessionKey sessionKey,
+        const std::vector<std::string> &leafInfos
+    );
 
 public:
     //
@@ -19,12 +19,14 @@
 #include "core/utils.h"
 #include "tool-common/session-key.h"
 #include "tool-common/gladius-tli.h"
+#include "tool-common/rank-set.h"
 
 #include <functional>
 #include <iostream>
 #include <cstdlib>
 #include <string>
 #include <cstdio>
+#include <cstring>
 #include <map>
 #include <vector>
 
@@ -47,6 +49,7 @@ static const int ERROR   = 1;
 static const int DONE    = 0;
 static const int HOSTS   = 1;
 static const int PUBCONN = 2;
+static const int RANKS   = 3;
 
 /**
  *
@@ -60,6 +63,8 @@ struct Proc {
     // Map between a hostname and the number of targets on it. There shall be no
     // duplicate hostnames in this table.
     map<string, int> hostTargetNumTab;
+    // Map between a hostname and the MPI_COMM_WORLD ranks of its targets.
+    map<string, gladius::toolcommon::RankSet> hostRankTab;
     //
     gladius::toolcommon::SessionKey sessionKey;
     // Tool connection information.
@@ -101,7 +106,7 @@ echoHosts(Proc &p)
     if (!p.leader) return SUCCESS;
     // I do, so here you go
     // Form: [hostname] [number of expected tasks]
-    for (const auto ti : p.hostTargetNumTab) {
+    for (const auto &ti : p.hostTargetNumTab) {
         std::cout << ti.first << " " << ti.second << std::endl;
     }
     std::cout << std::flush;
@@ -112,51 +117,197 @@ echoHosts(Proc &p)
  *
  */
 int
-hosts(Proc &p)
+echoRanks(Proc &p)
+{
+    // I don't have it, so return.
+    if (!p.leader) return SUCCESS;
+    // I do, so here you go
+    // Form: [hostname] [ranks (in RankSet range notation)]
+    for (const auto &ri : p.hostRankTab) {
+        std::cout << ri.first << " " << ri.second.str() << std::endl;
+    }
+    std::cout << std::flush;
+    return SUCCESS;
+}
+
+/**
+ * Returns the number of targets that share a node with the caller and whether
+ * or not the caller is that node's leader (lowest MPI_COMM_WORLD rank). The
+ * node leader also gets the MPI_COMM_WORLD ranks of those targets.
+ */
+int
+nodeLocalInfo(
+    int cwRank,
+    int &nLocal,
+    bool &nodeLeader,
+    gladius::toolcommon::RankSet &localRanks
+) {
+    MPI_Comm nodeComm = MPI_COMM_NULL;
+    int mpiRC = MPI_Comm_split_type(
+                    MPI_COMM_WORLD,
+                    MPI_COMM_TYPE_SHARED,
+                    0,
+                    MPI_INFO_NULL,
+                    &nodeComm
+                );
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    //
+    int nodeRank = 0;
+    mpiRC = MPI_Comm_size(nodeComm, &nLocal);
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    mpiRC = MPI_Comm_rank(nodeComm, &nodeRank);
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    nodeLeader = (0 == nodeRank);
+    //
+    vector<int> ranks;
+    if (nodeLeader) ranks.resize(nLocal);
+    mpiRC = MPI_Gather(
+                &cwRank,
+                1,
+                MPI_INT,
+                ranks.data(),
+                1,
+                MPI_INT,
+                0,
+                nodeComm
+            );
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    // Gathered in node rank order, which follows world rank order.
+    for (const auto r : ranks) localRanks.insert(r);
+    //
+    mpiRC = MPI_Comm_free(&nodeComm);
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    //
+    return SUCCESS;
+}
+
+/**
+ * Two-level host gather. Targets are first counted (and their ranks collected)
+ * within their node, then only node leaders send a hostname, that count, and
+ * the node's ranks (as a RankSet in range notation) to the leader, so the
+ * leader receives O(hosts) data instead of O(targets). Done once, for both
+ * 'h' and 'r'.
+ */
+int
+gatherHosts(Proc &p)
 {
     static bool done = false;
-    if (done) return echoHosts(p);
+    if (done) return SUCCESS;
     //
-    char *hostNames = NULL;
+    int nLocal = 0;
+    bool nodeLeader = false;
+    gladius::toolcommon::RankSet localRanks;
+    if (SUCCESS != nodeLocalInfo(p.cwRank, nLocal, nodeLeader, localRanks)) {
+        return ERROR;
+    }
+    // Only node leaders participate in the second level. Use our world rank as
+    // the key so that the leader (world rank 0) is rank 0 in leaderComm.
+    MPI_Comm leaderComm = MPI_COMM_NULL;
+    int mpiRC = MPI_Comm_split(
+                    MPI_COMM_WORLD,
+                    nodeLeader ? 0 : MPI_UNDEFINED,
+                    p.cwRank,
+                    &leaderComm
+                );
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    // Not a node leader, so we are done.
+    if (MPI_COMM_NULL == leaderComm) {
+        done = true;
+        return SUCCESS;
+    }
     //
+    int nLeaders = 0;
+    mpiRC = MPI_Comm_size(leaderComm, &nLeaders);
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    // (hostname length, rank ranges length, number of targets) triple. Ranks
+    // travel in range notation, which is short for the usual block placement.
+    const int hnLen = strlen(p.hostname);
+    const string myRanks = localRanks.str();
+    const int rsLen = myRanks.size();
+    const int myTriple[3] = {hnLen, rsLen, nLocal};
+    vector<int> triples;
+    if (p.leader) triples.resize(3 * nLeaders);
+    mpiRC = MPI_Gather(
+                myTriple,
+                3,
+                MPI_INT,
+                triples.data(),
+                3,
+                MPI_INT,
+                0,
+                leaderComm
+            );
+    if (MPI_SUCCESS != mpiRC) return ERROR;
+    // Now gather the (unterminated) host names and rank ranges into a flat
+    // buffer: [hostname][ranks] per leader.
+    const string myStrs = string(p.hostname) + myRanks;
+    vector<int> strLens, displs;
+    vector<char> strs;
     if (p.leader) {
-        hostNames = new char[p.cwSize * HOST_NAME_MAX * sizeof(char)];
-        if (!hostNames) return ERROR;
+        strLens.resize(nLeaders);
+        displs.resize(nLeaders);
+        int total = 0;
+        for (int l = 0; l < nLeaders; ++l) {
+            strLens[l] = triples[3 * l] + triples[3 * l + 1];
+            displs[l] = total;
+            total += strLens[l];
+        }
+        strs.resize(total);
     }
-    //
-    int mpiRC = MPI_Gather(
-                    p.hostname,
-                    HOST_NAME_MAX,
-                    MPI_CHAR,
-                    hostNames,
-                    HOST_NAME_MAX,
-                    MPI_CHAR,
-                    0,
-                    MPI_COMM_WORLD
-                );
+    mpiRC = MPI_Gatherv(
+                myStrs.data(),
+                myStrs.size(),
+                MPI_CHAR,
+                strs.data(),
+                strLens.data(),
+                displs.data(),
+                MPI_CHAR,
+                0,
+                leaderComm
+            );
     if (MPI_SUCCESS != mpiRC) return ERROR;
-    // Populate the hostname/number of targets table
+    // Populate the hostname/number of targets and hostname/ranks tables.
     if (p.leader) {
-        for (int r = 0; r < p.cwSize; ++r) {
-            // Grab the host name from the flat buffer.
-            string hn(&(hostNames[r * HOST_NAME_MAX]));
-            auto &tab = p.hostTargetNumTab;
-            auto searchr = tab.find(hn);
-            // Not found
-            if (searchr == tab.end()) {
-                tab.insert(make_pair(hn, 1));
-            }
-            // Found, increment by one
-            else {
-                searchr->second += 1;
-            }
+        auto &tab = p.hostTargetNumTab;
+        auto &rtab = p.hostRankTab;
+        for (int l = 0; l < nLeaders; ++l) {
+            const char *base = &strs[displs[l]];
+            const int nameLen = triples[3 * l];
+            const string hn(base, nameLen);
+            const string rs(base + nameLen, triples[3 * l + 1]);
+            // A host may span more than one shared memory domain, so add.
+            tab[hn] += triples[3 * l + 2];
+            gladius::toolcommon::RankSet ranks;
+            if (GLADIUS_SUCCESS != ranks.fromStr(rs)) return ERROR;
+            rtab[hn].merge(ranks);
         }
     }
-    if (hostNames) delete[] hostNames;
+    mpiRC = MPI_Comm_free(&leaderComm);
+    if (MPI_SUCCESS != mpiRC) return ERROR;
     done = true;
+    return SUCCESS;
+}
+
+/**
+ * Hostnames and the number of targets on each.
+ */
+int
+hosts(Proc &p)
+{
+    if (SUCCESS != gatherHosts(p)) return ERROR;
     return echoHosts(p);
 }
 
+/**
+ * Hostnames and the MPI_COMM_WORLD ranks of the targets on each.
+ */
+int
+ranks(Proc &p)
+{
+    if (SUCCESS != gatherHosts(p)) return ERROR;
+    return echoRanks(p);
+}
+
 /**
  *
  */
@@ -199,8 +350,11 @@ writeConnectionInfos(Proc &p)
     string infoFile = tmpDir + utils::osPathSep
                     + string(p.sessionKey) + "-"
                     + to_string(p.cwRank);
+    // Back-ends may already be polling for infoFile, so write it elsewhere
+    // first and rename(2) it into place once it is complete.
+    const string tmpInfoFile = infoFile + ".tmp";
     //
-    FILE *connectionInfo = fopen(infoFile.c_str(), "wb+");
+    FILE *connectionInfo = fopen(tmpInfoFile.c_str(), "wb+");
     if (!connectionInfo) {
         int err = errno;
         const string errs = utils::getStrError(err);
@@ -213,7 +367,7 @@ writeConnectionInfos(Proc &p)
     for (int i = 0; i < p.leafInfos.size; ++i) {
         if (p.leafInfos.leaves[i].rank != p.cwRank) continue;
         // Our data
-        const int itemsWritten = fwrite(p.leafInfos.leaves,
+        const int itemsWritten = fwrite(&p.leafInfos.leaves[i],
                                         sizeof(ToolLeafInfoT),
                                         1,
                                         connectionInfo
@@ -221,6 +375,7 @@ writeConnectionInfos(Proc &p)
         if (1 != itemsWritten) {
             cerr << utils::formatCallFailed("fwrite(3): ", GLADIUS_WHERE)
                  << std::endl;
+            fclose(connectionInfo);
             return ERROR;
         }
         nInfos += itemsWritten;
@@ -234,6 +389,13 @@ writeConnectionInfos(Proc &p)
              << std::endl;
         // Warning only. Just return success...
     }
+    if (0 != rename(tmpInfoFile.c_str(), infoFile.c_str())) {
+        int err = errno;
+        const string errs = utils::getStrError(err);
+        cerr << utils::formatCallFailed("rename(2): " + errs, GLADIUS_WHERE)
+             << std::endl;
+        return ERROR;
+    }
     //
     return SUCCESS;
 }
@@ -369,7 +531,8 @@ fini(const Proc &p)
 const map<char, int> cmdProtoTab = {
     {'q', DONE},
     {'h', HOSTS},
-    {'c', PUBCONN}
+    {'c', PUBCONN},
+    {'r', RANKS}
 };
 
 /**
@@ -378,7 +541,8 @@ const map<char, int> cmdProtoTab = {
 const map< int, function<int(Proc &p)> > protoFunTable = {
     {DONE,    done},
     {HOSTS,   hosts},
-    {PUBCONN, pubConn}
+    {PUBCONN, pubConn},
+    {RANKS,   ranks}
 };
 
 /**
@@ -0,0 +1,294 @@
+/**
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Launcher personalities. Each personality knows how its launcher forwards
+ * environment variables and how to start N copies of a program with it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "dsys/palp.h"
+
+#include "core/env.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <errno.h>
+#include <unistd.h>
+
+extern char **environ;
+
+using namespace gladius;
+using namespace gladius::dsys;
+
+const char AppLauncherPersonality::sLocalLauncherName[] = "local";
+
+namespace {
+/**
+ * Returns environ plus extras as NAME=VALUE strings.
+ */
+std::vector<std::string>
+envWith(
+    const AppLauncherPersonality::EnvList &extras
+) {
+    std::vector<std::string> res;
+    for (char **e = environ; e && *e; ++e) {
+        const char *eq = strchr(*e, '=');
+        const std::string name = eq ? std::string(*e, eq - *e) : *e;
+        bool overridden = false;
+        for (const auto &x : extras) {
+            if (x.first == name) {
+                overridden = true;
+                break;
+            }
+        }
+        if (!overridden) res.push_back(*e);
+    }
+    for (const auto &x : extras) {
+        res.push_back(x.first + "=" + x.second);
+    }
+    return res;
+}
+} // end namespace
+
+/**
+ *
+ */
+int
+AppLauncherPersonality::init(const core::Args &args)
+{
+    mLauncherArgs = args;
+    // First argument should be launcher name
+    mName = mLauncherArgs.argv()[0];
+    mType = getPersonalityByName(mName);
+    //
+    if (NONE == mType) {
+        const std::string errs =
+            "Cannot determine launcher type by name: '" + mName + "'";
+        GLADIUS_CERR << errs << std::endl;
+        return GLADIUS_ERR;
+    }
+    // Built in, so nothing to find.
+    if (LOCAL == mType) {
+        mAbsolutePath = sLocalLauncherName;
+        return mParseLocalArgs();
+    }
+    //
+    auto status =  core::utils::which(mName, mAbsolutePath);
+    if (GLADIUS_SUCCESS != status) {
+        const std::string errs =
+            "It appears as if " + std::string(mName) + " is either "
+            "not installed or not in your $PATH. "
+            " Please fix this and try again.";
+        GLADIUS_CERR << errs << std::endl;
+        return GLADIUS_ERR;
+    }
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Expecting: local -n N (or -np N).
+ */
+int
+AppLauncherPersonality::mParseLocalArgs(void)
+{
+    const auto argv = mLauncherArgs.toArgv();
+    for (size_t i = 1; i + 1 < argv.size(); ++i) {
+        if ("-n" != argv[i] && "-np" != argv[i]) continue;
+        char *end = nullptr;
+        const long n = strtol(argv[i + 1].c_str(), &end, 10);
+        if (*end || n <= 0 || n > INT_MAX) break;
+        mNLocal = int(n);
+        return GLADIUS_SUCCESS;
+    }
+    GLADIUS_CERR << "Usage: " << sLocalLauncherName << " -n N" << std::endl;
+    return GLADIUS_ERR;
+}
+
+/**
+ *
+ */
+std::string
+AppLauncherPersonality::getPersonalityName(void) const
+{
+    switch(mType) {
+        // TODO mpich v. open mpi's mpirun? Add a more robust check here.
+        case (ORTE): return "orte";
+        case (SLURM): return "slurm";
+        case (HYDRA): return "hydra";
+        case (ALPS): return "alps";
+        case (LOCAL): return "local";
+        case (NONE): return "none";
+        default: return "???";
+    }
+}
+
+/**
+ * Sets the environment variables that are forwarded to everything that we
+ * launch, and translates them into our launcher's way of saying so.
+ */
+void
+AppLauncherPersonality::setForwardEnvs(const EnvList &envs)
+{
+    using namespace std;
+    //
+    mForwardEnvs = envs;
+    vector<string> args;
+    for (const auto &env : envs) {
+        switch (mType) {
+            case (ORTE):
+                // ORTE only forwards what it is told to.
+                args.push_back("-x");
+                args.push_back(env.first + "=" + env.second);
+                break;
+            case (HYDRA):
+                args.push_back("-genv");
+                args.push_back(env.first);
+                args.push_back(env.second);
+                break;
+            case (ALPS):
+                args.push_back("-e");
+                args.push_back(env.first + "=" + env.second);
+                break;
+            // srun exports the caller's environment by default, and local
+            // children inherit ours, so they are set in the launch
+            // environment instead (see launch).
+            case (SLURM):
+            case (LOCAL):
+            default:
+                break;
+        }
+    }
+    mForwardEnvArgs = core::Args(args);
+}
+
+/**
+ * Returns the command that launches appArgs: the launcher and its arguments,
+ * the environment forwarding arguments, then the application. LOCAL has no
+ * launcher, so its command is just the application.
+ */
+core::Args
+AppLauncherPersonality::getLaunchCMDFor(
+    const core::Args &appArgs
+) const {
+    using namespace std;
+    //
+    if (LOCAL == mType) return appArgs;
+    //
+    vector<string> args  = mLauncherArgs.toArgv();
+    vector<string> fargs = mForwardEnvArgs.toArgv();
+    vector<string> aargs = appArgs.toArgv();
+    args.insert(end(args), begin(fargs), end(fargs));
+    args.insert(end(args), begin(aargs), end(aargs));
+    //
+    return core::Args(args);
+}
+
+/**
+ * Starts appArgs with our launcher and returns the PIDs of the processes that
+ * we started: the launcher's, or every local process for LOCAL.
+ */
+int
+AppLauncherPersonality::launch(
+    const core::Args &appArgs,
+    std::vector<pid_t> &pids
+) const {
+    pids.clear();
+    if (LOCAL == mType) return mLaunchLocal(appArgs, pids);
+    //
+    const core::Args a = getLaunchCMDFor(appArgs);
+    const auto envs = envWith(mForwardEnvs);
+    const core::Args envp(envs);
+    //
+    const pid_t p = fork();
+    // child
+    if (0 == p) {
+        execvpe(a.argv()[0], a.argv(), envp.argv());
+        perror("execvpe");
+        _exit(127);
+    }
+    else if (-1 == p) {
+        int err = errno;
+        GLADIUS_CERR << core::utils::formatCallFailed(
+                            "fork(2): " + core::utils::getStrError(err),
+                            GLADIUS_WHERE
+                        )
+                     << std::endl;
+        return GLADIUS_ERR_SYS;
+    }
+    pids.push_back(p);
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Forks mNLocal copies of appArgs. Each learns its rank and the job size from
+ * GLADIUS_ENV_LOCAL_RANK_NAME and GLADIUS_ENV_LOCAL_SIZE_NAME.
+ */
+int
+AppLauncherPersonality::mLaunchLocal(
+    const core::Args &appArgs,
+    std::vector<pid_t> &pids
+) const {
+    using namespace std;
+    //
+    pids.reserve(mNLocal);
+    EnvList extras = mForwardEnvs;
+    extras.push_back(make_pair(GLADIUS_ENV_LOCAL_SIZE_NAME, to_string(mNLocal)));
+    extras.push_back(make_pair(GLADIUS_ENV_LOCAL_RANK_NAME, ""));
+    // The environment is built once; only the rank's value changes.
+    vector<string> envs = envWith(extras);
+    const size_t rankEnvIdx = envs.size() - 1;
+    const string rankEnvPrefix = envs[rankEnvIdx];
+    //
+    for (int rank = 0; rank < mNLocal; ++rank) {
+        envs[rankEnvIdx] = rankEnvPrefix + to_string(rank);
+        const core::Args envp(envs);
+        const pid_t p = fork();
+        if (0 == p) {
+            execvpe(appArgs.argv()[0], appArgs.argv(), envp.argv());
+            perror("execvpe");
+            _exit(127);
+        }
+        else if (-1 == p) {
+            int err = errno;
+            GLADIUS_CERR << core::utils::formatCallFailed(
+                                "fork(2): " + core::utils::getStrError(err),
+                                GLADIUS_WHERE
+                            )
+                         << std::endl;
+            return GLADIUS_ERR_SYS;
+        }
+        pids.push_back(p);
+    }
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Returns personality based on launcher name (or path).
+ */
+AppLauncherPersonality::Type
+AppLauncherPersonality::getPersonalityByName(const std::string &name)
+{
+    const auto slash = name.find_last_of('/');
+    const std::string base = (std::string::npos == slash)
+                           ? name : name.substr(slash + 1);
+    // TODO deal with all mpiruns
+    if ("mpirun" == base || "orterun" == base) return ORTE;
+    else if ("srun" == base) return SLURM;
+    else if ("mpiexec.hydra" == base) return HYDRA;
+    else if ("aprun" == base) return ALPS;
+    else if (sLocalLauncherName == base) return LOCAL;
+    else return NONE;
+}
@@ -22,6 +22,9 @@
 
 #include <vector>
 #include <string>
+#include <utility>
+
+#include <sys/types.h>
 
 namespace gladius {
 namespace dsys {
@@ -32,9 +35,17 @@ public:
      * Supported launcher types.
      */
     enum Type {
-        ORTE, /* orte */
-        NONE  /* none specified/unknown */
+        ORTE,  /* orte (mpirun, orterun) */
+        SLURM, /* srun */
+        HYDRA, /* mpiexec.hydra */
+        ALPS,  /* aprun */
+        LOCAL, /* fork N processes on this host */
+        NONE   /* none specified/unknown */
     };
+    //
+    typedef std::vector< std::pair<std::string, std::string> > EnvList;
+    // Name of the built-in local launcher.
+    static const char sLocalLauncherName[];
 
 private:
     // Name of the launcher, e.g. mpirun, srun, aprun
@@ -47,6 +58,19 @@ private:
     core::Args mLauncherArgs;
     // Arguments used to forward environment variables to remote environments.
     core::Args mForwardEnvArgs;
+    // Environment variables to forward to everything that we launch.
+    EnvList mForwardEnvs;
+    // LOCAL only: the number of processes to fork.
+    int mNLocal = 0;
+    //
+    int
+    mParseLocalArgs(void);
+    //
+    int
+    mLaunchLocal(
+        const core::Args &appArgs,
+        std::vector<pid_t> &pids
+    ) const;
 
 public:
     /**
@@ -58,59 +82,22 @@ public:
       , mAbsolutePath("")
       , mType(NONE) { ; }
 
-    /**
-     *
-     */
-    int
-    init(const core::Args &args)
-    {
-        mLauncherArgs = args;
-        // First argument should be launcher name
-        mName = mLauncherArgs.argv()[0];
-        mType = getPersonalityByName(mName);
-        //
-        if (dsys::AppLauncherPersonality::NONE == mType) {
-            static const std::string errs =
-                "Cannot determine launcher type by name: '" + mName + "'";
-            GLADIUS_CERR << errs << std::endl;
-            return GLADIUS_ERR;
-        }
-        //
-        auto status =  core::utils::which(mName, mAbsolutePath);
-        if (GLADIUS_SUCCESS != status) {
-            static const std::string errs =
-                "It appears as if " + std::string(mName) + " is either "
-                "not installed or not in your $PATH. "
-                " Please fix this and try again.";
-            GLADIUS_CERR << errs << std::endl;
-            return GLADIUS_ERR;
-        }
-        return GLADIUS_SUCCESS;
-    }
-
     /**
      *
      */
     ~AppLauncherPersonality(void) = default;
+    //
+    int
+    init(const core::Args &args);
 
     /**
      *
      */
     Type
     getPersonality(void) const { return mType; }
-
-    /**
-     *
-     */
+    //
     std::string
-    getPersonalityName(void) const {
-        switch(mType) {
-            // TODO mpich v. open mpi's mpirun? Add a more robust check here.
-            case (ORTE): return "orte";
-            case (NONE): return "none";
-            default: return "???";
-        }
-    }
+    getPersonalityName(void) const;
 
     /**
      *
@@ -119,30 +106,27 @@ public:
     which(void) const { return mAbsolutePath; }
 
     /**
-     *
+     * LOCAL only: returns the number of processes that a launch forks.
      */
+    int
+    nLocal(void) const { return mNLocal; }
+    //
+    void
+    setForwardEnvs(const EnvList &envs);
+    //
     core::Args
     getLaunchCMDFor(
         const core::Args &appArgs
-    ) const {
-        using namespace std;
-        //
-        vector<string> args  = mLauncherArgs.toArgv();
-        vector<string> aargs = appArgs.toArgv();
-        args.insert(end(args), begin(aargs), end(aargs));
-        //
-        return core::Args(args);
-    }
-
-    /**
-     * Returns personality based on launcher name.
-     */
+    ) const;
+    //
+    int
+    launch(
+        const core::Args &appArgs,
+        std::vector<pid_t> &pids
+    ) const;
+    //
     static Type
-    getPersonalityByName(const std::string &name) {
-        // TODO deal with all mpiruns
-        if ("mpirun" == name) return ORTE;
-        else return NONE;
-    }
+    getPersonalityByName(const std::string &name);
 };
 
 } // end gladius dsys
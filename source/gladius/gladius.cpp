@@ -24,12 +24,34 @@ const std::vector<core::EnvironmentVar> gladiusEnvVars = {
     {GLADIUS_ENV_TOOL_FE_VERBOSE_NAME,
      "Makes tool front-end actions verbose when set."
     },
+    {GLADIUS_ENV_TOOL_FE_TOPO_FILE_NAME,
+     "Specifies an MRNet topology file to use instead of a generated one."
+    },
+    {GLADIUS_ENV_TOOL_STREAM_SYNC_NAME,
+     "How plugin streams gather results: all, window:MS, or first:K:MS."
+    },
+    {GLADIUS_ENV_TOP_REFRESH_MS_NAME,
+     "Milliseconds between top plugin redraws. Default: 1000."
+    },
+    {GLADIUS_ENV_LPROF_PORT_NAME,
+     "TCP port that the lprof plugin serves Legion profiling records on. "
+     "Default: 41414."
+    },
     {GLADIUS_ENV_TOOL_BE_VERBOSE_NAME,
      "Makes tool back-end actions verbose when set."
     },
     {GLADIUS_ENV_TOOL_BE_LOG_DIR_NAME,
      "Specifies the path where tool back-end logs will be written."
     },
+    {GLADIUS_ENV_TOOL_BE_CONNECT_TIMEOUT_NAME,
+     "Seconds a tool back-end waits for its connection info. Default: 120."
+    },
+    {GLADIUS_ENV_TOOL_HEARTBEAT_INTERVAL_NAME,
+     "Seconds between tool back-end heartbeats. 0 disables them. Default: 5."
+    },
+    {GLADIUS_ENV_TOOL_HEARTBEAT_MAX_MISSED_NAME,
+     "Heartbeats a tool back-end may miss before it is lost. Default: 3."
+    },
     {GLADIUS_ENV_NO_TERM_COLORS_NAME,
      "Disables colorized terminal output when set."
     },
@@ -6,9 +6,15 @@
  * top-level directory of this distribution.
  */
 
+#include "core/rank-set.h"
+#include "tool-common/tool-common.h"
+
 #include "mrnet/Packet.h"
 #include "mrnet/NetworkTopology.h"
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 
 using namespace std;
@@ -39,4 +45,66 @@ GladiusMRNetProtoFilter(
     outputPackets.push_back(inputPackets[0]);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Heartbeat Filter
+////////////////////////////////////////////////////////////////////////////////
+const char *GladiusMRNetHeartbeatFilter_format_string =
+    GLADIUS_RANK_SET_PACKET_FORMAT;
+
+/**
+ * Merges the heartbeats from all children (each a RankSet of the back-ends
+ * that are alive) into one, so the front-end gets a few packets per interval
+ * instead of one per back-end.
+ */
+void
+GladiusMRNetHeartbeatFilter(
+    vector<PacketPtr> &inputPackets,
+    vector<PacketPtr> &outputPackets,
+    vector<PacketPtr> &,
+    void **,
+    PacketPtr &
+) {
+    using gladius::core::RankSet;
+    //
+    if (inputPackets.empty()) return;
+    // Not ours, so pass it along.
+    const int tag = inputPackets[0]->get_Tag();
+    if (gladius::toolcommon::MRNetCoreTags::Heartbeat != tag) {
+        outputPackets = inputPackets;
+        return;
+    }
+    //
+    RankSet alive;
+    for (auto &p : inputPackets) {
+        uint64_t *words = nullptr;
+        int nWords = 0;
+        // Nothing sensible to do with a bad packet but drop it.
+        if (0 != p->unpack(GLADIUS_RANK_SET_PACKET_FORMAT, &words, &nWords)) {
+            continue;
+        }
+        RankSet child;
+        if (GLADIUS_SUCCESS == child.deserialize(words, size_t(nWords))) {
+            alive.merge(child);
+        }
+        free(words);
+    }
+    vector<uint64_t> merged;
+    alive.serialize(merged);
+    // The packet owns (and frees) this.
+    const size_t nBytes = sizeof(uint64_t) * merged.size();
+    uint64_t *words = (uint64_t *)malloc(nBytes ? nBytes : 1);
+    if (!words) return;
+    if (nBytes) memcpy(words, merged.data(), nBytes);
+    PacketPtr packet(
+        new Packet(
+            inputPackets[0]->get_StreamId(),
+            tag,
+            GLADIUS_RANK_SET_PACKET_FORMAT,
+            words, int(merged.size())
+        )
+    );
+    packet->set_DestroyData(true);
+    outputPackets.push_back(packet);
+}
+
 }
@@ -13,9 +13,16 @@
 
 #include "core/core.h"
 #include "core/utils.h"
+#include "core/rank-set.h"
 #include "tool-common/tool-common.h"
+#include "tool-common/tx-message.h"
 
+#include <chrono>
 #include <cstdlib>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <errno.h>
 #include <arpa/inet.h>
@@ -46,6 +53,8 @@ do {                                                                           \
     }                                                                          \
 } while (0)
 
+// Default number of seconds to wait for our connection info.
+const int defaultConnectTimeoutInSec = 120;
 }
 ////////////////////////////////////////////////////////////////////////////////
 // MRNetBE
@@ -70,6 +79,9 @@ MRNetBE::MRNetBE(
  * Destructor.
  */
 MRNetBE::~MRNetBE(void) {
+    // The lash-up thread uses us until the front-end is done with us.
+    (void)wait();
+    mStopHeartbeatThread();
     if (mtli) {
         if (mtli->leaves) free(mtli->leaves);
         mtli->leaves = nullptr;
@@ -176,16 +188,162 @@ MRNetBE::create(int uid)
 }
 
 /**
- *
+ * Connects to the front-end and serves its sessions. Returns once the
+ * front-end is done with us.
  */
 int
 MRNetBE::connect(void)
 {
+    const int rc = connectAsync();
+    if (GLADIUS_SUCCESS != rc) return rc;
+    return wait();
+}
+
+/**
+ * Starts connecting to the front-end in the background and returns right
+ * away, so that the application can go on with its startup. Once connected,
+ * the background thread serves the front-end's sessions. fn (if set) is told
+ * how the lash-up went. See also: connectStatus, waitForConnect, and wait.
+ */
+int
+MRNetBE::connectAsync(const ConnectedFn &fn)
+{
+    if (mLashUpThread.joinable()) {
+        GLADIUS_CERR << "Already connected (or connecting)." << endl;
+        return GLADIUS_ERR;
+    }
     VCOMP_COUT("Connecting..." << endl);
+    {
+        lock_guard<mutex> lock(mConnectMtx);
+        mConnectRC = GLADIUS_NOT_CONNECTED;
+        mConnectedFn = fn;
+    }
+    try {
+        mLashUpThread = thread(&MRNetBE::mLashUpMain, this);
+    }
+    catch (const std::system_error &e) {
+        GLADIUS_CERR << utils::formatCallFailed(
+                            string("std::thread: ") + e.what(),
+                            GLADIUS_WHERE
+                        )
+                     << endl;
+        return GLADIUS_ERR_SYS;
+    }
     //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Returns GLADIUS_NOT_CONNECTED while the lash-up is under way,
+ * GLADIUS_SUCCESS once we are connected, or why the lash-up failed. Never
+ * blocks.
+ */
+int
+MRNetBE::connectStatus(void)
+{
+    lock_guard<mutex> lock(mConnectMtx);
+    return mConnectRC;
+}
+
+/**
+ * Waits up to timeoutInMS (forever if negative) for the lash-up to finish.
+ * Returns connectStatus, which is GLADIUS_NOT_CONNECTED if we timed out.
+ */
+int
+MRNetBE::waitForConnect(int timeoutInMS)
+{
+    unique_lock<mutex> lock(mConnectMtx);
+    const auto done = [this]() {
+        return GLADIUS_NOT_CONNECTED != mConnectRC;
+    };
+    if (timeoutInMS < 0) {
+        mConnectCV.wait(lock, done);
+    }
+    else {
+        (void)mConnectCV.wait_for(
+                  lock, std::chrono::milliseconds(timeoutInMS), done
+              );
+    }
+    return mConnectRC;
+}
+
+/**
+ * Waits for the front-end to be done with us (or for the lash-up to fail).
+ * Returns how the lash-up went.
+ */
+int
+MRNetBE::wait(void)
+{
+    if (mLashUpThread.joinable()) mLashUpThread.join();
+    return connectStatus();
+}
+
+/**
+ * Records (once) how the lash-up went and tells whoever is interested.
+ */
+void
+MRNetBE::mSetConnected(int rc)
+{
+    // An error from below that says "not connected" would read as "still
+    // connecting".
+    if (GLADIUS_NOT_CONNECTED == rc) rc = GLADIUS_ERR;
+    ConnectedFn fn;
+    {
+        lock_guard<mutex> lock(mConnectMtx);
+        if (GLADIUS_NOT_CONNECTED != mConnectRC) return;
+        mConnectRC = rc;
+        std::swap(fn, mConnectedFn);
+    }
+    mConnectCV.notify_all();
+    if (fn) fn(rc);
+}
+
+/**
+ * The lash-up thread's main: connects, and then serves sessions until the
+ * front-end is done with us.
+ */
+int
+MRNetBE::mLashUpMain(void)
+{
     int rc = mGetConnectionInfo();
-    if (GLADIUS_SUCCESS != rc) return rc;
-    if (GLADIUS_SUCCESS != (rc = mStartToolThreads())) return rc;
+    if (GLADIUS_SUCCESS == rc) rc = mStartToolThreads();
+    // Covers failures before any tool thread got far enough to say.
+    mSetConnected(GLADIUS_SUCCESS == rc ? GLADIUS_ERR : rc);
+    return rc;
+}
+
+/**
+ * Waits for infoFile to show up. The front-end launches the application while
+ * the tool tree is still coming up, so our connection info may be published
+ * after we get here. dsys renames complete files into place, so existence is
+ * enough.
+ */
+int
+MRNetBE::mWaitForConnectionInfo(
+    const string &infoFile
+) {
+    using namespace std::chrono;
+    //
+    int timeoutInSec = defaultConnectTimeoutInSec;
+    int rc = core::utils::getEnvAs(
+                 GLADIUS_ENV_TOOL_BE_CONNECT_TIMEOUT_NAME,
+                 timeoutInSec
+             );
+    if (GLADIUS_SUCCESS != rc && GLADIUS_ENV_NOT_SET != rc) return rc;
+    //
+    const auto deadline = steady_clock::now() + seconds(timeoutInSec);
+    // Start by polling quickly, then back off.
+    auto pause = milliseconds(10);
+    static const auto maxPause = milliseconds(250);
+    while (0 != access(infoFile.c_str(), R_OK)) {
+        if (steady_clock::now() >= deadline) {
+            GLADIUS_CERR << "Timed out waiting for connection info: "
+                         << infoFile << endl;
+            return GLADIUS_TIMEOUT;
+        }
+        std::this_thread::sleep_for(pause);
+        pause = std::min(pause * 2, maxPause);
+    }
     //
     return GLADIUS_SUCCESS;
 }
@@ -213,8 +371,11 @@ MRNetBE::mGetConnectionInfo(void)
                     + string(mSessionKey) + "-"
                     + to_string(mUID);
     //
+    int rc = mWaitForConnectionInfo(infoFile);
+    if (GLADIUS_SUCCESS != rc) return rc;
+    //
     size_t fileSize = 0;
-    int rc = core::utils::getSizeOfFile(infoFile, fileSize);
+    rc = core::utils::getSizeOfFile(infoFile, fileSize);
     if (GLADIUS_SUCCESS != rc) return rc;
     // Sanity
     if (0 != fileSize % sizeof(ToolLeafInfoT)) {
@@ -324,7 +485,7 @@ MRNetBE::mStartToolThreads(void)
     for (size_t i = 0; i < nThreads; ++i) {
         ThreadPersonality *tp = new ThreadPersonality();
         // TODO FIXME: calculate proper rank.
-        tp->rank = (10000 * (i + 1)) + mUID;
+        tp->rank = (toolcommon::GladiusBEMRNetRankBase * (i + 1)) + mUID;
         tp->argv[0] = mHostExecPath.c_str();
         tp->argv[1] = mParentHostname;
         tp->argv[2] = mParentPort;
@@ -371,18 +532,137 @@ MRNetBE::mToolThreadMain(
                             GLADIUS_WHERE
                         )
                      << endl;
+        mSetConnected(GLADIUS_ERR_MRNET);
         return GLADIUS_ERR_MRNET;
     }
     //
     int rc = mHandshake();
-    if (GLADIUS_SUCCESS != rc) return rc;
-    string p1, p2;
-    rc = mPluginInfoRecv(p1, p2);
+    if (GLADIUS_SUCCESS == rc) rc = mStartHeartbeat();
+    mSetConnected(rc);
     if (GLADIUS_SUCCESS != rc) return rc;
     //
+    rc = mServeSessions();
+    mStopHeartbeatThread();
+    //
+    return rc;
+}
+
+/**
+ * Receives the heartbeat configuration from the front-end (this also sets up
+ * the heartbeat stream) and starts sending heartbeats, if enabled.
+ */
+int
+MRNetBE::mStartHeartbeat(void)
+{
+    MRN::PacketPtr packet;
+    const bool recvShouldBlock = true;
+    int tag = 0;
+    auto status = mNet->recv(&tag, packet, &mHeartbeatStream, recvShouldBlock);
+    if (1 != status) {
+        static const string f = "Network::Recv";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR_MRNET;
+    }
+    if (toolcommon::MRNetCoreTags::Heartbeat != tag) {
+        static const string errs = "Received Invalid Tag From Tool Front-End";
+        GLADIUS_CERR << errs << endl;
+        return GLADIUS_ERR;
+    }
+    status = packet->unpack("%ud", &mHeartbeatIntervalInMS);
+    if (0 != status) {
+        static const string f = "PacketPtr::unpack";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR_MRNET;
+    }
+    if (0 == mHeartbeatIntervalInMS) {
+        VCOMP_COUT("Heartbeats disabled." << endl);
+        return GLADIUS_SUCCESS;
+    }
+    VCOMP_COUT(
+        "Sending heartbeats every " << mHeartbeatIntervalInMS << " ms." << endl
+    );
+    mStopHeartbeat = false;
+    mHeartbeatThread = thread(&MRNetBE::mHeartbeatMain, this);
+    //
     return GLADIUS_SUCCESS;
 }
 
+/**
+ * Tells the front-end that we are alive every mHeartbeatIntervalInMS until
+ * told to stop. Runs in its own thread so that a busy plugin does not make us
+ * look dead.
+ */
+void
+MRNetBE::mHeartbeatMain(void)
+{
+    const auto interval = chrono::milliseconds(mHeartbeatIntervalInMS);
+    // Ours is merged with everyone else's on the way up.
+    core::RankSet me;
+    me.insert(core::RankSet::Rank(mUID));
+    vector<uint64_t> words;
+    me.serialize(words);
+    unique_lock<mutex> lock(mHeartbeatMtx);
+    while (!mStopHeartbeat) {
+        if (-1 == mHeartbeatStream->send(
+                      toolcommon::MRNetCoreTags::Heartbeat,
+                      GLADIUS_RANK_SET_PACKET_FORMAT,
+                      words.data(), int(words.size())
+                  ) || -1 == mHeartbeatStream->flush()) {
+            GLADIUS_CERR << "Could not send heartbeat. Giving up on them."
+                         << endl;
+            return;
+        }
+        mHeartbeatCV.wait_for(lock, interval, [this] {
+            return mStopHeartbeat;
+        });
+    }
+}
+
+/**
+ *
+ */
+void
+MRNetBE::mStopHeartbeatThread(void)
+{
+    {
+        lock_guard<mutex> lock(mHeartbeatMtx);
+        mStopHeartbeat = true;
+    }
+    mHeartbeatCV.notify_all();
+    if (mHeartbeatThread.joinable()) mHeartbeatThread.join();
+}
+
+/**
+ * Serves plugin sessions until the front-end tells us to shut down. The
+ * network (and this daemon) outlives any one session, so a front-end can
+ * start a new session over the existing tree without another lash-up.
+ */
+int
+MRNetBE::mServeSessions(void)
+{
+    for (unsigned nSessions = 0; ; ++nSessions) {
+        bool shutdown = false;
+        string pluginName, pluginPath;
+        int rc = mPluginInfoRecv(shutdown, pluginName, pluginPath);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        if (shutdown) {
+            VCOMP_COUT(
+                "Shutting down after " << nSessions << " session(s)." << endl
+            );
+            return GLADIUS_SUCCESS;
+        }
+        if (!mPluginSessionFn) {
+            VCOMP_COUT("No plugin session handler. Skipping session." << endl);
+            continue;
+        }
+        rc = mPluginSessionFn(pluginName, pluginPath);
+        // A failed session doesn't take the tree down with it.
+        if (GLADIUS_SUCCESS != rc) {
+            GLADIUS_CERR << "Plugin session failed: " << pluginName << endl;
+        }
+    }
+}
+
 /**
  *
  */
@@ -436,10 +716,13 @@ MRNetBE::mHandshake(void)
 }
 
 /**
- * Receives valid plugin name and path from FE.
+ * Receives valid plugin name and path from FE. Sets shutdown instead if the
+ * FE is done with us. Plugin packets left over from an earlier session are
+ * skipped.
  */
 int
 MRNetBE::mPluginInfoRecv(
+    bool &shutdown,
     string &validPluginName,
     string &pathToValidPlugin
 ) {
@@ -449,32 +732,45 @@ MRNetBE::mPluginInfoRecv(
     MRN::Stream *stream = nullptr;
     const bool recvShouldBlock = true;
     int tag = 0;
-    auto status = mNet->recv(&tag, packet, &stream, recvShouldBlock);
-    if (1 != status) {
-        static const string f = "Network::Recv";
-        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
-        return GLADIUS_ERR_MRNET;
+    int status = 0;
+    // What the last session received for us, if anything.
+    if (mPutBackPacket) {
+        tag = mPutBackTag;
+        std::swap(packet, mPutBackPacket);
+    }
+    while (!packet || toolcommon::isPluginTag(tag)) {
+        if (packet) {
+            VCOMP_COUT("Skipping stale plugin packet (tag " << tag << ")."
+                       << endl);
+        }
+        status = mNet->recv(&tag, packet, &stream, recvShouldBlock);
+        if (1 != status) {
+            static const string f = "Network::Recv";
+            GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+            return GLADIUS_ERR_MRNET;
+        }
     }
+    shutdown = (toolcommon::MRNetCoreTags::Shutdown == tag);
+    if (shutdown) return GLADIUS_SUCCESS;
     // Make sure that we are dealing with a tag that we are expecting...
     if (toolcommon::MRNetCoreTags::PluginNameInfo != tag) {
         static const string errs = "Received Invalid Tag From Tool Front-End";
         GLADIUS_CERR << errs << endl;
         return GLADIUS_ERR;
     }
-    char *pluginName = nullptr;
-    char *pluginPath = nullptr;
-    status = packet->unpack("%s %s", &pluginName, &pluginPath);
-    if (0 != status) {
-        static const string f = "PacketPtr::unpack";
+    toolcommon::TxMessage msg;
+    status = msg.unpack(packet);
+    if (GLADIUS_SUCCESS != status) {
+        static const string f = "TxMessage::unpack";
         GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
-        return GLADIUS_ERR_MRNET;
+        return status;
     }
     // Set returns.
-    validPluginName = string(pluginName);
-    pathToValidPlugin = string(pluginPath);
-    //
-    free(pluginName);
-    free(pluginPath);
+    if (!msg.getStr(validPluginName) || !msg.getStr(pathToValidPlugin)) {
+        static const string errs = "Received Malformed Plugin Info";
+        GLADIUS_CERR << errs << endl;
+        return GLADIUS_ERR;
+    }
     //
     VCOMP_COUT("Front-End Plugin Info:" << endl);
     VCOMP_COUT("*Name: " << validPluginName << endl);
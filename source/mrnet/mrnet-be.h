@@ -14,14 +14,14 @@
 
 #include "tool-common/tool-common.h"
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <thread>
 
-// Forward declarations
-namespace MRN {
-    class Network;
-    class Stream;
-}
+#include "mrnet/MRNet.h"
 
 namespace gladius {
 namespace mrnetbe {
@@ -39,6 +39,21 @@ struct ThreadPersonality {
  * Implements the MRNet interface for a tool back-end.
  */
 class MRNetBE {
+public:
+    /**
+     * Runs one plugin session given the plugin's name and the path to its
+     * plugin pack. Returns when the session is over.
+     */
+    typedef std::function<
+        int(const std::string &pluginName, const std::string &pluginPath)
+    > PluginSessionFn;
+    /**
+     * Called once, from a tool thread, when the lash-up is done: with
+     * GLADIUS_SUCCESS once we are connected to the front-end, or with why we
+     * couldn't be. Must not block.
+     */
+    typedef std::function<void(int rc)> ConnectedFn;
+
 private:
     //  Constant indicating that we don't yet have a unique ID.
     static constexpr int sNOUID = -1;
@@ -68,6 +83,35 @@ private:
     MRN::Stream *mProtoStream = nullptr;
     // Pool of tool threads.
     std::vector<std::thread> mToolThreads;
+    // What to do with each plugin session that the front-end starts.
+    PluginSessionFn mPluginSessionFn;
+    // A core protocol packet that a plugin session received for us (see
+    // putBackCorePacket). Null if there isn't one.
+    MRN::PacketPtr mPutBackPacket;
+    //
+    int mPutBackTag = 0;
+    // Stream that our heartbeats go out on.
+    MRN::Stream *mHeartbeatStream = nullptr;
+    // Time between heartbeats (as told by the front-end). 0 if disabled.
+    unsigned mHeartbeatIntervalInMS = 0;
+    // Sends our heartbeats.
+    std::thread mHeartbeatThread;
+    //
+    std::mutex mHeartbeatMtx;
+    //
+    std::condition_variable mHeartbeatCV;
+    // Tells mHeartbeatThread to stop.
+    bool mStopHeartbeat = false;
+    // Runs the lash-up (and then serves sessions) for connectAsync.
+    std::thread mLashUpThread;
+    // Guards mConnectRC and mConnectedFn.
+    std::mutex mConnectMtx;
+    //
+    std::condition_variable mConnectCV;
+    // GLADIUS_NOT_CONNECTED until the lash-up is done, then its outcome.
+    int mConnectRC = GLADIUS_NOT_CONNECTED;
+    //
+    ConnectedFn mConnectedFn;
     //
     int
     mSetLocalIP(void);
@@ -76,6 +120,11 @@ private:
     mSetSelfPath(void);
     //
     int
+    mWaitForConnectionInfo(
+        const std::string &infoFile
+    );
+    //
+    int
     mGetConnectionInfo(void);
     //
     int
@@ -91,9 +140,28 @@ private:
     //
     int
     mPluginInfoRecv(
+        bool &shutdown,
         std::string &validPluginName,
         std::string &pathToValidPlugin
     );
+    //
+    int
+    mServeSessions(void);
+    //
+    int
+    mStartHeartbeat(void);
+    //
+    void
+    mHeartbeatMain(void);
+    //
+    void
+    mStopHeartbeatThread(void);
+    //
+    int
+    mLashUpMain(void);
+    //
+    void
+    mSetConnected(int rc);
 
 public:
     //
@@ -109,6 +177,56 @@ public:
     //
     int
     connect(void);
+    //
+    int
+    connectAsync(const ConnectedFn &fn = ConnectedFn());
+    //
+    int
+    connectStatus(void);
+    //
+    int
+    waitForConnect(int timeoutInMS = -1);
+    //
+    int
+    wait(void);
+
+    /**
+     * Sets what to do with each plugin session. The tree stays up between
+     * sessions, so this may be called many times over a daemon's lifetime.
+     */
+    void
+    setPluginSessionFn(const PluginSessionFn &fn) {
+        mPluginSessionFn = fn;
+    }
+
+    /**
+     * Hands back a core protocol packet (tag and packet) that a plugin session
+     * received instead of us, so that the next wait for plugin info sees it.
+     */
+    void
+    putBackCorePacket(
+        int tag,
+        const MRN::PacketPtr &packet
+    ) {
+        mPutBackTag = tag;
+        mPutBackPacket = packet;
+    }
+
+    /**
+     * Returns the protocol stream (valid once the handshake is done).
+     */
+    MRN::Stream *
+    getProtoStream(void) const {
+        return mProtoStream;
+    }
+
+    /**
+     *
+     */
+    MRN::Network *
+    getNetwork(void) const {
+        return mNet;
+    }
 };
 
 } // end mrnetbe namespace
@@ -19,16 +19,19 @@
 #include "core/session.h"
 #include "core/colors.h"
 #include "tool-common/tool-common.h"
+#include "tool-common/tx-message.h"
 
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <set>
 #include <mutex>
 #include <iomanip>
+#include <memory>
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -55,6 +58,16 @@ do {                                                                           \
     }                                                                          \
 } while (0)
 
+/**
+ * Returns hn without its domain, so that names reported by MRNet and by the
+ * targets compare equal.
+ */
+string
+shortHostName(const string &hn)
+{
+    return hn.substr(0, hn.find('.'));
+}
+
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -113,11 +126,9 @@ MRNetTopology::mGenFlatTopo(void)
     // The "host:0 =>" bit.
     // The top of the tree is always going to be localhost.
     string resTopoStr = "localhost: " + to_string(id++) + " =>\n";
-    for (const auto &l : mProcLandscape.landscape()) {
-        const string hostName = l.first;
-        const int nOnHost = l.second;
-        for (int targetID = 0; targetID < nOnHost; ++targetID) {
-            resTopoStr += "  " + hostName + ":" + to_string(id++) + "\n";
+    for (const auto &h : mProcLandscape.hosts()) {
+        for (int targetID = 0; targetID < h.nProcs; ++targetID) {
+            resTopoStr += "  " + h.name + ":" + to_string(id++) + "\n";
         }
     }
     resTopoStr += ";";
@@ -152,20 +163,32 @@ beConnectCbFn(
 }
 
 /**
- * Node lost callback.
+ * Node lost callback. data is the MRNetFE that registered us.
  */
 void
 nodeLostCbFn(
     MRN::Event *event,
-    void *
+    void *data
 ) {
     static mutex mtx;
     lock_guard<mutex> lock(mtx);
     if (MRN::Event::TOPOLOGY_EVENT == event->get_Class() &&
         MRN::TopologyEvent::TOPOL_REMOVE_NODE == event->get_Type()) {
-        COMP_COUT << "A Node Loss Was Detected!" << endl << flush;
+        auto *ted = static_cast<MRN::TopologyEvent::TopolEventData *>(
+                        event->get_Data()
+                    );
+        if (!ted || !data) {
+            COMP_COUT << "A Node Loss Was Detected!" << endl << flush;
+            return;
+        }
+        static_cast<MRNetFE *>(data)->nodeLost(ted->_rank);
     }
 }
+
+// Default number of seconds between back-end heartbeats.
+const int defaultHeartbeatIntervalInSec = 5;
+// Default number of heartbeats in a row that a back-end may miss.
+const int defaultHeartbeatMaxMissed = 3;
 } // end namespace
 
 const string MRNetFE::sCommNodeName = "mrnet_commnode";
@@ -199,6 +222,7 @@ MRNetFE::MRNetFE(
  */
 MRNetFE::~MRNetFE(void)
 {
+    mStopHeartbeatMonitorThread();
     // TODO complete
     if (mNetwork) {
         delete mNetwork;
@@ -238,12 +262,27 @@ MRNetFE::init(
         if (GLADIUS_SUCCESS != (rc = mSetEnvs())) {
             return GLADIUS_ERR;
         }
+        if (GLADIUS_SUCCESS != (rc = mGetHeartbeatSettings())) {
+            return rc;
+        }
         //
         mSessionDir = core::SessionFE::TheSession().sessionDir();
-        // Create a unique name for the file.
-        mTopoFile = mSessionDir + utils::osPathSep
-                  + utils::getHostname() + "-"
-                  + to_string(getpid()) + "-" + CNAME + ".topo";
+        // Use the user's topology, if provided.
+        mUserTopoFile = utils::envVarSet(GLADIUS_ENV_TOOL_FE_TOPO_FILE_NAME);
+        if (mUserTopoFile) {
+            mTopoFile = utils::getEnv(GLADIUS_ENV_TOOL_FE_TOPO_FILE_NAME);
+            if (0 != access(mTopoFile.c_str(), R_OK)) {
+                GLADIUS_CERR << "Cannot read topology file: " << mTopoFile
+                             << endl;
+                return GLADIUS_ERR;
+            }
+        }
+        // Otherwise, create a unique name for the one that we generate.
+        else {
+            mTopoFile = mSessionDir + utils::osPathSep
+                      + utils::getHostname() + "-"
+                      + to_string(getpid()) + "-" + CNAME + ".topo";
+        }
         VCOMP_COUT("Topology specification file: " << mTopoFile << endl);
     }
     catch (const exception &e) {
@@ -335,7 +374,7 @@ MRNetFE::mRegisterEventCallbacks(void)
              Event::TOPOLOGY_EVENT,
              TopologyEvent::TOPOL_REMOVE_NODE,
              nodeLostCbFn,
-             NULL
+             this
          );
     if (!rc) ++nErrs;
     //
@@ -359,13 +398,18 @@ MRNetFE::mBuildNetwork(void)
     VCOMP_COUT("Building network..." << endl);
     //
     try {
-        // Create the topology file.
-        MRNetTopology topo(
-            mTopoFile,
-            MRNetTopology::TopologyType::FLAT,
-            core::utils::getHostname(),
-            mProcLandscape
-        );
+        // Create the topology file, unless we were given one.
+        std::unique_ptr<MRNetTopology> topo;
+        if (!mUserTopoFile) {
+            topo.reset(
+                new MRNetTopology(
+                    mTopoFile,
+                    MRNetTopology::TopologyType::FLAT,
+                    core::utils::getHostname(),
+                    mProcLandscape
+                )
+            );
+        }
         mNetwork = Network::CreateNetworkFE(
                        mTopoFile.c_str(), // path to topology file
                        NULL,              // path to back-end exe
@@ -456,7 +500,31 @@ MRNetFE::mEchoNetStats(void)
 }
 
 /**
- *
+ * Fills mProcTab with a host entry for every rank in mProcLandscape.
+ */
+void
+MRNetFE::mBuildProcessTable(void)
+{
+    size_t nEntries = 0;
+    for (const auto &h : mProcLandscape.hosts()) nEntries += h.ranks.size();
+    //
+    mProcTab = toolcommon::ProcessTable(nEntries);
+    size_t entry = 0;
+    for (const auto &h : mProcLandscape.hosts()) {
+        h.ranks.forEachRange([&](core::RankSet::Rank lo,
+                                 core::RankSet::Rank hi) {
+            for (auto rank = lo; rank <= hi; ++rank) {
+                mProcTab.setEntry(entry++, h.name.c_str(), nullptr, 0, rank);
+                if (rank == hi) break;
+            }
+        });
+    }
+}
+
+/**
+ * Assigns each back-end a leaf (parent) in the tree. When the landscape knows
+ * where each rank lives, back-ends are spread round-robin across the leaves on
+ * their own host, and a link crosses hosts only when that host has no leaves.
  */
 int
 MRNetFE::generateConnectionMap(
@@ -464,38 +532,91 @@ MRNetFE::generateConnectionMap(
 ) {
     VCOMP_COUT("Generating connection map..." << endl);
     //
-    const auto numLeaves = mLeafInfo.leaves.size();
-    mNExpectedBEs = numLeaves * mNThread;
-    //
-    const unsigned besPerLeaf = mNExpectedBEs / numLeaves;
-    unsigned currLeaf = 0;
-    for (unsigned i = 0; (i < mNExpectedBEs) && (currLeaf < numLeaves); ++i) {
-        if( i && (i % besPerLeaf == 0) ) {
-            // select next parent
-            currLeaf++;
-            if (currLeaf == numLeaves) {
-                // except when there is no "next"
-                currLeaf--;
+    auto &leaves = mLeafInfo.leaves;
+    const auto numLeaves = leaves.size();
+    if (0 == numLeaves) {
+        GLADIUS_CERR << "No leaves in MRNet topology!" << endl;
+        return GLADIUS_ERR;
+    }
+    // Leaves may serve more than one target when the topology is not flat
+    // (e.g., a user-supplied 1xN topology for N << number of targets).
+    mNExpectedBEs = mProcLandscape.nProcesses() * mNThread;
+    //
+    const unsigned besPerLeaf = (mNExpectedBEs + numLeaves - 1) / numLeaves;
+    // Without rank placement info, fall back to filling leaves in order.
+    const bool haveRanks = mProcLandscape.haveRanks();
+    // Leaves by the host they run on, each with a round-robin cursor.
+    unordered_map<string, pair<vector<size_t>, size_t> > hostLeaves;
+    for (size_t l = 0; l < numLeaves; ++l) {
+        const string hn = shortHostName(leaves[l]->get_HostName());
+        hostLeaves[hn].first.push_back(l);
+    }
+    // And by the host ID of the targets that run there.
+    vector<pair<vector<size_t>, size_t> > hostIDLeaves;
+    if (haveRanks) {
+        mBuildProcessTable();
+        hostIDLeaves.resize(mProcTab.nHosts());
+        for (size_t h = 0; h < hostIDLeaves.size(); ++h) {
+            auto found = hostLeaves.find(shortHostName(mProcTab.hostName(h)));
+            if (found != hostLeaves.end()) hostIDLeaves[h] = found->second;
+        }
+    }
+    vector<unsigned> leafLoad(numLeaves, 0);
+    mBEParentRanks.assign(mNExpectedBEs, 0);
+    // Where to start looking for a parent when no local one exists.
+    size_t remoteCursor = 0;
+    unsigned nRemote = 0;
+    for (unsigned i = 0; i < mNExpectedBEs; ++i) {
+        size_t leaf = numLeaves;
+        if (!haveRanks) {
+            leaf = std::min(size_t(i / besPerLeaf), numLeaves - 1);
+        }
+        else {
+            // Prefer a parent on the same host as our target (rank).
+            const int hid = mProcTab.hostIDOfRank(i / mNThread);
+            if (-1 != hid && !hostIDLeaves[hid].first.empty()) {
+                auto &local = hostIDLeaves[hid];
+                leaf = local.first[local.second++ % local.first.size()];
+            }
+            // No local parent, so pick the next leaf with room for us.
+            if (numLeaves == leaf) {
+                for (size_t n = 0; n < numLeaves; ++n) {
+                    const size_t l = (remoteCursor + n) % numLeaves;
+                    if (leafLoad[l] < besPerLeaf) {
+                        leaf = l;
+                        break;
+                    }
+                }
+                if (numLeaves == leaf) leaf = remoteCursor % numLeaves;
+                remoteCursor = leaf + 1;
+                ++nRemote;
             }
         }
-        auto &leaves = mLeafInfo.leaves;
+        ++leafLoad[leaf];
 #if 0 // DEBUG
         fprintf(stdout, "ToolBE %u will connect to %s:%d:%d\n",
                 i,
-                leaves[currLeaf]->get_HostName().c_str(),
-                leaves[currLeaf]->get_Port(),
-                leaves[currLeaf]->get_Rank()
+                leaves[leaf]->get_HostName().c_str(),
+                leaves[leaf]->get_Port(),
+                leaves[leaf]->get_Rank()
         );
 #endif
         // Build the info
         toolcommon::ToolLeafInfoT mi;
         memset(&mi, 0, sizeof(mi));
-        const char *hn = leaves[currLeaf]->get_HostName().c_str();
+        const char *hn = leaves[leaf]->get_HostName().c_str();
         memmove(mi.parentHostName, hn, strlen(hn) + 1);
-        mi.parentRank = leaves[currLeaf]->get_Rank();
-        mi.parentPort = leaves[currLeaf]->get_Port();
+        mi.parentRank = leaves[leaf]->get_Rank();
+        mi.parentPort = leaves[leaf]->get_Port();
         mi.rank       = i;
         cMap.push_back(mi);
+        mBEParentRanks[i] = mi.parentRank;
+    }
+    if (haveRanks) {
+        VCOMP_COUT(
+            nRemote << " of " << mNExpectedBEs
+            << " back-ends have an off-host parent." << endl
+        );
     }
     //
     return GLADIUS_SUCCESS;
@@ -599,12 +720,51 @@ MRNetFE::mLoadCoreFilters(void)
         return GLADIUS_ERR_MRNET;
     }
     //
-    mProtoStream = mNetwork->new_Stream(
+    const int rc = mProtoSyncStream.create(
+                       mNetwork,
                        mBcastComm,
-                       MRN::SFILTER_WAITFORALL,
-                       filterID
+                       filterID,
+                       StreamSync::waitForAll()
                    );
-    if (!mProtoStream) {
+    mProtoStream = mProtoSyncStream.stream();
+    if (GLADIUS_SUCCESS != rc || !mProtoStream) {
+        static const string f = "MRN::Network->new_Stream";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR_MRNET;
+    }
+    // Heartbeats are merged on their way up, a time window at each level, so
+    // the front-end sees a few packets per interval regardless of scale.
+    const auto heartbeatFilterID = mNetwork->load_FilterFunc(
+                                       coreFilterSOName.c_str(),
+                                       "GladiusMRNetHeartbeatFilter"
+                                   );
+    if (-1 == heartbeatFilterID) {
+        static const string f = "load_FilterFunc: GladiusMRNetHeartbeatFilter";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR_MRNET;
+    }
+    const unsigned windowInMS = std::max(1U, mHeartbeatIntervalInMS / 2);
+    const int hbrc = mHeartbeatSyncStream.create(
+                         mNetwork,
+                         mBcastComm,
+                         heartbeatFilterID,
+                         StreamSync::timeWindow(windowInMS),
+                         // The number of back-ends in a merged heartbeat.
+                         [](const MRN::PacketPtr &packet) {
+                             uint64_t *words = nullptr;
+                             int nWords = 0;
+                             if (0 != packet->unpack(
+                                          GLADIUS_RANK_SET_PACKET_FORMAT,
+                                          &words, &nWords
+                                      )) return 0U;
+                             toolcommon::RankSet uids;
+                             (void)uids.deserialize(words, size_t(nWords));
+                             free(words);
+                             return unsigned(uids.size());
+                         }
+                     );
+    mHeartbeatStream = mHeartbeatSyncStream.stream();
+    if (GLADIUS_SUCCESS != hbrc || !mHeartbeatStream) {
         static const string f = "MRN::Network->new_Stream";
         GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
         return GLADIUS_ERR_MRNET;
@@ -667,7 +827,7 @@ MRNetFE::handshake(void)
         return GLADIUS_ERR;
     }
     //
-    return GLADIUS_SUCCESS;
+    return mStartHeartbeatMonitor();
 }
 
 /**
@@ -680,15 +840,45 @@ MRNetFE::pluginInfoBCast(
 ) {
     VCOMP_COUT("Sending plugin info to back-ends..." << endl);
     //
-    const char *pluginName = validPluginName.c_str();
-    const char *pluginPath = pathToValidPlugin.c_str();
     // NOTE: The filters aren't setup to receive string data, so don't do
     // that with this particular stream and filter combo. Sending is fine.
+    toolcommon::TxMessageWriter msg;
+    msg.putStr(validPluginName).putStr(pathToValidPlugin);
+    auto status = msg.send(
+                      mProtoStream,
+                      toolcommon::MRNetCoreTags::PluginNameInfo
+                  );
+    if (GLADIUS_SUCCESS != status) {
+        static const string f = "Stream::Send";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR;
+    }
+    status = mProtoStream->flush();
+    if (-1 == status) {
+        static const string f = "Stream::Flush";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR;
+    }
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Tells the back-ends that we are done with them. Until this is sent, they
+ * wait for new plugin sessions on the protocol stream.
+ */
+int
+MRNetFE::shutdownBCast(void)
+{
+    VCOMP_COUT("Sending shutdown to back-ends..." << endl);
+    // They are about to stop their heartbeats.
+    mStopHeartbeatMonitorThread();
+    //
+    if (!mProtoStream) return GLADIUS_NOT_CONNECTED;
     auto status = mProtoStream->send(
-                      toolcommon::MRNetCoreTags::PluginNameInfo,
-                      "%s %s",
-                      pluginName,
-                      pluginPath
+                      toolcommon::MRNetCoreTags::Shutdown,
+                      "%d",
+                      0
                   );
     if (-1 == status) {
         static const string f = "Stream::Send";
@@ -704,3 +894,211 @@ MRNetFE::pluginInfoBCast(
     //
     return GLADIUS_SUCCESS;
 }
+
+/**
+ * Reads the heartbeat settings from the environment.
+ */
+int
+MRNetFE::mGetHeartbeatSettings(void)
+{
+    int intervalInSec = defaultHeartbeatIntervalInSec;
+    int rc = utils::getEnvAs(
+                 GLADIUS_ENV_TOOL_HEARTBEAT_INTERVAL_NAME,
+                 intervalInSec
+             );
+    if (GLADIUS_SUCCESS != rc && GLADIUS_ENV_NOT_SET != rc) return rc;
+    //
+    int maxMissed = defaultHeartbeatMaxMissed;
+    rc = utils::getEnvAs(
+             GLADIUS_ENV_TOOL_HEARTBEAT_MAX_MISSED_NAME,
+             maxMissed
+         );
+    if (GLADIUS_SUCCESS != rc && GLADIUS_ENV_NOT_SET != rc) return rc;
+    //
+    if (intervalInSec < 0 || maxMissed < 1) {
+        GLADIUS_CERR << "Invalid heartbeat settings: interval "
+                     << intervalInSec << " s, max missed " << maxMissed
+                     << endl;
+        return GLADIUS_ERR;
+    }
+    mHeartbeatIntervalInMS = unsigned(intervalInSec) * 1000;
+    mHeartbeatMaxMissed = unsigned(maxMissed);
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Tells the back-ends how often to send heartbeats (this also sets up the
+ * heartbeat stream on their end) and starts watching for them.
+ */
+int
+MRNetFE::mStartHeartbeatMonitor(void)
+{
+    auto status = mHeartbeatStream->send(
+                      toolcommon::MRNetCoreTags::Heartbeat,
+                      "%ud",
+                      mHeartbeatIntervalInMS
+                  );
+    if (-1 == status || -1 == mHeartbeatStream->flush()) {
+        static const string f = "Stream::Send";
+        GLADIUS_CERR << utils::formatCallFailed(f, GLADIUS_WHERE) << endl;
+        return GLADIUS_ERR_MRNET;
+    }
+    if (0 == mHeartbeatIntervalInMS) {
+        VCOMP_COUT("Heartbeats disabled." << endl);
+        return GLADIUS_SUCCESS;
+    }
+    VCOMP_COUT(
+        "Expecting heartbeats every " << mHeartbeatIntervalInMS << " ms. "
+        "Back-ends are lost after " << mHeartbeatMaxMissed << " missed." << endl
+    );
+    //
+    mStopHeartbeatMonitor = false;
+    mHeartbeatThread = thread(&MRNetFE::mHeartbeatMonitorMain, this);
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Records heartbeats as they come in and declares back-ends that have been
+ * quiet for too long lost. This catches back-ends that hang or become
+ * unreachable without the network noticing.
+ */
+void
+MRNetFE::mHeartbeatMonitorMain(void)
+{
+    using namespace std::chrono;
+    //
+    const auto interval = milliseconds(mHeartbeatIntervalInMS);
+    const auto maxSilence = interval * mHeartbeatMaxMissed;
+    //
+    unique_lock<mutex> lock(mLivenessMtx);
+    // Everyone is alive as of the handshake.
+    mLastHeartbeat.assign(mNExpectedBEs, steady_clock::now());
+    while (!mStopHeartbeatMonitor) {
+        lock.unlock();
+        // Drain what has arrived so far.
+        toolcommon::RankSet uids;
+        MRN::PacketPtr packet;
+        int tag = 0;
+        static const bool recvShouldBlock = false;
+        while (1 == mHeartbeatStream->recv(&tag, packet, recvShouldBlock)) {
+            if (toolcommon::MRNetCoreTags::Heartbeat != tag) continue;
+            uint64_t *words = nullptr;
+            int nWords = 0;
+            if (0 != packet->unpack(
+                         GLADIUS_RANK_SET_PACKET_FORMAT, &words, &nWords
+                     )) continue;
+            toolcommon::RankSet heard;
+            if (GLADIUS_SUCCESS == heard.deserialize(words, size_t(nWords))) {
+                uids.merge(heard);
+            }
+            free(words);
+        }
+        lock.lock();
+        const auto now = steady_clock::now();
+        uids.forEachRange([&](toolcommon::RankSet::Rank lo,
+                              toolcommon::RankSet::Rank hi) {
+            for (auto uid = lo; uid <= hi; ++uid) {
+                if (uid < mLastHeartbeat.size()) mLastHeartbeat[uid] = now;
+                if (uid == hi) break;
+            }
+        });
+        toolcommon::RankSet quiet;
+        for (size_t uid = 0; uid < mLastHeartbeat.size(); ++uid) {
+            if (now - mLastHeartbeat[uid] <= maxSilence) continue;
+            if (mLostBEs.contains(uid)) continue;
+            quiet.insert(uid);
+        }
+        if (!quiet.empty()) {
+            lock.unlock();
+            mRecordLostBEs(quiet, "missed heartbeats");
+            lock.lock();
+        }
+        mHeartbeatCV.wait_for(lock, interval / 2, [this] {
+            return mStopHeartbeatMonitor;
+        });
+    }
+}
+
+/**
+ *
+ */
+void
+MRNetFE::mStopHeartbeatMonitorThread(void)
+{
+    {
+        lock_guard<mutex> lock(mLivenessMtx);
+        mStopHeartbeatMonitor = true;
+    }
+    mHeartbeatCV.notify_all();
+    if (mHeartbeatThread.joinable()) mHeartbeatThread.join();
+}
+
+/**
+ * Adds uids to the set of lost back-ends and reports the ones that are new.
+ */
+void
+MRNetFE::mRecordLostBEs(
+    const toolcommon::RankSet &uids,
+    const string &why
+) {
+    toolcommon::RankSet newlyLost;
+    size_t nLost = 0;
+    {
+        lock_guard<mutex> lock(mLivenessMtx);
+        uids.forEachRange([&](toolcommon::RankSet::Rank lo,
+                              toolcommon::RankSet::Rank hi) {
+            for (auto uid = lo; uid <= hi; ++uid) {
+                if (!mLostBEs.contains(uid)) newlyLost.insert(uid);
+            }
+        });
+        mLostBEs.merge(newlyLost);
+        nLost = mLostBEs.size();
+    }
+    if (newlyLost.empty()) return;
+    GLADIUS_CERR_WARN << "Lost " << newlyLost.size() << " back-end(s) ("
+                      << why << "): " << newlyLost.str() << ". "
+                      << nLost << " of " << mNExpectedBEs
+                      << " lost so far." << endl;
+}
+
+/**
+ * Called when the network tells us that it lost the node with the given MRNet
+ * rank. We record who we lost, and SyncStreams that know about lostBackEnds
+ * stop waiting for them.
+ */
+void
+MRNetFE::nodeLost(MRN::Rank rank)
+{
+    using toolcommon::GladiusBEMRNetRankBase;
+    // A back-end.
+    if (rank >= MRN::Rank(GladiusBEMRNetRankBase)) {
+        toolcommon::RankSet uid;
+        uid.insert((rank - GladiusBEMRNetRankBase) % GladiusBEMRNetRankBase);
+        mRecordLostBEs(uid, "disconnected");
+        return;
+    }
+    // A communication node. Its back-ends may be adopted by another node, in
+    // which case their heartbeats will keep coming. Without heartbeats, assume
+    // the worst.
+    toolcommon::RankSet orphans;
+    for (size_t uid = 0; uid < mBEParentRanks.size(); ++uid) {
+        if (rank == mBEParentRanks[uid]) orphans.insert(uid);
+    }
+    GLADIUS_CERR_WARN << "Lost tree node " << rank << " (parent of "
+                      << orphans.size() << " back-end(s))." << endl;
+    if (0 == mHeartbeatIntervalInMS) {
+        mRecordLostBEs(orphans, "parent lost");
+    }
+}
+
+/**
+ * Returns the UIDs of the back-ends that we have lost.
+ */
+toolcommon::RankSet
+MRNetFE::lostBackEnds(void) const
+{
+    lock_guard<mutex> lock(mLivenessMtx);
+    return mLostBEs;
+}
@@ -13,10 +13,16 @@
 #pragma once
 
 #include "core/process-landscape.h"
+#include "mrnet/sync-stream.h"
 #include "tool-common/tool-common.h"
 
-#include <string>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "mrnet/MRNet.h"
 
@@ -88,12 +94,18 @@ private:
     std::string mSessionDir;
     // Path to MRNet topology file.
     std::string mTopoFile;
+    // Whether or not mTopoFile was supplied by the user (and so is not ours to
+    // generate or remove).
+    bool mUserTopoFile = false;
     // Name of the backend executable
     std::string mBEExe;
     // Absolute path to MRNet installation.
     std::string mPrefixPath;
     // The process landscape of our job.
     core::ProcessLandscape mProcLandscape;
+    // Where each target (rank) runs, from mProcLandscape. Executable names and
+    // PIDs are not known here.
+    toolcommon::ProcessTable mProcTab;
     // Leaf infos
     LeafInfo mLeafInfo;
     // The MRNet network instance.
@@ -102,12 +114,36 @@ private:
     MRN::Communicator *mBcastComm = nullptr;
     //
     MRN::Stream *mProtoStream = nullptr;
+    // mProtoStream's owner. The protocol needs to hear from everyone.
+    SyncStream mProtoSyncStream;
     // The number of tree nodes in our topology.
     unsigned int mNTreeNodes = 0;
     // Number of tool threads per target.
     unsigned int mNThread = 0;
     //
     unsigned int mNExpectedBEs = 0;
+    // MRNet rank of each back-end's parent, indexed by back-end UID.
+    std::vector<MRN::Rank> mBEParentRanks;
+    // Stream that back-end heartbeats arrive on.
+    MRN::Stream *mHeartbeatStream = nullptr;
+    // mHeartbeatStream's owner.
+    SyncStream mHeartbeatSyncStream;
+    // Time between back-end heartbeats. 0 if disabled.
+    unsigned mHeartbeatIntervalInMS = 0;
+    // Number of heartbeats in a row that a back-end may miss.
+    unsigned mHeartbeatMaxMissed = 0;
+    // Watches for back-ends that have stopped sending heartbeats.
+    std::thread mHeartbeatThread;
+    // Protects what follows.
+    mutable std::mutex mLivenessMtx;
+    //
+    std::condition_variable mHeartbeatCV;
+    // Tells mHeartbeatThread to stop.
+    bool mStopHeartbeatMonitor = false;
+    // When we last heard from each back-end, indexed by back-end UID.
+    std::vector<std::chrono::steady_clock::time_point> mLastHeartbeat;
+    // UIDs of the back-ends that we have lost.
+    toolcommon::RankSet mLostBEs;
     //
     int
     mBuildNetwork(void);
@@ -118,6 +154,9 @@ private:
     int
     mPopulateLeafInfo(void);
     //
+    void
+    mBuildProcessTable(void);
+    //
     int
     mEchoNetStats(void);
     //
@@ -132,6 +171,24 @@ private:
     //
     int
     mLoadCoreFilters(void);
+    //
+    int
+    mGetHeartbeatSettings(void);
+    //
+    int
+    mStartHeartbeatMonitor(void);
+    //
+    void
+    mHeartbeatMonitorMain(void);
+    //
+    void
+    mStopHeartbeatMonitorThread(void);
+    //
+    void
+    mRecordLostBEs(
+        const toolcommon::RankSet &uids,
+        const std::string &why
+    );
 
 public:
     MRNetFE(void);
@@ -192,6 +249,22 @@ public:
         const std::string &validPluginName,
         const std::string &pathToValidPlugin
     );
+    //
+    int
+    shutdownBCast(void);
+    //
+    void
+    nodeLost(MRN::Rank rank);
+    //
+    toolcommon::RankSet
+    lostBackEnds(void) const;
+    /**
+     * Returns the number of back-ends that we expect to hear from.
+     */
+    unsigned
+    nExpectedBackEnds(void) const {
+        return mNExpectedBEs;
+    }
 };
 
 } // end mrnetfe namespace
@@ -0,0 +1,493 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Front-end streams with Gladius-level synchronization. MRNet's sync filters
+ * either wait for every child, wait for a time window at each level, or do not
+ * wait at all. SyncStream builds wait-for-all, time-window, and first-k-of-n
+ * modes on top of them, and tells its user whether what came back is partial.
+ * Given a way to find out which back-ends have been lost, it stops waiting for
+ * them, and can rebuild itself without them (see setLostFn and dropLost).
+ */
+
+#pragma once
+
+#include "core/core.h"
+#include "core/rank-set.h"
+#include "tool-common/tool-common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+#include "mrnet/MRNet.h"
+
+namespace gladius {
+namespace mrnetfe {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * How a SyncStream decides that it has heard enough.
+ */
+struct StreamSync {
+    //
+    enum Mode {
+        // Every back-end's results (MRNet's wait-for-all).
+        WAIT_FOR_ALL,
+        // Whatever arrives within budgetInMS.
+        TIME_WINDOW,
+        // The first k back-ends' results, or whatever arrives within
+        // budgetInMS, whichever comes first.
+        FIRST_K
+    };
+    //
+    Mode mode = WAIT_FOR_ALL;
+    // TIME_WINDOW and FIRST_K: the latency budget.
+    unsigned budgetInMS = 0;
+    // FIRST_K: the number of back-ends whose results are enough.
+    unsigned k = 0;
+
+    /**
+     *
+     */
+    static StreamSync
+    waitForAll(void) {
+        return StreamSync();
+    }
+
+    /**
+     *
+     */
+    static StreamSync
+    timeWindow(unsigned budgetInMS) {
+        StreamSync s;
+        s.mode = TIME_WINDOW;
+        s.budgetInMS = budgetInMS;
+        return s;
+    }
+
+    /**
+     *
+     */
+    static StreamSync
+    firstK(
+        unsigned k,
+        unsigned budgetInMS
+    ) {
+        StreamSync s;
+        s.mode = FIRST_K;
+        s.k = k;
+        s.budgetInMS = budgetInMS;
+        return s;
+    }
+
+    /**
+     * Replaces this with what s says: "all", "window:MS", or "first:K:MS".
+     * Returns GLADIUS_ERR (and leaves this unchanged) if s is malformed.
+     */
+    int
+    fromStr(const std::string &s) {
+        if ("all" == s) {
+            *this = waitForAll();
+            return GLADIUS_SUCCESS;
+        }
+        const auto num = [](const std::string &n, unsigned &out) {
+            char *end = nullptr;
+            const unsigned long v = strtoul(n.c_str(), &end, 10);
+            if (n.empty() || *end || v == 0 || v > 0xFFFFFFFFUL) return false;
+            out = unsigned(v);
+            return true;
+        };
+        static const std::string windowPrefix = "window:";
+        static const std::string firstPrefix = "first:";
+        unsigned a = 0, b = 0;
+        if (0 == s.compare(0, windowPrefix.size(), windowPrefix)) {
+            if (!num(s.substr(windowPrefix.size()), a)) return GLADIUS_ERR;
+            *this = timeWindow(a);
+            return GLADIUS_SUCCESS;
+        }
+        if (0 == s.compare(0, firstPrefix.size(), firstPrefix)) {
+            const std::string rest = s.substr(firstPrefix.size());
+            const auto colon = rest.find(':');
+            if (std::string::npos == colon ||
+                !num(rest.substr(0, colon), a) ||
+                !num(rest.substr(colon + 1), b)) return GLADIUS_ERR;
+            *this = firstK(a, b);
+            return GLADIUS_SUCCESS;
+        }
+        return GLADIUS_ERR;
+    }
+
+    /**
+     * Returns the fromStr form of this.
+     */
+    std::string
+    str(void) const {
+        switch (mode) {
+            case TIME_WINDOW:
+                return "window:" + std::to_string(budgetInMS);
+            case FIRST_K:
+                return "first:" + std::to_string(k) + ":"
+                       + std::to_string(budgetInMS);
+            case WAIT_FOR_ALL:
+            default:
+                return "all";
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * A front-end stream that gathers results according to a StreamSync.
+ */
+class SyncStream {
+public:
+    /**
+     * Called for each packet as it arrives. Returns the number of back-ends
+     * whose results the packet carries.
+     */
+    typedef std::function<unsigned(const MRN::PacketPtr &)> PacketFn;
+
+    /**
+     * Returns the UIDs of the back-ends that have been lost so far (e.g.
+     * MRNetFE::lostBackEnds).
+     */
+    typedef std::function<core::RankSet(void)> LostFn;
+
+    /**
+     * What one recv gathered.
+     */
+    struct Result {
+        // The packets, in order of arrival.
+        std::vector<MRN::PacketPtr> packets;
+        // The number of back-ends whose results are in packets.
+        unsigned nBackEnds = 0;
+        // The number of back-ends on the stream.
+        unsigned nExpected = 0;
+        // The number of those that we had lost by the time recv returned.
+        unsigned nLost = 0;
+        // Whether or not some back-ends' results are missing.
+        bool partial = false;
+    };
+
+private:
+    // How long a wait-for-all recv keeps waiting once one of our back-ends is
+    // lost. The network may still deliver (if it noticed the loss, too).
+    static constexpr int sLostGraceInMS = 1000;
+    // How often a wait-for-all recv looks for lost back-ends.
+    static constexpr int sLostCheckIntervalInMS = 100;
+    //
+    MRN::Network *mNetwork = nullptr;
+    //
+    int mUSFilterID = MRN::TFILTER_NULL;
+    //
+    MRN::Stream *mStream = nullptr;
+    //
+    StreamSync mSync;
+    // The UIDs of the back-ends on the stream.
+    core::RankSet mEndPoints;
+    // The number of back-ends on the stream.
+    unsigned mNExpected = 0;
+    //
+    PacketFn mPacketFn;
+    //
+    LostFn mLostFn;
+
+    /**
+     * Without a PacketFn, a wait-for-all packet is everyone's that we haven't
+     * lost, and any other packet is a single back-end's (create only allows
+     * that when nothing merges packets on their way up).
+     */
+    unsigned
+    mCount(const MRN::PacketPtr &packet) const {
+        if (mPacketFn) return mPacketFn(packet);
+        if (StreamSync::WAIT_FOR_ALL != mSync.mode) return 1;
+        return mNExpected - std::min(mNExpected, mNLost());
+    }
+
+    /**
+     * Returns how many of our back-ends are in lost.
+     */
+    unsigned
+    mNLostIn(const core::RankSet &lost) const {
+        unsigned n = 0;
+        lost.forEachRange([&](core::RankSet::Rank lo, core::RankSet::Rank hi) {
+            for (auto uid = lo; uid <= hi; ++uid) {
+                if (mEndPoints.contains(uid)) ++n;
+                if (uid == hi) break;
+            }
+        });
+        return n;
+    }
+
+    /**
+     * Returns how many of our back-ends have been lost.
+     */
+    unsigned
+    mNLost(void) const {
+        return mLostFn ? mNLostIn(mLostFn()) : 0;
+    }
+
+    /**
+     * Waits up to timeoutInMS for packets to arrive.
+     */
+    void
+    mWaitForData(int timeoutInMS) {
+        const int dataFD = mStream->get_DataNotificationFd();
+        if (-1 != dataFD) {
+            struct pollfd pfd = {dataFD, POLLIN, 0};
+            (void)poll(&pfd, 1, timeoutInMS);
+            mStream->clear_DataNotificationFd();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    /**
+     * Makes our stream one over comm.
+     */
+    int
+    mNewStream(MRN::Communicator *comm) {
+        using toolcommon::GladiusBEMRNetRankBase;
+        int syncID = MRN::SFILTER_WAITFORALL;
+        switch (mSync.mode) {
+            case StreamSync::TIME_WINDOW:
+                syncID = MRN::SFILTER_TIMEOUT;
+                break;
+            case StreamSync::FIRST_K:
+                // Let results trickle up as they come, so we can stop at k.
+                syncID = MRN::SFILTER_DONTWAIT;
+                break;
+            case StreamSync::WAIT_FOR_ALL:
+            default:
+                break;
+        }
+        auto *stream = mNetwork->new_Stream(comm, mUSFilterID, syncID);
+        if (!stream) return GLADIUS_ERR_MRNET;
+        //
+        if (StreamSync::TIME_WINDOW == mSync.mode) {
+            // Every level of the tree waits at most its share of the budget.
+            unsigned nNodes = 0, depth = 0, minFanout = 0, maxFanout = 0;
+            double averageFanout = 0.0, stdDevFanout = 0.0;
+            mNetwork->get_NetworkTopology()->get_TreeStatistics(
+                nNodes, depth, minFanout, maxFanout,
+                averageFanout, stdDevFanout
+            );
+            const unsigned perLevelInMS = std::max(
+                                              1U,
+                                              mSync.budgetInMS
+                                              / std::max(1U, depth)
+                                          );
+            if (-1 == stream->set_FilterParameters(
+                          MRN::FILTER_UPSTREAM_SYNC, "%ud", perLevelInMS
+                      )) {
+                return GLADIUS_ERR_MRNET;
+            }
+        }
+        //
+        mStream = stream;
+        mEndPoints.clear();
+        for (const auto rank : comm->get_EndPoints()) {
+            if (rank < MRN::Rank(GladiusBEMRNetRankBase)) continue;
+            mEndPoints.insert(rank - GladiusBEMRNetRankBase);
+        }
+        mNExpected = comm->get_EndPoints().size();
+        return GLADIUS_SUCCESS;
+    }
+
+public:
+    //
+    SyncStream(void) = default;
+
+    /**
+     * Creates a stream over comm whose packets go through the upstream
+     * transformation filter usFilterID. Time-window and first-k streams whose
+     * filter may merge packets (any but TFILTER_NULL) need a packetFn to tell
+     * how many back-ends a packet speaks for; without one, GLADIUS_ERR.
+     */
+    int
+    create(
+        MRN::Network *network,
+        MRN::Communicator *comm,
+        int usFilterID,
+        const StreamSync &sync,
+        const PacketFn &packetFn = PacketFn()
+    ) {
+        if (StreamSync::WAIT_FOR_ALL != sync.mode &&
+            MRN::TFILTER_NULL != usFilterID && !packetFn) {
+            return GLADIUS_ERR;
+        }
+        mNetwork = network;
+        mUSFilterID = usFilterID;
+        mSync = sync;
+        mPacketFn = packetFn;
+        return mNewStream(comm);
+    }
+
+    /**
+     * Sets how we find out which back-ends have been lost. Without one, we
+     * wait for everyone.
+     */
+    void
+    setLostFn(const LostFn &lostFn) {
+        mLostFn = lostFn;
+    }
+
+    /**
+     * Rebuilds the stream without the back-ends that have been lost, so that
+     * new requests don't wait for them. Call before sending a new request.
+     * Requests already sent are answered on the old stream (see discardLate).
+     */
+    int
+    dropLost(void) {
+        if (!mLostFn) return GLADIUS_SUCCESS;
+        const auto lost = mLostFn();
+        if (0 == mNLostIn(lost)) return GLADIUS_SUCCESS;
+        std::set<MRN::Rank> keep;
+        mEndPoints.forEachRange([&](core::RankSet::Rank lo,
+                                    core::RankSet::Rank hi) {
+            for (auto uid = lo; uid <= hi; ++uid) {
+                if (!lost.contains(uid)) {
+                    keep.insert(uid + toolcommon::GladiusBEMRNetRankBase);
+                }
+                if (uid == hi) break;
+            }
+        });
+        // Nobody is left to ask.
+        if (keep.empty()) return GLADIUS_ERR;
+        auto *comm = mNetwork->new_Communicator(keep);
+        if (!comm) return GLADIUS_ERR_MRNET;
+        return mNewStream(comm);
+    }
+
+    /**
+     * Returns the underlying stream (e.g. for sending).
+     */
+    MRN::Stream *
+    stream(void) {
+        return mStream;
+    }
+
+    /**
+     *
+     */
+    const StreamSync &
+    sync(void) const {
+        return mSync;
+    }
+
+    /**
+     * Throws away results that showed up after an earlier recv stopped
+     * listening. Call before sending a new request. Returns how many packets
+     * were dropped.
+     */
+    unsigned
+    discardLate(void) {
+        static const bool recvShouldBlock = false;
+        unsigned n = 0;
+        int tag = 0;
+        MRN::PacketPtr packet;
+        while (1 == mStream->recv(&tag, packet, recvShouldBlock)) ++n;
+        return n;
+    }
+
+    /**
+     * Gathers results tagged with tag according to our StreamSync. Packets
+     * with other tags are an error.
+     */
+    int
+    recv(
+        int tag,
+        Result &res
+    ) {
+        using namespace std::chrono;
+        //
+        res = Result();
+        res.nExpected = mNExpected;
+        //
+        const auto take = [&](int gotTag, const MRN::PacketPtr &packet) {
+            if (gotTag != tag) return false;
+            res.nBackEnds += mCount(packet);
+            res.packets.push_back(packet);
+            return true;
+        };
+        //
+        int gotTag = 0;
+        MRN::PacketPtr packet;
+        static const bool recvShouldBlock = false;
+        if (StreamSync::WAIT_FOR_ALL == mSync.mode && !mLostFn) {
+            if (1 != mStream->recv(&gotTag, packet)) return GLADIUS_ERR_MRNET;
+            if (!take(gotTag, packet)) return GLADIUS_ERR;
+            res.partial = res.nBackEnds < res.nExpected;
+            return GLADIUS_SUCCESS;
+        }
+        if (StreamSync::WAIT_FOR_ALL == mSync.mode) {
+            // A back-end that hangs holds up everyone's results, so once one
+            // of ours is lost, we only wait a little longer.
+            bool lostSome = false;
+            steady_clock::time_point giveUpAt;
+            while (true) {
+                const int status = mStream->recv(
+                                       &gotTag, packet, recvShouldBlock
+                                   );
+                if (-1 == status) return GLADIUS_ERR_MRNET;
+                if (1 == status) {
+                    if (!take(gotTag, packet)) return GLADIUS_ERR;
+                    break;
+                }
+                if (!lostSome && mNLost() > 0) {
+                    lostSome = true;
+                    giveUpAt = steady_clock::now()
+                             + milliseconds(sLostGraceInMS);
+                }
+                if (lostSome && steady_clock::now() >= giveUpAt) break;
+                mWaitForData(sLostCheckIntervalInMS);
+            }
+            res.nLost = mNLost();
+            res.partial = res.nBackEnds < res.nExpected;
+            return GLADIUS_SUCCESS;
+        }
+        // Nobody waits for the back-ends that we have lost.
+        const unsigned nLive = mNExpected - std::min(mNExpected, mNLost());
+        const unsigned enough = (StreamSync::FIRST_K == mSync.mode)
+                              ? std::min(mSync.k, nLive) : nLive;
+        const auto deadline = steady_clock::now()
+                            + milliseconds(mSync.budgetInMS);
+        while (res.nBackEnds < enough) {
+            const int status = mStream->recv(&gotTag, packet, recvShouldBlock);
+            if (-1 == status) return GLADIUS_ERR_MRNET;
+            if (1 == status) {
+                if (!take(gotTag, packet)) return GLADIUS_ERR;
+                continue;
+            }
+            // Nothing yet. Wait for more (or for time to run out).
+            const auto left = duration_cast<milliseconds>(
+                                  deadline - steady_clock::now()
+                              ).count();
+            if (left <= 0) break;
+            mWaitForData(int(left));
+        }
+        res.nLost = mNLost();
+        res.partial = res.nBackEnds < res.nExpected;
+        //
+        return GLADIUS_SUCCESS;
+    }
+};
+
+} // end mrnetfe namespace
+} // end gladius namespace
@@ -24,13 +24,20 @@ namespace MRN {
     class Network;
 } // end namespace MRN
 
+namespace gladius {
+namespace toolbe {
+    class AppEventQueue;
+    class AppBreakpoints;
+} // end namespace toolbe
+} // end namespace gladius
+
 namespace gladius {
 namespace gpi {
 
 /**
  * Update when breaking plugin ABI.
  */
-#define GLADIUS_PLUGIN_ABI 0
+#define GLADIUS_PLUGIN_ABI 2
 
 /**
  * The plugin entry poing (symbol name).
@@ -43,20 +50,30 @@ namespace gpi {
 #define GLADIUS_PLUGIN_ENTRY_POINT_NAME                                        \
 GLADIUS_TOSTRING(GLADIUS_PLUGIN_ENTRY_POINT)
 
+/**
+ * Each plugin session gets a fresh plugin instance (see constructPlugin), which
+ * must be given back with destroyPlugin (so that it is freed by the code that
+ * allocated it).
+ */
 #define GLADIUS_PLUGIN(pluginImpl, pluginName, pluginVersion)                  \
 extern "C" {                                                                   \
 /* Return pointer here because of C linkage... Sigh... */                      \
 gladius::gpi::GladiusPlugin *                                                  \
 constructPlugin(void) {                                                        \
-    static pluginImpl singleton;                                               \
-    return &singleton;                                                         \
+    return new pluginImpl();                                                   \
+}                                                                              \
+                                                                               \
+void                                                                           \
+destroyPlugin(gladius::gpi::GladiusPlugin *plugin) {                           \
+    delete plugin;                                                             \
 }                                                                              \
                                                                                \
 gladius::gpi::GladiusPluginInfo GLADIUS_PLUGIN_ENTRY_POINT = {                 \
     GLADIUS_PLUGIN_ABI,                                                        \
     pluginName,                                                                \
     pluginVersion,                                                             \
-    constructPlugin                                                            \
+    constructPlugin,                                                           \
+    destroyPlugin                                                              \
 };                                                                             \
                                                                                \
 }
@@ -74,6 +91,19 @@ struct GladiusPluginArgs {
     MRN::Stream *protoStream = nullptr;
     //
     MRN::Network *network = nullptr;
+    // The tool UID (target rank) of the back-end that is running the plugin.
+    // -1 on the front-end.
+    int uid = -1;
+    // Back-end only: where the application leaves events that it records
+    // through the tool API (see tool-be/app-event-queue.h). nullptr on the
+    // front-end.
+    gladius::toolbe::AppEventQueue *appEvents = nullptr;
+    // Back-end only: where the plugin can stop application threads at events
+    // (see tool-be/app-breakpoints.h). nullptr on the front-end.
+    gladius::toolbe::AppBreakpoints *appBreakpoints = nullptr;
+    // Front-end only: returns the UIDs of the back-ends lost so far (hand it
+    // to SyncStream::setLostFn). Empty on the back-end.
+    std::function<gladius::toolcommon::RankSet(void)> lostBackEnds;
     //
     GladiusPluginArgs(void) { ; }
     /**
@@ -83,11 +113,13 @@ struct GladiusPluginArgs {
         const std::string &home,
         const gladius::core::Args &args,
         MRN::Stream *protoStream,
-        MRN::Network *mrnetNet
+        MRN::Network *mrnetNet,
+        int uid = -1
     ) : myHome(home)
       , appArgs(args)
       , protoStream(protoStream)
-      , network(mrnetNet) { ; }
+      , network(mrnetNet)
+      , uid(uid) { ; }
     /**
      *
      */
@@ -126,24 +158,29 @@ struct GladiusPluginInfo {
     const char *pluginName;
     // Plugin version string.
     const char *pluginVersion;
-    // Plugin activation.
+    // Plugin activation: returns a new plugin instance.
     std::function<GladiusPlugin *(void)> pluginConstruct;
+    // Plugin deactivation: frees what pluginConstruct returned.
+    std::function<void(GladiusPlugin *)> pluginDestroy;
     //
     GladiusPluginInfo(void)
         : pluginABI(0)
         , pluginName(nullptr)
         , pluginVersion(nullptr)
-        , pluginConstruct(nullptr) { ; }
+        , pluginConstruct(nullptr)
+        , pluginDestroy(nullptr) { ; }
     //
     GladiusPluginInfo(
         int pabi,
         const char *pname,
         const char *pver,
-        const std::function<GladiusPlugin *(void)> &pconst
+        const std::function<GladiusPlugin *(void)> &pconst,
+        const std::function<void(GladiusPlugin *)> &pdest
     )   : pluginABI(pabi)
         , pluginName(pname)
         , pluginVersion(pver)
-        , pluginConstruct(pconst) { ; }
+        , pluginConstruct(pconst)
+        , pluginDestroy(pdest) { ; }
 };
 
 } // end gpi namespace
@@ -85,8 +85,9 @@ init(
     if (GLADIUS_SUCCESS != p.tool.create(p.cwRank, toolBeVerbose)) {
         return ERROR;
     }
-    // This is a blocking call. Won't return until connection is complete.
-    if (GLADIUS_SUCCESS != p.tool.connect()) {
+    // Returns right away: the tool connects in the background while we go
+    // on with our business.
+    if (GLADIUS_SUCCESS != p.tool.connectAsync()) {
         return ERROR;
     }
     //
@@ -109,8 +110,12 @@ sayHi(const Proc &p)
  *
  */
 int
-fini(const Proc &p)
+fini(Proc &p)
 {
+    // Let the tool finish with us before our runtime goes away.
+    if (GLADIUS_SUCCESS != p.tool.wait()) {
+        return ERROR;
+    }
     if (p.initialized) {
         int mpiRC = MPI_Finalize();
         if (MPI_SUCCESS != mpiRC) return ERROR;
@@ -17,6 +17,8 @@
 #include "core/core.h"
 #include "core/utils.h"
 #include "core/colors.h"
+#include "tool-common/tx-pipeline.h"
+#include "tool-be/event-loop.h"
 
 #include <iostream>
 #include <cstdlib>
@@ -120,36 +122,46 @@ HelloBE::mEnterMainLoop(void)
     // TODO
     //toolcommon::beReady(mGladiusPluginArgs.protoStream);
     //
-    MRN::PacketPtr packet;
-    const bool recvShouldBlock = true;
     // Convenience pointer to network.
     auto *network = mGladiusPluginArgs.network;
-    MRN::Stream *protoStream = nullptr;
-    int status = 0;
-    int action = 0;
+    toolbe::EventLoop loop;
     // Do Until the FE Says So...
-    do {
-        // What action is next FE?
-        status = network->recv(&action, packet, &protoStream, recvShouldBlock);
-        if (1 != status) GLADIUS_THROW_CALL_FAILED("Network::Recv");
+    const auto onPacket = [&loop](
+        int action,
+        const MRN::PacketPtr &packet,
+        MRN::Stream *protoStream
+    ) {
         switch (action) {
-            case hello::SayHello:
+            case hello::Requests:
             {
-                const char *hello = "hello";
-                status = protoStream->send(action, "%s", hello); 
-                if (-1 == status) {
-                    GLADIUS_THROW_CALL_FAILED("Stream::Send");
-                }
-                status = protoStream->flush();
-                if (-1 == status) {
-                    GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+                const int status = toolcommon::TxPipelineBE::serve(
+                    protoStream,
+                    action,
+                    packet,
+                    [](int op,
+                       toolcommon::TxMessage &,
+                       toolcommon::TxMessageWriter &reply) {
+                        if (hello::SayHello != op) return GLADIUS_ERR;
+                        reply.putStr("hello");
+                        return GLADIUS_SUCCESS;
+                    }
+                );
+                if (GLADIUS_SUCCESS != status) {
+                    GLADIUS_THROW_CALL_FAILED("TxPipelineBE::serve");
                 }
                 break;
             }
             case hello::Shutdown: {
+                loop.stop();
                 break;
             }
         }
-    } while (action != hello::Shutdown);
+    };
+    if (GLADIUS_SUCCESS != loop.setNetwork(network, onPacket)) {
+        GLADIUS_THROW_CALL_FAILED("EventLoop::setNetwork");
+    }
+    if (GLADIUS_SUCCESS != loop.run()) {
+        GLADIUS_THROW_CALL_FAILED("EventLoop::run");
+    }
     VCOMP_COUT("Done with Main Loop." << std::endl);
 }
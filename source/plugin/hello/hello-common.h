@@ -24,6 +24,9 @@ namespace hello {
 enum HelloProtoTags {
     // Notice where we start here. ALL plugins MUST start with this tag value.
     SayHello = gladius::toolcommon::FirstPluginTag,
-    Shutdown
+    Shutdown,
+    // Batches of requests (see TxPipelineFE).
+    Requests
 };
+GLADIUS_CHECK_PLUGIN_TAG(SayHello);
 } // end hello namesapce.
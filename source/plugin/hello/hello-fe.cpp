@@ -17,6 +17,8 @@
 #include "core/core.h"
 #include "core/utils.h"
 #include "core/colors.h"
+#include "mrnet/sync-stream.h"
+#include "tool-common/tx-pipeline.h"
 
 #include <iostream>
 
@@ -57,6 +59,8 @@ class HelloFE : public GladiusPlugin {
     //
     void
     mWaitForBEs(void);
+    //
+    mrnetfe::SyncStream mSyncStream;
     // TODO rename
     MRN::Stream *mStream = nullptr;
 
@@ -102,12 +106,14 @@ HelloFE::mLoadFilters(void)
         GLADIUS_THROW_CALL_FAILED("load_FilterFunc: " + filterSOName);
     }
     //
-    mStream = network->new_Stream(
-                  mGladiusPluginArgs.network->get_BroadcastCommunicator(),
-                  MRN::SFILTER_WAITFORALL,
-                  filterID
-              );
-    if (!mStream) {
+    const int rc = mSyncStream.create(
+                       network,
+                       network->get_BroadcastCommunicator(),
+                       filterID,
+                       mrnetfe::StreamSync::waitForAll()
+                   );
+    mStream = mSyncStream.stream();
+    if (GLADIUS_SUCCESS != rc) {
         GLADIUS_THROW_CALL_FAILED("new_Stream");
     }
     //
@@ -162,25 +168,31 @@ HelloFE::mEnterMainLoop(void)
     int status = 0;
     try {
         std::cout << "(" + CNAME + ") say hello, back-ends!" << std::endl;
-        status = mStream->send(hello::SayHello, "");
-        if (-1 == status) {
-            GLADIUS_THROW_CALL_FAILED("Stream::Send");
+        toolcommon::TxPipelineFE pipeline;
+        status = pipeline.create(mStream, hello::Requests);
+        if (GLADIUS_SUCCESS != status) {
+            GLADIUS_THROW_CALL_FAILED("TxPipelineFE::create");
         }
-        status = mStream->flush();
-        if (-1 == status) {
-            GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+        // Don't wait on back-ends that we have lost.
+        pipeline.setLostFn(mGladiusPluginArgs.lostBackEnds);
+        // Every request queued before drain goes out in one batch.
+        auto hellos = pipeline.submit(hello::SayHello);
+        status = pipeline.drain();
+        if (GLADIUS_SUCCESS != status) {
+            GLADIUS_THROW_CALL_FAILED("TxPipelineFE::drain");
         }
-        //
-        int tag;
-        MRN::PacketPtr packet;
-        status = mStream->recv(&tag, packet);
-        if (-1 == status) {
-            GLADIUS_THROW_CALL_FAILED("Stream::Recv");
+        auto replies = hellos.get();
+        if (replies.partial) {
+            COMP_COUT << "Heard from " << replies.nBackEnds << " back-end(s). "
+                      << "The rest were lost." << std::endl;
+        }
+        for (auto &reply : replies.replies) {
+            const char *out = nullptr;
+            if (!reply.message.getStr(out)) {
+                GLADIUS_THROW("Received malformed hello.");
+            }
+            std::cout << out << std::endl;
         }
-        char *out = nullptr;
-        status = packet->unpack("%s", &out);
-        std::cout << out << std::endl;
-        free(out);
         //
         std::cout << "(" + CNAME + ") say goodbye, back-ends!" << std::endl;
         status = mStream->send(hello::Shutdown, "");
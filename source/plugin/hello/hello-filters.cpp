@@ -21,7 +21,7 @@ extern "C" {
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
-const char *HelloStringsFilter_format_string = "%s";
+const char *HelloStringsFilter_format_string = "%auc";
 
 /**
  *
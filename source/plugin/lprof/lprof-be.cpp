@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The live Legion profiling (lprof) plugin back-end. Forwards the events that
+ * our target records through the tool API (e.g. with legion::ProfRecorder) to
+ * the front-end in batches, at the period that the front-end asked for. Also
+ * arms and resumes the breakpoints that the front-end asks for (see
+ * Tool::breakpoint).
+ */
+
+#include "plugin/lprof/lprof-common.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "tool-be/app-breakpoints.h"
+#include "tool-be/app-event-queue.h"
+#include "tool-be/event-loop.h"
+#include "tool-common/tx-message.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "lprofbe";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+} // end namespace
+
+/**
+ *
+ */
+class LProfBE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    // This session's loop.
+    std::unique_ptr<toolbe::EventLoop> mLoop;
+    // Where we forward events, once started.
+    MRN::Stream *mStream = nullptr;
+    //
+    void
+    mEnterMainLoop(void);
+    //
+    void
+    mStart(
+        const MRN::PacketPtr &packet,
+        MRN::Stream *stream
+    );
+    //
+    void
+    mShutdown(MRN::Stream *stream);
+    //
+    void
+    mBreak(
+        const MRN::PacketPtr &packet,
+        bool arm
+    );
+    //
+    void
+    mContinue(void);
+    //
+    void
+    mReportStopped(void);
+
+public:
+    //
+    LProfBE(void) { ; }
+    //
+    ~LProfBE(void) { ; }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(LProfBE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+LProfBE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_BE_VERBOSE_NAME);
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        // Nothing carries over from an earlier session.
+        mLoop.reset(new toolbe::EventLoop());
+        mStream = nullptr;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        if (!mGladiusPluginArgs.appEvents) {
+            GLADIUS_THROW("No Application Event Queue.");
+        }
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Starts forwarding our target's events at the period that the front-end asked
+ * for.
+ */
+void
+LProfBE::mStart(
+    const MRN::PacketPtr &packet,
+    MRN::Stream *stream
+) {
+    toolcommon::TxMessage msg;
+    uint32_t periodInMS = 0;
+    if (GLADIUS_SUCCESS != msg.unpack(packet) ||
+        !msg.get(periodInMS) || 0 == periodInMS) {
+        GLADIUS_THROW("Received Malformed Start Request.");
+    }
+    if (mStream) return;
+    VCOMP_COUT("Forwarding every " << periodInMS << " ms." << std::endl);
+    //
+    mStream = stream;
+    (void)mGladiusPluginArgs.appEvents->forwardEvery(
+        *mLoop,
+        mStream,
+        lprof::Events,
+        mGladiusPluginArgs.uid,
+        periodInMS
+    );
+}
+
+/**
+ * Sends what is left before we go, and then tells the front-end that we are
+ * done.
+ */
+void
+LProfBE::mShutdown(MRN::Stream *stream)
+{
+    if (mStream) {
+        const int rc = mGladiusPluginArgs.appEvents->forward(
+                           mStream,
+                           lprof::Events,
+                           mGladiusPluginArgs.uid
+                       );
+        if (GLADIUS_SUCCESS != rc) {
+            GLADIUS_CERR << "Application event forwarding failed."
+                         << std::endl;
+        }
+    }
+    toolcommon::TxMessageWriter done;
+    if (GLADIUS_SUCCESS != done.pluginSend(stream, lprof::Shutdown) ||
+        -1 == stream->flush()) {
+        GLADIUS_CERR << "Shutdown reply failed." << std::endl;
+    }
+    mLoop->stop();
+}
+
+/**
+ * Arms (or disarms) a breakpoint on the event named in packet.
+ */
+void
+LProfBE::mBreak(
+    const MRN::PacketPtr &packet,
+    bool arm
+) {
+    toolcommon::TxMessage msg;
+    std::string name;
+    if (GLADIUS_SUCCESS != msg.unpack(packet) || !msg.getStr(name) ||
+        name.empty()) {
+        GLADIUS_THROW("Received Malformed Breakpoint Request.");
+    }
+    auto *breakpoints = mGladiusPluginArgs.appBreakpoints;
+    if (!breakpoints) {
+        GLADIUS_CERR << "No Application Breakpoints." << std::endl;
+        return;
+    }
+    // Names our target hasn't used yet get the ID that it will get later.
+    uint32_t id = 0;
+    if (GLADIUS_SUCCESS != mGladiusPluginArgs.appEvents->nameID(name, id)) {
+        GLADIUS_CERR << "No ID for Event: " << name << std::endl;
+        return;
+    }
+    VCOMP_COUT((arm ? "Arming" : "Disarming") << " breakpoint on " << name
+               << " (" << id << ")." << std::endl);
+    if (arm) breakpoints->arm(id);
+    else breakpoints->disarm(id);
+}
+
+/**
+ *
+ */
+void
+LProfBE::mContinue(void)
+{
+    auto *breakpoints = mGladiusPluginArgs.appBreakpoints;
+    if (breakpoints) breakpoints->resume();
+}
+
+/**
+ * Tells the front-end how many of our target's threads are stopped.
+ */
+void
+LProfBE::mReportStopped(void)
+{
+    if (!mStream) return;
+    const uint32_t nStopped = uint32_t(
+                                  mGladiusPluginArgs.appBreakpoints
+                                      ->stoppedAt().size()
+                              );
+    if (0 == nStopped) return;
+    toolcommon::TxMessageWriter msg;
+    msg.put(int32_t(mGladiusPluginArgs.uid));
+    msg.put(nStopped);
+    if (GLADIUS_SUCCESS != msg.pluginSend(mStream, lprof::Stopped) ||
+        -1 == mStream->flush()) {
+        GLADIUS_CERR << "Stop report failed." << std::endl;
+    }
+}
+
+/**
+ *
+ */
+void
+LProfBE::mEnterMainLoop(void)
+{
+    VCOMP_COUT("Entering Main Loop." << std::endl);
+    // Do Until the FE Says So...
+    const auto onPacket = [this](
+        int action,
+        const MRN::PacketPtr &packet,
+        MRN::Stream *stream
+    ) {
+        switch (action) {
+            case lprof::Start:
+                mStart(packet, stream);
+                break;
+            case lprof::Shutdown:
+                mShutdown(stream);
+                break;
+            case lprof::Break:
+                mBreak(packet, true);
+                break;
+            case lprof::Unbreak:
+                mBreak(packet, false);
+                break;
+            case lprof::Continue:
+                mContinue();
+                break;
+            default:
+                GLADIUS_CERR << "Ignoring Unknown Request: "
+                             << action << std::endl;
+                break;
+        }
+    };
+    if (GLADIUS_SUCCESS != mLoop->setNetwork(
+                               mGladiusPluginArgs.network, onPacket
+                           )) {
+        GLADIUS_THROW_CALL_FAILED("EventLoop::setNetwork");
+    }
+    // Our target's threads stopping at breakpoints.
+    auto *breakpoints = mGladiusPluginArgs.appBreakpoints;
+    if (breakpoints && -1 != breakpoints->notifyFD()) {
+        const int fd = breakpoints->notifyFD();
+        (void)mLoop->addFD(fd, POLLIN, [this, fd](short) {
+            uint64_t n = 0;
+            (void)!read(fd, &n, sizeof(n));
+            mReportStopped();
+        });
+    }
+    const int rc = mLoop->run();
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW_CALL_FAILED_RC("EventLoop::run", rc);
+    }
+    VCOMP_COUT("Done with Main Loop." << std::endl);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Common stuff (FE/BE) for the live Legion profiling (lprof) plugin.
+ */
+
+#pragma once
+
+#include "plugin/core/gladius-plugin.h"
+
+// The plugin's name.
+#define PLUGIN_NAME "lprof"
+// The plugin's version string.
+#define PLUGIN_VERSION "0.0.1"
+
+namespace lprof {
+//
+enum LProfProtoTags {
+    // Notice where we start here. ALL plugins MUST start with this tag value.
+    // Starts forwarding application events. Carries the forwarding period
+    // (uint32_t milliseconds).
+    Start = gladius::toolcommon::FirstPluginTag,
+    // Carries an AppEventBatch (BEs to FE).
+    Events,
+    // Stops forwarding (FE to BEs). Each BE answers with it once it has sent
+    // what was left.
+    Shutdown,
+    // Arms a breakpoint on an application event. Carries the event's name.
+    Break,
+    // Disarms a breakpoint. Carries the event's name.
+    Unbreak,
+    // Lets stopped application threads go.
+    Continue,
+    // Application threads stopped at a breakpoint (BEs to FE). Carries the
+    // BE's UID (int32_t) and the number of stopped threads (uint32_t).
+    Stopped
+};
+GLADIUS_CHECK_PLUGIN_TAG(Start);
+} // end lprof namespace
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The live Legion profiling (lprof) plugin front-end. Gathers the Legion
+ * profiling records (see tool-api/gladius-legion-prof.h) that the back-ends
+ * forward, and serves them over TCP as Legion prof log lines, so that the
+ * timeline viewer (timeline --live=HOST:PORT) can draw a running job. A viewer
+ * can connect at any time: it first gets every processor and task kind seen so
+ * far, and then task executions as they arrive. The user can also stop the
+ * job's threads at application events (see Tool::breakpoint) and resume them.
+ */
+
+#include "plugin/lprof/lprof-common.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "tool-common/app-event.h"
+#include "plugin/lprof/lprof-log-writer.h"
+#include "tool-common/tx-message.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "lprof";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+// Default port that viewers connect to.
+const int defaultPort = 41414;
+// How often the back-ends forward what they have, in milliseconds.
+const uint32_t forwardPeriodInMS = 250;
+// How much a viewer may fall behind (in bytes) before it is dropped.
+const size_t maxViewerBacklog = 16 * 1024 * 1024;
+// How long we wait for the back-ends' last batches, in milliseconds.
+const int shutdownTimeoutInMS = 10 * 1000;
+} // end namespace
+
+/**
+ *
+ */
+class LProfFE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    //
+    int mPort = defaultPort;
+    // Carries requests down and event batches up, unfiltered, as they come.
+    MRN::Stream *mStream = nullptr;
+    //
+    int mListenFD = -1;
+    // The connected viewer, if any.
+    int mViewerFD = -1;
+    // Lines that the viewer hasn't taken yet.
+    std::string mViewerBacklog;
+    // The number of back-ends done sending (see lprof::Shutdown).
+    size_t mNBEsDone = 0;
+    //
+    lprof::LogWriter mLogWriter;
+    // Events that each back-end (by UID) has lost so far.
+    std::map<int32_t, uint64_t> mNDropped;
+    //
+    uint64_t mNDroppedReported = 0;
+    //
+    void
+    mCreateStream(void);
+    //
+    void
+    mListen(void);
+    //
+    void
+    mAcceptViewer(void);
+    //
+    void
+    mCloseViewer(void);
+    //
+    void
+    mSendToViewer(const std::string &lines);
+    //
+    void
+    mFlushToViewer(void);
+    //
+    void
+    mSend(
+        int tag,
+        const toolcommon::TxMessageWriter &msg
+    );
+    //
+    void
+    mRecvEvents(void);
+    //
+    bool
+    mUserCommand(void);
+    //
+    void
+    mShutdown(void);
+    //
+    void
+    mEnterMainLoop(void);
+    //
+    void
+    mEndSession(void);
+
+public:
+    //
+    LProfFE(void) { ; }
+    //
+    ~LProfFE(void) {
+        mEndSession();
+    }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(LProfFE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+LProfFE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_FE_VERBOSE_NAME);
+    COMP_COUT << "::" << std::endl;
+    COMP_COUT << ":: " PLUGIN_NAME " " PLUGIN_VERSION << std::endl;
+    COMP_COUT << "::" << std::endl;
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        const auto portEnv = GLADIUS_ENV_LPROF_PORT_NAME;
+        if (core::utils::envVarSet(portEnv) &&
+            (GLADIUS_SUCCESS != core::utils::getEnvAs(portEnv, mPort) ||
+             mPort <= 0 || mPort > 65535)) {
+            GLADIUS_THROW(
+                "Invalid " + std::string(portEnv) + ": "
+                + core::utils::getEnv(portEnv)
+            );
+        }
+        mCreateStream();
+        mListen();
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        mEndSession();
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    mEndSession();
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Batches are already per back-end and we want them as soon as they arrive,
+ * so nothing filters or waits on the way up.
+ */
+void
+LProfFE::mCreateStream(void)
+{
+    auto *network = mGladiusPluginArgs.network;
+    mStream = network->new_Stream(
+                  network->get_BroadcastCommunicator(),
+                  MRN::TFILTER_NULL,
+                  MRN::SFILTER_DONTWAIT
+              );
+    if (!mStream) {
+        GLADIUS_THROW_CALL_FAILED("new_Stream");
+    }
+}
+
+/**
+ * Lets go of the port and the viewer, and forgets what this session saw, so
+ * that the next session starts from scratch.
+ */
+void
+LProfFE::mEndSession(void)
+{
+    mCloseViewer();
+    if (-1 != mListenFD) {
+        (void)close(mListenFD);
+        mListenFD = -1;
+    }
+    mStream = nullptr;
+    mLogWriter = lprof::LogWriter();
+    mNDropped.clear();
+    mNDroppedReported = 0;
+    mNBEsDone = 0;
+}
+
+/**
+ * Opens the port that viewers connect to.
+ */
+void
+LProfFE::mListen(void)
+{
+    mListenFD = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (-1 == mListenFD) {
+        GLADIUS_THROW_CALL_FAILED(
+            "socket: " + core::utils::getStrError(errno)
+        );
+    }
+    const int one = 1;
+    (void)setsockopt(mListenFD, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(uint16_t(mPort));
+    if (-1 == bind(mListenFD, (struct sockaddr *)&addr, sizeof(addr)) ||
+        -1 == listen(mListenFD, 1)) {
+        const int err = errno;
+        GLADIUS_THROW_CALL_FAILED(
+            "bind/listen (port " + std::to_string(mPort) + "): "
+            + core::utils::getStrError(err)
+        );
+    }
+    COMP_COUT << "Serving Legion profiling records on port " << mPort
+              << ". View them with: timeline --live="
+              << core::utils::getHostname() << ":" << mPort << std::endl;
+}
+
+/**
+ * Takes a new viewer (replacing the old one, if any), and catches it up.
+ */
+void
+LProfFE::mAcceptViewer(void)
+{
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    const int fd = accept4(
+                       mListenFD, (struct sockaddr *)&addr, &addrLen,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC
+                   );
+    if (-1 == fd) return;
+    //
+    mCloseViewer();
+    mViewerFD = fd;
+    char host[INET_ADDRSTRLEN] = {'\0'};
+    (void)inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+    COMP_COUT << "Viewer connected from " << host << "." << std::endl;
+    // Task executions only make sense after their processors.
+    mSendToViewer(mLogWriter.descs());
+}
+
+/**
+ *
+ */
+void
+LProfFE::mCloseViewer(void)
+{
+    if (-1 == mViewerFD) return;
+    (void)close(mViewerFD);
+    mViewerFD = -1;
+    mViewerBacklog.clear();
+}
+
+/**
+ * Sends lines to the viewer, without blocking. What it can't take yet waits
+ * (see mFlushToViewer).
+ */
+void
+LProfFE::mSendToViewer(const std::string &lines)
+{
+    if (-1 == mViewerFD) return;
+    mViewerBacklog += lines;
+    mFlushToViewer();
+}
+
+/**
+ * Sends as much of the backlog as the viewer takes. A viewer that falls too
+ * far behind is dropped.
+ */
+void
+LProfFE::mFlushToViewer(void)
+{
+    size_t sent = 0;
+    while (-1 != mViewerFD && sent < mViewerBacklog.size()) {
+        const ssize_t n = send(
+                              mViewerFD, mViewerBacklog.data() + sent,
+                              mViewerBacklog.size() - sent,
+                              MSG_NOSIGNAL | MSG_DONTWAIT
+                          );
+        if (-1 == n) {
+            if (EINTR == errno) continue;
+            if (EAGAIN == errno || EWOULDBLOCK == errno) break;
+            COMP_COUT << "Viewer disconnected." << std::endl;
+            mCloseViewer();
+            return;
+        }
+        sent += size_t(n);
+    }
+    if (-1 == mViewerFD) return;
+    mViewerBacklog.erase(0, sent);
+    if (mViewerBacklog.size() > maxViewerBacklog) {
+        GLADIUS_CERR_WARN << "Viewer can't keep up. Dropping it."
+                          << std::endl;
+        mCloseViewer();
+    }
+}
+
+/**
+ * Sends a request to all back-ends.
+ */
+void
+LProfFE::mSend(
+    int tag,
+    const toolcommon::TxMessageWriter &msg
+) {
+    if (GLADIUS_SUCCESS != msg.pluginSend(mStream, tag)) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Send");
+    }
+    if (-1 == mStream->flush()) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+    }
+}
+
+/**
+ * Takes every batch that is waiting, without blocking, and passes its
+ * records on to the viewer. Also counts back-ends that are done sending.
+ */
+void
+LProfFE::mRecvEvents(void)
+{
+    static const bool recvShouldBlock = false;
+    int tag = 0;
+    MRN::PacketPtr packet;
+    std::string lines;
+    int status = 0;
+    while (1 == (status = mStream->recv(&tag, packet, recvShouldBlock))) {
+        if (lprof::Shutdown == tag) {
+            ++mNBEsDone;
+            continue;
+        }
+        if (lprof::Stopped == tag) {
+            toolcommon::TxMessage msg;
+            int32_t uid = 0;
+            uint32_t nStopped = 0;
+            if (GLADIUS_SUCCESS != msg.unpack(packet) || !msg.get(uid) ||
+                !msg.get(nStopped)) {
+                GLADIUS_THROW("Received Malformed Stop Report.");
+            }
+            COMP_COUT << nStopped << " thread(s) stopped on back-end " << uid
+                      << ". c<Enter> to continue." << std::endl;
+            continue;
+        }
+        if (lprof::Events != tag) {
+            GLADIUS_CERR << "Ignoring Unexpected Tag: " << tag << std::endl;
+            continue;
+        }
+        toolcommon::TxMessage msg;
+        toolcommon::AppEventBatch batch;
+        if (GLADIUS_SUCCESS != msg.unpack(packet) ||
+            GLADIUS_SUCCESS != batch.unpack(msg)) {
+            GLADIUS_THROW("Received Malformed Event Batch.");
+        }
+        mNDropped[batch.uid] = batch.nDropped;
+        (void)mLogWriter.add(batch, lines);
+    }
+    if (-1 == status) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Recv");
+    }
+    // Without a viewer, descriptions are kept for later, and the rest goes.
+    if (!lines.empty()) mSendToViewer(lines);
+    //
+    uint64_t nDropped = 0;
+    for (const auto &d : mNDropped) nDropped += d.second;
+    if (nDropped > mNDroppedReported) {
+        GLADIUS_CERR_WARN << nDropped << " record(s) dropped so far by full "
+                             "application event queues." << std::endl;
+        mNDroppedReported = nDropped;
+    }
+}
+
+/**
+ * Acts on a line from the user. Returns whether or not the user asked to quit.
+ * Only call when stdin is readable.
+ */
+bool
+LProfFE::mUserCommand(void)
+{
+    std::string line;
+    if (!std::getline(std::cin, line)) return true;
+    if (line.empty()) return false;
+    // Everything after "X " is the event's name.
+    const std::string name = line.size() > 2 ? line.substr(2) : "";
+    switch (line[0]) {
+        case 'q':
+            return true;
+        case 'b':
+        case 'd':
+            if (name.empty()) break;
+            mSend(
+                'b' == line[0] ? lprof::Break : lprof::Unbreak,
+                toolcommon::TxMessageWriter().putStr(name)
+            );
+            return false;
+        case 'c':
+            mSend(lprof::Continue, toolcommon::TxMessageWriter());
+            return false;
+        default:
+            break;
+    }
+    COMP_COUT << "Commands: q (quit), b EVENT (stop threads at EVENT), "
+                 "d EVENT (don't), c (continue)." << std::endl;
+    return false;
+}
+
+/**
+ * Tells the back-ends to stop, and takes their last batches. Each back-end
+ * answers with lprof::Shutdown once it has sent everything.
+ */
+void
+LProfFE::mShutdown(void)
+{
+    mSend(lprof::Shutdown, toolcommon::TxMessageWriter());
+    //
+    const size_t nBEs = mStream->get_EndPoints().size();
+    const int dataFD = mStream->get_DataNotificationFd();
+    int waitedInMS = 0;
+    while (mNBEsDone < nBEs && waitedInMS < shutdownTimeoutInMS) {
+        if (-1 != dataFD) {
+            struct pollfd pfd = {dataFD, POLLIN, 0};
+            (void)poll(&pfd, 1, int(forwardPeriodInMS));
+            mStream->clear_DataNotificationFd();
+        }
+        else (void)usleep(forwardPeriodInMS * 1000);
+        waitedInMS += int(forwardPeriodInMS);
+        mRecvEvents();
+    }
+    if (mNBEsDone < nBEs) {
+        GLADIUS_CERR_WARN << (nBEs - mNBEsDone) << " back-end(s) didn't "
+                             "finish sending in time." << std::endl;
+    }
+    // Whatever the viewer can still take.
+    mFlushToViewer();
+}
+
+/**
+ * The front-end loop: waits for batches, viewers, and the user.
+ */
+void
+LProfFE::mEnterMainLoop(void)
+{
+    toolcommon::TxMessageWriter start;
+    start.put(forwardPeriodInMS);
+    mSend(lprof::Start, start);
+    COMP_COUT << "q<Enter> to quit, b EVENT<Enter> to stop at EVENT."
+              << std::endl;
+    //
+    const int dataFD = mStream->get_DataNotificationFd();
+    bool quit = false;
+    while (!quit) {
+        std::vector<struct pollfd> pfds = {
+            {STDIN_FILENO, POLLIN, 0},
+            {mListenFD, POLLIN, 0}
+        };
+        // Viewers don't talk, so readable means gone.
+        if (-1 != mViewerFD) {
+            const short events = mViewerBacklog.empty() ? POLLIN
+                                                        : POLLIN | POLLOUT;
+            pfds.push_back({mViewerFD, events, 0});
+        }
+        if (-1 != dataFD) pfds.push_back({dataFD, POLLIN, 0});
+        //
+        const int rc = poll(pfds.data(), pfds.size(), int(forwardPeriodInMS));
+        if (-1 == rc && EINTR != errno) {
+            GLADIUS_THROW_CALL_FAILED(
+                "poll: " + core::utils::getStrError(errno)
+            );
+        }
+        if (-1 != dataFD) mStream->clear_DataNotificationFd();
+        // Cheap when nothing is waiting, and covers a missing dataFD.
+        mRecvEvents();
+        if (rc <= 0) continue;
+        //
+        for (const auto &pfd : pfds) {
+            if (!pfd.revents) continue;
+            if (STDIN_FILENO == pfd.fd) quit = mUserCommand();
+            else if (mListenFD == pfd.fd) mAcceptViewer();
+            else if (mViewerFD == pfd.fd) {
+                if (pfd.revents & POLLOUT) mFlushToViewer();
+                if (-1 == mViewerFD || !(pfd.revents & ~POLLOUT)) continue;
+                char junk[256];
+                const ssize_t n = recv(
+                                      mViewerFD, junk, sizeof(junk),
+                                      MSG_DONTWAIT
+                                  );
+                if (0 == n || (-1 == n && EAGAIN != errno &&
+                               EWOULDBLOCK != errno)) {
+                    COMP_COUT << "Viewer disconnected." << std::endl;
+                    mCloseViewer();
+                }
+            }
+        }
+    }
+    //
+    mShutdown();
+    COMP_COUT << mLogWriter.nTaskInfos() << " task execution(s) seen."
+              << std::endl;
+    //
+    VCOMP_COUT("Done with Main Loop." << std::endl);
+}
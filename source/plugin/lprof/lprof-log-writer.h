@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Translates the Legion profiling records that back-ends forward back into
+ * Legion prof log lines. Lines use the log's format, so anything that reads
+ * Legion prof logs (e.g. the timeline viewer) can read them live.
+ */
+
+#pragma once
+
+#include "tool-common/app-event.h"
+#include "tool-common/legion-prof-records.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace lprof {
+
+/**
+ * Turns the Legion profiling records in AppEventBatches into Legion prof log
+ * lines. Other events are ignored. Event IDs are per back-end, so names are
+ * tracked per UID.
+ */
+class LogWriter {
+    //
+    typedef gladius::toolcommon::AppEvent AppEvent;
+    //
+    typedef gladius::toolcommon::AppEventBatch AppEventBatch;
+    //
+    enum RecordKind {
+        Other = 0,
+        ProcDesc,
+        TaskKind,
+        TaskInfo
+    };
+    //
+    struct Record {
+        RecordKind kind = Other;
+        // TaskKind only.
+        std::string taskName;
+    };
+    // What each UID's event IDs stand for.
+    std::map<int32_t, std::unordered_map<uint32_t, Record>> mRecords;
+    // Processors and task kinds already described.
+    std::set<uint64_t> mProcs;
+    //
+    std::set<uint32_t> mTaskKinds;
+    // Every description line so far, for readers that show up late.
+    std::string mDescs;
+    //
+    uint64_t mNTaskInfos = 0;
+
+    /**
+     *
+     */
+    static Record
+    mRecord(const std::string &name) {
+        using namespace gladius::toolcommon::legionprof;
+        static const std::string kindPrefix = TaskKindPrefix;
+        Record r;
+        if (ProcDescName == name) r.kind = ProcDesc;
+        else if (TaskInfoName == name) r.kind = TaskInfo;
+        else if (0 == name.compare(0, kindPrefix.size(), kindPrefix)) {
+            r.kind = TaskKind;
+            r.taskName = name.substr(kindPrefix.size());
+        }
+        return r;
+    }
+
+public:
+    /**
+     * Appends the log lines for batch's records to out. Returns the number of
+     * task executions that it appended.
+     */
+    size_t
+    add(
+        const AppEventBatch &batch,
+        std::string &out
+    ) {
+        auto &records = mRecords[batch.uid];
+        for (const auto &n : batch.names) {
+            records[n.first] = mRecord(n.second);
+        }
+        //
+        size_t nTaskInfos = 0;
+        char line[256];
+        for (const auto &e : batch.events) {
+            if (AppEvent::Mark != e.kind) continue;
+            const auto it = records.find(e.id);
+            if (records.end() == it) continue;
+            const Record &r = it->second;
+            // For printf.
+            unsigned long long a[AppEvent::NArgs];
+            for (int i = 0; i < AppEvent::NArgs; ++i) a[i] = e.args[i];
+            int len = 0;
+            switch (r.kind) {
+                case ProcDesc:
+                    if (e.nArgs < 2 || !mProcs.insert(a[0]).second) continue;
+                    len = snprintf(
+                              line, sizeof(line), "Prof Proc Desc %llu %u\n",
+                              a[0], unsigned(a[1])
+                          );
+                    break;
+                case TaskKind:
+                    if (e.nArgs < 1 ||
+                        !mTaskKinds.insert(uint32_t(a[0])).second) continue;
+                    len = snprintf(
+                              line, sizeof(line), "Prof Task Kind %u %s\n",
+                              unsigned(a[0]), r.taskName.c_str()
+                          );
+                    break;
+                case TaskInfo:
+                    if (e.nArgs < 4) continue;
+                    // Only executions are recorded, so a task is created and
+                    // ready when it starts.
+                    len = snprintf(
+                              line, sizeof(line),
+                              "Prof Task Info %u %u %llu %llu %llu %llu %llu\n",
+                              unsigned(a[0] >> 32),
+                              unsigned(a[0] & 0xffffffffULL),
+                              a[1], a[2], a[2], a[2], a[3]
+                          );
+                    ++nTaskInfos;
+                    break;
+                case Other:
+                default:
+                    continue;
+            }
+            if (len <= 0) continue;
+            // snprintf says how long the line would have been, so end a
+            // truncated line where it was cut.
+            if (len >= int(sizeof(line))) {
+                len = int(sizeof(line)) - 1;
+                line[len - 1] = '\n';
+            }
+            if (TaskInfo != r.kind) mDescs.append(line, len);
+            out.append(line, len);
+        }
+        mNTaskInfos += nTaskInfos;
+        return nTaskInfos;
+    }
+
+    /**
+     * Returns every processor and task kind description line so far.
+     */
+    const std::string &
+    descs(void) const {
+        return mDescs;
+    }
+
+    /**
+     * Returns the number of task executions seen so far.
+     */
+    uint64_t
+    nTaskInfos(void) const {
+        return mNTaskInfos;
+    }
+};
+
+} // end lprof namespace
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Implements the call-prefix tree that the stacks plugin builds on the
+ * back-ends, merges in the MRNet tree, and displays on the front-end.
+ */
+
+#include "plugin/stacks/stack-tree.h"
+
+#include "core/gladius-rc.h"
+
+using namespace stacks;
+
+////////////////////////////////////////////////////////////////////////////////
+// StackTree
+////////////////////////////////////////////////////////////////////////////////
+/**
+ *
+ */
+StackTree::StackTree(void)
+{
+    clear();
+}
+
+/**
+ *
+ */
+void
+StackTree::clear(void)
+{
+    mNodes.clear();
+    mNodes.push_back(Node());
+}
+
+/**
+ * Returns the index of parent's child named frame, creating it if needed.
+ */
+int
+StackTree::mChild(
+    int parent,
+    const std::string &frame
+) {
+    auto found = mNodes[parent].children.find(frame);
+    if (found != mNodes[parent].children.end()) return found->second;
+    // Careful: this may move the nodes, so index again after.
+    const int child = mNodes.size();
+    mNodes.push_back(Node());
+    mNodes[child].frame = frame;
+    mNodes[parent].children.insert(std::make_pair(frame, child));
+    return child;
+}
+
+/**
+ * Adds rank's stack. frames are ordered from the outermost frame (e.g. main)
+ * to the innermost.
+ */
+void
+StackTree::addStack(
+    RankSet::Rank rank,
+    const std::vector<std::string> &frames
+) {
+    int node = 0;
+    mNodes[node].ranks.insert(rank);
+    for (const auto &f : frames) {
+        node = mChild(node, f);
+        mNodes[node].ranks.insert(rank);
+    }
+}
+
+/**
+ *
+ */
+void
+StackTree::mMerge(
+    int node,
+    const StackTree &other,
+    int otherNode
+) {
+    mNodes[node].ranks.merge(other.mNodes[otherNode].ranks);
+    for (const auto &c : other.mNodes[otherNode].children) {
+        const int mine = mChild(node, c.first);
+        mMerge(mine, other, c.second);
+    }
+}
+
+/**
+ * Merges other into this tree. Shared call prefixes collapse into one path
+ * whose rank sets are the union of both.
+ */
+void
+StackTree::merge(const StackTree &other)
+{
+    mMerge(0, other, 0);
+}
+
+/**
+ *
+ */
+void
+StackTree::mFlatten(
+    int node,
+    int parent,
+    FlatStackTree &out
+) const {
+    const int me = out.frames.size();
+    out.frames.push_back(mNodes[node].frame);
+    out.parents.push_back(parent);
+    out.rankOffsets.push_back(out.rankWords.size());
+    mNodes[node].ranks.serialize(out.rankWords);
+    for (const auto &c : mNodes[node].children) {
+        mFlatten(c.second, me, out);
+    }
+}
+
+/**
+ * Flattens the tree into its wire form. See FlatStackTree.
+ */
+void
+StackTree::flatten(FlatStackTree &out) const
+{
+    out.frames.clear();
+    out.parents.clear();
+    out.rankOffsets.clear();
+    out.rankWords.clear();
+    mFlatten(0, -1, out);
+    out.rankOffsets.push_back(out.rankWords.size());
+}
+
+/**
+ * Rebuilds the tree from its wire form. Returns GLADIUS_ERR if the input is
+ * malformed, in which case the tree is left empty.
+ */
+int
+StackTree::unflatten(
+    char **frames,
+    int nFrames,
+    const int *parents,
+    int nParents,
+    const int *rankOffsets,
+    int nRankOffsets,
+    const uint64_t *rankWords,
+    int nRankWords
+) {
+    clear();
+    if (nFrames < 1 || nParents != nFrames || nRankOffsets != nFrames + 1
+        || -1 != parents[0] || 0 != rankOffsets[0]
+        || rankOffsets[nFrames] != nRankWords) {
+        return GLADIUS_ERR;
+    }
+    mNodes.resize(nFrames);
+    for (int n = 0; n < nFrames; ++n) {
+        Node &node = mNodes[n];
+        if (n > 0) {
+            const int p = parents[n];
+            if (p < 0 || p >= n) goto bad;
+            node.frame = frames[n] ? frames[n] : "";
+            if (!mNodes[p].children.insert(
+                    std::make_pair(node.frame, n)
+                ).second) goto bad;
+        }
+        if (rankOffsets[n + 1] < rankOffsets[n]) goto bad;
+        if (GLADIUS_SUCCESS != node.ranks.deserialize(
+                rankWords + rankOffsets[n],
+                rankOffsets[n + 1] - rankOffsets[n]
+            )) goto bad;
+    }
+    return GLADIUS_SUCCESS;
+bad:
+    clear();
+    return GLADIUS_ERR;
+}
+
+/**
+ *
+ */
+void
+StackTree::mStr(
+    int node,
+    const std::string &indent,
+    bool last,
+    std::string &out
+) const {
+    const Node &n = mNodes[node];
+    out += indent + (last ? "`-" : "|-") + n.frame + " "
+         + n.ranks.str() + " (" + std::to_string(n.ranks.size()) + ")\n";
+    const std::string childIndent = indent + (last ? "  " : "| ");
+    size_t i = 0;
+    for (const auto &c : n.children) {
+        const bool lastChild = (++i == n.children.size());
+        mStr(c.second, childIndent, lastChild, out);
+    }
+}
+
+/**
+ * Returns a printable rendering of the tree, one frame per line, each with
+ * the ranks that share its call prefix.
+ */
+std::string
+StackTree::str(void) const
+{
+    std::string out;
+    size_t i = 0;
+    for (const auto &c : mNodes[0].children) {
+        const bool last = (++i == mNodes[0].children.size());
+        mStr(c.second, "", last, out);
+    }
+    return out;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * A call-prefix tree of stack traces. Every node is a frame and carries the
+ * set of ranks whose stacks pass through it, so identical call paths (the
+ * equivalence classes we care about during hang diagnosis) collapse into one
+ * path regardless of how many ranks share them.
+ */
+
+#pragma once
+
+#include "tool-common/rank-set.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace stacks {
+
+// Rank sets come from tool-common.
+using gladius::toolcommon::RankSet;
+
+/**
+ * Flattened (wire) form of a StackTree. Nodes are in pre-order, so every
+ * node's parent comes before it. Node i's serialized rank set is
+ * rankWords[rankOffsets[i]] up to (but not including)
+ * rankWords[rankOffsets[i + 1]].
+ */
+struct FlatStackTree {
+    //
+    std::vector<std::string> frames;
+    //
+    std::vector<int> parents;
+    //
+    std::vector<int> rankOffsets;
+    //
+    std::vector<uint64_t> rankWords;
+};
+
+/**
+ *
+ */
+class StackTree {
+private:
+    //
+    struct Node {
+        // Frame name. Empty for the root.
+        std::string frame;
+        // Ranks whose stacks go through this frame.
+        RankSet ranks;
+        // Frame name to child node index.
+        std::map<std::string, int> children;
+    };
+    // Node 0 is the root.
+    std::vector<Node> mNodes;
+    //
+    int
+    mChild(
+        int parent,
+        const std::string &frame
+    );
+    //
+    void
+    mMerge(
+        int node,
+        const StackTree &other,
+        int otherNode
+    );
+    //
+    void
+    mFlatten(
+        int node,
+        int parent,
+        FlatStackTree &out
+    ) const;
+    //
+    void
+    mStr(
+        int node,
+        const std::string &indent,
+        bool last,
+        std::string &out
+    ) const;
+
+public:
+    //
+    StackTree(void);
+    //
+    void
+    clear(void);
+    //
+    void
+    addStack(
+        RankSet::Rank rank,
+        const std::vector<std::string> &frames
+    );
+    //
+    void
+    merge(const StackTree &other);
+    //
+    void
+    flatten(FlatStackTree &out) const;
+    //
+    int
+    unflatten(
+        char **frames,
+        int nFrames,
+        const int *parents,
+        int nParents,
+        const int *rankOffsets,
+        int nRankOffsets,
+        const uint64_t *rankWords,
+        int nRankWords
+    );
+    //
+    std::string
+    str(void) const;
+
+    /**
+     * Returns the number of frames in the tree (not counting the root).
+     */
+    size_t
+    nFrames(void) const {
+        return mNodes.size() - 1;
+    }
+
+    /**
+     * Returns the set of all ranks in the tree.
+     */
+    const RankSet &
+    ranks(void) const {
+        return mNodes[0].ranks;
+    }
+};
+
+} // end stacks namespace
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The stack trace (stacks) plugin back-end. Gathers its target's stack through
+ * the DMI (GDB/MI) and sends it up the tree as a single-path stack tree.
+ */
+
+#include "plugin/stacks/stacks-common.h"
+#include "plugin/stacks/stack-tree.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "pty/pty.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/prctl.h>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "stackbe";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+// How long we are willing to wait for GDB, in milliseconds.
+const int gdbTimeoutInMS = 30 * 1000;
+// Frame name used when a stack could not be collected.
+const std::string noStackFrame = "<stack unavailable>";
+} // end namespace
+
+/**
+ *
+ */
+class StacksBE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    //
+    void
+    mEnterMainLoop(void);
+    //
+    int
+    mGetStack(
+        std::vector<std::string> &frames
+    );
+    //
+    void
+    mSendStack(
+        MRN::Stream *stream
+    );
+
+public:
+    //
+    StacksBE(void) { ; }
+    //
+    ~StacksBE(void) { ; }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(StacksBE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+StacksBE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_BE_VERBOSE_NAME);
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Collects our target's (main thread) stack, outermost frame first.
+ *
+ * We live inside the target, so GDB attaching to it stops us, too. For that
+ * reason, attach, backtrace, and detach go to GDB in a single write: GDB runs
+ * all three back-to-back and we pick up the results once we are running again.
+ */
+int
+StacksBE::mGetStack(
+    std::vector<std::string> &frames
+) {
+    using namespace gladius::dmi;
+    //
+    frames.clear();
+    DMI dmi;
+    try {
+        dmi.init(mBeVerbose);
+    }
+    catch (const std::exception &e) {
+        GLADIUS_CERR << e.what() << std::endl;
+        return GLADIUS_ERR;
+    }
+    // Let our GDB attach to us when Yama's ptrace_scope is 1. Failure here is
+    // harmless when Yama isn't there.
+    (void)prctl(PR_SET_PTRACER, dmi.gdbPID(), 0, 0, 0);
+    //
+    const std::vector<std::string> cmds = {
+        "-target-attach " + std::to_string(getpid()),
+        "-stack-list-frames --thread 1",
+        "-target-detach"
+    };
+    std::vector<MIToken> tokens;
+    int rc = dmi.sendMICommands(cmds, tokens);
+    MIRecord attachRes, framesRes, detachRes;
+    if (GLADIUS_SUCCESS == rc) {
+        rc = dmi.recvMIResult(tokens[0], attachRes, gdbTimeoutInMS);
+    }
+    if (GLADIUS_SUCCESS == rc) {
+        rc = dmi.recvMIResult(tokens[1], framesRes, gdbTimeoutInMS);
+    }
+    if (GLADIUS_SUCCESS == rc) {
+        rc = dmi.recvMIResult(tokens[2], detachRes, gdbTimeoutInMS);
+    }
+    (void)dmi.sendMICommand("-gdb-exit");
+    if (GLADIUS_SUCCESS != rc) return rc;
+    //
+    if ("done" != attachRes.klass || "done" != framesRes.klass) {
+        GLADIUS_CERR << "Could not collect stack: "
+                     << attachRes.valueOf("msg") << framesRes.valueOf("msg")
+                     << std::endl;
+        return GLADIUS_ERR;
+    }
+    // Frames come innermost first.
+    const int stack = framesRes.find("stack");
+    for (int f = framesRes.nodes[stack].firstChild; -1 != f;
+         f = framesRes.nodes[f].nextSibling) {
+        std::string func = framesRes.valueOf("func", f);
+        if (func.empty()) func = framesRes.valueOf("addr", f);
+        if (func.empty()) func = "??";
+        frames.push_back(func);
+    }
+    std::reverse(frames.begin(), frames.end());
+    //
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Sends our stack up stream as a single-path stack tree.
+ */
+void
+StacksBE::mSendStack(
+    MRN::Stream *stream
+) {
+    std::vector<std::string> frames;
+    if (GLADIUS_SUCCESS != mGetStack(frames)) {
+        // Still answer, so the front-end can account for us.
+        frames.assign(1, noStackFrame);
+    }
+    stacks::StackTree tree;
+    tree.addStack(mGladiusPluginArgs.uid, frames);
+    stacks::FlatStackTree flat;
+    tree.flatten(flat);
+    //
+    std::vector<char *> framePtrs;
+    for (const auto &f : flat.frames) framePtrs.push_back((char *)f.c_str());
+    // flat must outlive the flush below.
+    int status = stream->send(
+                     stacks::CollectStacks,
+                     STACKS_TREE_PACKET_FORMAT,
+                     framePtrs.data(), int(framePtrs.size()),
+                     flat.parents.data(), int(flat.parents.size()),
+                     flat.rankOffsets.data(), int(flat.rankOffsets.size()),
+                     flat.rankWords.data(), int(flat.rankWords.size())
+                 );
+    if (-1 == status) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Send");
+    }
+    status = stream->flush();
+    if (-1 == status) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+    }
+}
+
+/**
+ *
+ */
+void
+StacksBE::mEnterMainLoop(void)
+{
+    VCOMP_COUT("Entering Main Loop." << std::endl);
+    //
+    MRN::PacketPtr packet;
+    const bool recvShouldBlock = true;
+    // Convenience pointer to network.
+    auto *network = mGladiusPluginArgs.network;
+    MRN::Stream *stream = nullptr;
+    int status = 0;
+    int action = 0;
+    // Do Until the FE Says So...
+    do {
+        // What action is next FE?
+        status = network->recv(&action, packet, &stream, recvShouldBlock);
+        if (1 != status) GLADIUS_THROW_CALL_FAILED("Network::Recv");
+        switch (action) {
+            case stacks::CollectStacks:
+                mSendStack(stream);
+                break;
+            case stacks::Shutdown:
+                break;
+            default:
+                GLADIUS_CERR << "Ignoring Unknown Request: "
+                             << action << std::endl;
+                break;
+        }
+    } while (action != stacks::Shutdown);
+    VCOMP_COUT("Done with Main Loop." << std::endl);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Common stuff (FE/BE/filters) for the stack trace (stacks) plugin.
+ */
+
+#pragma once
+
+#include "plugin/core/gladius-plugin.h"
+
+// The plugin's name.
+#define PLUGIN_NAME "stacks"
+// The plugin's version string.
+#define PLUGIN_VERSION "0.0.1"
+// The name of the filter that merges stack trees on their way up the tree.
+#define STACKS_MERGE_FILTER_NAME "StackTreeMergeFilter"
+// The packet format of a flattened stack tree. See StackTree::flatten.
+#define STACKS_TREE_PACKET_FORMAT "%as %ad %ad %auld"
+
+namespace stacks {
+//
+enum StacksProtoTags {
+    // Notice where we start here. ALL plugins MUST start with this tag value.
+    CollectStacks = gladius::toolcommon::FirstPluginTag,
+    Shutdown
+};
+GLADIUS_CHECK_PLUGIN_TAG(CollectStacks);
+} // end stacks namespace
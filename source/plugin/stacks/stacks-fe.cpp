@@ -0,0 +1,289 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The stack trace (stacks) plugin front-end. Asks every back-end for its
+ * target's stack and displays the merged call-prefix tree.
+ */
+
+#include "plugin/stacks/stacks-common.h"
+#include "plugin/stacks/stack-tree.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "mrnet/sync-stream.h"
+
+#include <iostream>
+#include <cstdlib>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "stacks";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+} // end namespace
+
+/**
+ *
+ */
+class StacksFE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    // Stream that runs through our merge filter.
+    mrnetfe::SyncStream mStream;
+    // The tree that arriving stacks are merged into.
+    stacks::StackTree *mCollecting = nullptr;
+    //
+    void
+    mLoadFilters(void);
+    //
+    unsigned
+    mMergeStacks(const MRN::PacketPtr &packet);
+    //
+    void
+    mEnterMainLoop(void);
+    //
+    bool
+    mCollectStacks(
+        stacks::StackTree &tree
+    );
+    //
+    void
+    mSend(int tag);
+
+public:
+    //
+    StacksFE(void) { ; }
+    //
+    ~StacksFE(void) { ; }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(StacksFE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+StacksFE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_FE_VERBOSE_NAME);
+    COMP_COUT << "::" << std::endl;
+    COMP_COUT << ":: " PLUGIN_NAME " " PLUGIN_VERSION << std::endl;
+    COMP_COUT << "::" << std::endl;
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        mLoadFilters();
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Loads the stack tree merge filter and sets up a stream that uses it.
+ */
+void
+StacksFE::mLoadFilters(void)
+{
+    VCOMP_COUT(
+        "Loading Filters From: " << mGladiusPluginArgs.myHome << std::endl
+    );
+    // Path separator.
+    static const auto ps = core::utils::osPathSep;
+    const std::string filterSOName = mGladiusPluginArgs.myHome
+                                   + ps + "PluginFilters.so";
+    auto *network = mGladiusPluginArgs.network;
+    auto filterID = network->load_FilterFunc(
+                        filterSOName.c_str(),
+                        STACKS_MERGE_FILTER_NAME
+                    );
+    if (-1 == filterID) {
+        GLADIUS_THROW_CALL_FAILED("load_FilterFunc: " + filterSOName);
+    }
+    // By default, wait for all children, so every level of the tree merges
+    // exactly once. A latency budget trades that for partial results.
+    auto sync = mrnetfe::StreamSync::waitForAll();
+    const auto syncEnv = GLADIUS_ENV_TOOL_STREAM_SYNC_NAME;
+    if (core::utils::envVarSet(syncEnv) &&
+        GLADIUS_SUCCESS != sync.fromStr(core::utils::getEnv(syncEnv))) {
+        GLADIUS_THROW(
+            "Invalid " + std::string(syncEnv) + ": "
+            + core::utils::getEnv(syncEnv)
+        );
+    }
+    VCOMP_COUT("Stream synchronization: " << sync.str() << std::endl);
+    const int rc = mStream.create(
+                       network,
+                       network->get_BroadcastCommunicator(),
+                       filterID,
+                       sync,
+                       [this](const MRN::PacketPtr &packet) {
+                           return mMergeStacks(packet);
+                       }
+                   );
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW_CALL_FAILED("new_Stream");
+    }
+    // Don't wait on back-ends that we have lost.
+    mStream.setLostFn(mGladiusPluginArgs.lostBackEnds);
+    //
+    VCOMP_COUT("Done Loading Filters." << std::endl);
+}
+
+/**
+ * Sends a data-less request to all back-ends.
+ */
+void
+StacksFE::mSend(int tag)
+{
+    if (-1 == mStream.stream()->send(tag, "")) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Send");
+    }
+    if (-1 == mStream.stream()->flush()) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+    }
+}
+
+/**
+ * Unpacks a (merged) stack tree and merges it into mCollecting. Returns the
+ * number of back-ends that it came from.
+ */
+unsigned
+StacksFE::mMergeStacks(const MRN::PacketPtr &packet)
+{
+    char **frames = nullptr;
+    int *parents = nullptr, *rankOffsets = nullptr;
+    uint64_t *rankWords = nullptr;
+    int nFrames = 0, nParents = 0, nRankOffsets = 0, nRankWords = 0;
+    if (0 != packet->unpack(
+                 STACKS_TREE_PACKET_FORMAT,
+                 &frames, &nFrames,
+                 &parents, &nParents,
+                 &rankOffsets, &nRankOffsets,
+                 &rankWords, &nRankWords
+             )) {
+        GLADIUS_THROW_CALL_FAILED("PacketPtr::unpack");
+    }
+    // Take ownership of what unpack allocated. Nothing is copied.
+    using toolcommon::TxList;
+    auto frameList = TxList<char *>::adopt(frames, nFrames);
+    auto parentList = TxList<int>::adopt(parents, nParents);
+    auto offsetList = TxList<int>::adopt(rankOffsets, nRankOffsets);
+    auto wordList = TxList<uint64_t>::adopt(rankWords, nRankWords);
+    //
+    stacks::StackTree part;
+    const int rc = part.unflatten(
+                       frames, nFrames, parents, nParents,
+                       rankOffsets, nRankOffsets, rankWords, nRankWords
+                   );
+    for (auto *f : toolcommon::TxListView<char *>(frameList)) free(f);
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW("Received Malformed Stack Tree.");
+    }
+    const unsigned nBackEnds = part.ranks().size();
+    mCollecting->merge(part);
+    //
+    return nBackEnds;
+}
+
+/**
+ * Gathers the merged stack tree from the back-ends, within our stream's
+ * latency budget (if any). Returns whether or not the tree is partial.
+ */
+bool
+StacksFE::mCollectStacks(
+    stacks::StackTree &tree
+) {
+    // Stragglers from an earlier request don't belong in this tree.
+    const unsigned nLate = mStream.discardLate();
+    if (nLate) {
+        VCOMP_COUT("Dropped " << nLate << " late result(s)." << std::endl);
+    }
+    // Rebuild the stream without back-ends that we have lost.
+    if (GLADIUS_SUCCESS != mStream.dropLost()) {
+        GLADIUS_THROW("No Back-Ends Left.");
+    }
+    //
+    mSend(stacks::CollectStacks);
+    //
+    mCollecting = &tree;
+    mrnetfe::SyncStream::Result res;
+    const int rc = mStream.recv(stacks::CollectStacks, res);
+    mCollecting = nullptr;
+    if (GLADIUS_ERR_MRNET == rc) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Recv");
+    }
+    else if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW("Received Unexpected Tag.");
+    }
+    if (res.partial) {
+        COMP_COUT << "Partial results: heard from " << res.nBackEnds
+                  << " of " << res.nExpected << " back-ends within "
+                  << mStream.sync().budgetInMS << " ms." << std::endl;
+    }
+    //
+    return res.partial;
+}
+
+/**
+ * The front-end REPL that drives the back-end actions.
+ */
+void
+StacksFE::mEnterMainLoop(void)
+{
+    using namespace std;
+    //
+    stacks::StackTree tree;
+    mCollectStacks(tree);
+    //
+    const auto &ranks = tree.ranks();
+    cout << "(" + CNAME + ") " << ranks.size() << " Targets "
+         << ranks.str() << ", " << tree.nFrames() << " Unique Frames"
+         << endl << tree.str() << flush;
+    //
+    mSend(stacks::Shutdown);
+    //
+    VCOMP_COUT("Done with Main Loop." << endl);
+}
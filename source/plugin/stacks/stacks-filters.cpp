@@ -0,0 +1,139 @@
+/**
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Filters for the stacks plugin. Stack trees are merged at every level of the
+ * MRNet tree, so the front-end receives a single tree whose size depends on
+ * the number of distinct call paths, not on the number of ranks.
+ */
+
+#include "plugin/stacks/stacks-common.h"
+#include "plugin/stacks/stack-tree.h"
+
+#include "core/gladius-rc.h"
+
+#include "mrnet/Packet.h"
+#include "mrnet/NetworkTopology.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace MRN;
+
+namespace {
+
+/**
+ * Unpacks a flattened stack tree from packet and merges it into tree.
+ */
+int
+mergeFromPacket(
+    const PacketPtr &packet,
+    stacks::StackTree &tree
+) {
+    char **frames = nullptr;
+    int *parents = nullptr, *rankOffsets = nullptr;
+    uint64_t *rankWords = nullptr;
+    int nFrames = 0, nParents = 0, nRankOffsets = 0, nRankWords = 0;
+    if (0 != packet->unpack(
+                 STACKS_TREE_PACKET_FORMAT,
+                 &frames, &nFrames,
+                 &parents, &nParents,
+                 &rankOffsets, &nRankOffsets,
+                 &rankWords, &nRankWords
+             )) {
+        return GLADIUS_ERR_MRNET;
+    }
+    stacks::StackTree child;
+    int rc = child.unflatten(
+                 frames, nFrames, parents, nParents,
+                 rankOffsets, nRankOffsets, rankWords, nRankWords
+             );
+    if (GLADIUS_SUCCESS == rc) tree.merge(child);
+    //
+    for (int f = 0; f < nFrames; ++f) free(frames[f]);
+    free(frames);
+    free(parents);
+    free(rankOffsets);
+    free(rankWords);
+    //
+    return rc;
+}
+
+/**
+ * Returns a malloc'd copy of v (MRNet frees packet data with free(3)).
+ */
+template <typename T>
+T *
+mallocCopy(const vector<T> &v)
+{
+    T *res = (T *)malloc(sizeof(T) * (v.empty() ? 1 : v.size()));
+    if (res && !v.empty()) memcpy(res, v.data(), sizeof(T) * v.size());
+    return res;
+}
+
+} // end namespace
+
+/**
+ *
+ */
+extern "C" {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+const char *StackTreeMergeFilter_format_string = STACKS_TREE_PACKET_FORMAT;
+
+/**
+ * Merges the stack trees from all children into one.
+ */
+void
+StackTreeMergeFilter(
+    vector<PacketPtr> &inputPackets,
+    vector<PacketPtr> &outputPackets,
+    vector<PacketPtr> &,
+    void **,
+    PacketPtr &
+) {
+    if (inputPackets.empty()) return;
+    // Not ours, so pass it along.
+    const int tag = inputPackets[0]->get_Tag();
+    if (stacks::CollectStacks != tag) {
+        outputPackets = inputPackets;
+        return;
+    }
+    //
+    stacks::StackTree merged;
+    for (auto &p : inputPackets) {
+        // Nothing sensible to do with a bad packet but drop it.
+        (void)mergeFromPacket(p, merged);
+    }
+    stacks::FlatStackTree flat;
+    merged.flatten(flat);
+    // The packet owns (and frees) these.
+    const int nFrames = flat.frames.size();
+    char **frames = (char **)malloc(sizeof(char *) * nFrames);
+    for (int f = 0; f < nFrames; ++f) {
+        frames[f] = strdup(flat.frames[f].c_str());
+    }
+    PacketPtr out(
+        new Packet(
+            inputPackets[0]->get_StreamId(),
+            tag,
+            STACKS_TREE_PACKET_FORMAT,
+            frames, nFrames,
+            mallocCopy(flat.parents), int(flat.parents.size()),
+            mallocCopy(flat.rankOffsets), int(flat.rankOffsets.size()),
+            mallocCopy(flat.rankWords), int(flat.rankWords.size())
+        )
+    );
+    out->set_DestroyData(true);
+    outputPackets.push_back(out);
+}
+
+}
@@ -0,0 +1,14 @@
+/**
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+#ifndef GLADIUS_PLUGIN_STACKS_FILTERS_H_INCLUDED
+#define GLADIUS_PLUGIN_STACKS_FILTERS_H_INCLUDED
+
+#include "mrnet/Types.h"
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The live job metrics (top) plugin back-end. Samples its target through
+ * /proc between front-end requests, and answers each request with its rank's
+ * CPU utilization, RSS, and state.
+ */
+
+#include "plugin/top/top-common.h"
+#include "plugin/top/top-metrics.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "tool-be/event-loop.h"
+#include "tool-be/proc-sampler.h"
+#include "tool-common/tx-message.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "topbe";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+} // end namespace
+
+/**
+ *
+ */
+class TopBE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    //
+    std::string mHostName;
+    // This session's loop.
+    std::unique_ptr<toolbe::EventLoop> mLoop;
+    // This session's sampler.
+    std::unique_ptr<toolbe::ProcSampler> mSampler;
+    // Our two latest samples (CPU utilization needs both).
+    toolcommon::ProcSample mPrev, mLast;
+    //
+    unsigned mNSamples = 0;
+    //
+    void
+    mEnterMainLoop(void);
+    //
+    void
+    mStart(const MRN::PacketPtr &packet);
+    //
+    void
+    mTakeSample(void);
+    //
+    void
+    mSendMetrics(
+        MRN::Stream *stream
+    );
+
+public:
+    //
+    TopBE(void) { ; }
+    //
+    ~TopBE(void) { ; }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(TopBE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+TopBE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_BE_VERBOSE_NAME);
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        mHostName = core::utils::getHostname();
+        // Nothing carries over from an earlier session.
+        mLoop.reset(new toolbe::EventLoop());
+        mSampler.reset(new toolbe::ProcSampler(16));
+        mPrev = mLast = toolcommon::ProcSample();
+        mNSamples = 0;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Starts sampling our target (the process that we live in) at the period that
+ * the front-end asked for.
+ */
+void
+TopBE::mStart(const MRN::PacketPtr &packet)
+{
+    toolcommon::TxMessage msg;
+    uint32_t periodInMS = 0;
+    if (GLADIUS_SUCCESS != msg.unpack(packet) ||
+        !msg.get(periodInMS) || 0 == periodInMS) {
+        GLADIUS_THROW("Received Malformed Start Request.");
+    }
+    VCOMP_COUT("Sampling every " << periodInMS << " ms." << std::endl);
+    //
+    const int rc = mSampler->addTarget(mGladiusPluginArgs.uid, getpid());
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW_CALL_FAILED_RC("ProcSampler::addTarget", rc);
+    }
+    mTakeSample();
+    (void)mLoop->addTimer(periodInMS, [this]() { mTakeSample(); });
+}
+
+/**
+ *
+ */
+void
+TopBE::mTakeSample(void)
+{
+    (void)mSampler->sampleOnce();
+    toolcommon::ProcSample s;
+    while (mSampler->pop(s)) {
+        mPrev = mLast;
+        mLast = s;
+        mNSamples++;
+    }
+}
+
+/**
+ * Sends our rank's metrics up stream. They are reduced with everyone else's
+ * on the way.
+ */
+void
+TopBE::mSendMetrics(
+    MRN::Stream *stream
+) {
+    double cpuPct = 0.0;
+    if (mNSamples >= 2 && mLast.timeNS > mPrev.timeNS) {
+        cpuPct = 100.0 * double(mLast.cpuNS - mPrev.cpuNS)
+               / double(mLast.timeNS - mPrev.timeNS);
+    }
+    const double rssMB = double(mLast.rssKB) / 1024.0;
+    const char state = mNSamples ? mLast.state : '?';
+    //
+    top::Metrics metrics;
+    metrics.addRank(mHostName, cpuPct, rssMB, state);
+    toolcommon::TxMessageWriter msg;
+    metrics.pack(msg);
+    if (GLADIUS_SUCCESS != msg.pluginSend(stream, top::Sample)) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Send");
+    }
+    if (-1 == stream->flush()) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+    }
+}
+
+/**
+ *
+ */
+void
+TopBE::mEnterMainLoop(void)
+{
+    VCOMP_COUT("Entering Main Loop." << std::endl);
+    // Do Until the FE Says So...
+    const auto onPacket = [this](
+        int action,
+        const MRN::PacketPtr &packet,
+        MRN::Stream *stream
+    ) {
+        switch (action) {
+            case top::Start:
+                mStart(packet);
+                break;
+            case top::Sample:
+                mSendMetrics(stream);
+                break;
+            case top::Shutdown:
+                mLoop->stop();
+                break;
+            default:
+                GLADIUS_CERR << "Ignoring Unknown Request: "
+                             << action << std::endl;
+                break;
+        }
+    };
+    if (GLADIUS_SUCCESS != mLoop->setNetwork(
+                               mGladiusPluginArgs.network, onPacket
+                           )) {
+        GLADIUS_THROW_CALL_FAILED("EventLoop::setNetwork");
+    }
+    const int rc = mLoop->run();
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW_CALL_FAILED_RC("EventLoop::run", rc);
+    }
+    VCOMP_COUT("Done with Main Loop." << std::endl);
+}
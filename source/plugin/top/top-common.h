@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Common stuff (FE/BE/filters) for the live job metrics (top) plugin.
+ */
+
+#pragma once
+
+#include "plugin/core/gladius-plugin.h"
+
+// The plugin's name.
+#define PLUGIN_NAME "top"
+// The plugin's version string.
+#define PLUGIN_VERSION "0.0.1"
+// The name of the filter that reduces metrics on their way up the tree.
+#define TOP_REDUCE_FILTER_NAME "TopReduceFilter"
+// The packet format of metrics (a TxMessage). See top::Metrics::pack.
+#define TOP_METRICS_PACKET_FORMAT "%auc"
+
+namespace top {
+//
+enum TopProtoTags {
+    // Notice where we start here. ALL plugins MUST start with this tag value.
+    // Starts sampling. Carries the sampling period (uint32_t milliseconds).
+    Start = gladius::toolcommon::FirstPluginTag,
+    // Requests metrics (FE to BEs), and carries them (BEs to FE).
+    Sample,
+    //
+    Shutdown
+};
+GLADIUS_CHECK_PLUGIN_TAG(Start);
+} // end top namespace
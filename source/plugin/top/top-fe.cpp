@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The live job metrics (top) plugin front-end. Asks the back-ends for their
+ * metrics at a fixed rate and redraws a per-host and job-wide summary until
+ * the user quits. Metrics are reduced per host inside the tree, so what we
+ * receive grows with the number of hosts, not ranks.
+ */
+
+#include "plugin/top/top-common.h"
+#include "plugin/top/top-metrics.h"
+
+#include "plugin/core/gladius-plugin.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+#include "core/colors.h"
+#include "core/env.h"
+#include "mrnet/sync-stream.h"
+#include "tool-common/tx-message.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "mrnet/MRNet.h"
+
+using namespace gladius;
+using namespace gladius::gpi;
+
+namespace {
+// This component's name.
+const std::string CNAME = "top";
+//
+const auto COMPC = core::colors::MAGENTA;
+// CNAME's color code.
+const std::string NAMEC = core::colors::color().ansiBeginColor(COMPC);
+// Convenience macro to decorate this component's output.
+#define COMP_COUT GLADIUS_COMP_COUT(CNAME, NAMEC)
+// Output if this component is being verbose.
+#define VCOMP_COUT(streamInsertions)                                           \
+do {                                                                           \
+    if (this->mBeVerbose) {                                                    \
+        COMP_COUT << streamInsertions;                                         \
+    }                                                                          \
+} while (0)
+// Default time between redraws, in milliseconds.
+const int defaultRefreshInMS = 1000;
+// Shortest time between redraws that we allow, in milliseconds.
+const int minRefreshInMS = 100;
+// The most hosts that we list (the busiest ones).
+const size_t maxHostRows = 20;
+// The width of the widest histogram bar.
+const int maxBarWidth = 40;
+} // end namespace
+
+/**
+ *
+ */
+class TopFE : public GladiusPlugin {
+    //
+    bool mBeVerbose = false;
+    //
+    GladiusPluginArgs mGladiusPluginArgs;
+    //
+    int mRefreshInMS = defaultRefreshInMS;
+    // Stream that runs through our reduce filter.
+    mrnetfe::SyncStream mStream;
+    // The metrics that arriving packets are merged into.
+    top::Metrics *mCollecting = nullptr;
+    //
+    void
+    mLoadFilters(void);
+    //
+    unsigned
+    mMergeMetrics(const MRN::PacketPtr &packet);
+    //
+    void
+    mSend(
+        int tag,
+        const toolcommon::TxMessageWriter &msg
+    );
+    //
+    mrnetfe::SyncStream::Result
+    mCollectMetrics(
+        top::Metrics &metrics
+    );
+    //
+    void
+    mDraw(
+        const top::Metrics &metrics,
+        const mrnetfe::SyncStream::Result &res
+    );
+    //
+    bool
+    mUserQuit(int waitInMS);
+    //
+    void
+    mEnterMainLoop(void);
+
+public:
+    //
+    TopFE(void) { ; }
+    //
+    ~TopFE(void) { ; }
+    //
+    virtual void
+    pluginMain(
+        GladiusPluginArgs &pluginArgs
+    );
+};
+
+/**
+ * Plugin registration.
+ */
+GLADIUS_PLUGIN(TopFE, PLUGIN_NAME, PLUGIN_VERSION)
+
+/**
+ * Plugin Main.
+ */
+void
+TopFE::pluginMain(
+    GladiusPluginArgs &pluginArgs
+) {
+    // Set our verbosity level.
+    mBeVerbose = core::utils::envVarSet(GLADIUS_ENV_TOOL_FE_VERBOSE_NAME);
+    COMP_COUT << "::" << std::endl;
+    COMP_COUT << ":: " PLUGIN_NAME " " PLUGIN_VERSION << std::endl;
+    COMP_COUT << "::" << std::endl;
+    // And so it begins...
+    try {
+        mGladiusPluginArgs = pluginArgs;
+        VCOMP_COUT("Home: " << mGladiusPluginArgs.myHome << std::endl);
+        const auto refreshEnv = GLADIUS_ENV_TOP_REFRESH_MS_NAME;
+        if (core::utils::envVarSet(refreshEnv) &&
+            (GLADIUS_SUCCESS != core::utils::getEnvAs(
+                                    refreshEnv, mRefreshInMS
+                                ) || mRefreshInMS < minRefreshInMS)) {
+            GLADIUS_THROW(
+                "Invalid " + std::string(refreshEnv) + ": "
+                + core::utils::getEnv(refreshEnv) + " (minimum is "
+                + std::to_string(minRefreshInMS) + " ms)"
+            );
+        }
+        mLoadFilters();
+        mEnterMainLoop();
+    }
+    catch (const std::exception &e) {
+        throw core::GladiusException(GLADIUS_WHERE, e.what());
+    }
+    //
+    VCOMP_COUT("Exiting Plugin." << std::endl);
+}
+
+/**
+ * Loads the metrics reduce filter and sets up a stream that uses it.
+ */
+void
+TopFE::mLoadFilters(void)
+{
+    VCOMP_COUT(
+        "Loading Filters From: " << mGladiusPluginArgs.myHome << std::endl
+    );
+    // Path separator.
+    static const auto ps = core::utils::osPathSep;
+    const std::string filterSOName = mGladiusPluginArgs.myHome
+                                   + ps + "PluginFilters.so";
+    auto *network = mGladiusPluginArgs.network;
+    auto filterID = network->load_FilterFunc(
+                        filterSOName.c_str(),
+                        TOP_REDUCE_FILTER_NAME
+                    );
+    if (-1 == filterID) {
+        GLADIUS_THROW_CALL_FAILED("load_FilterFunc: " + filterSOName);
+    }
+    // A live view can't wait for stragglers, so by default we show whatever
+    // arrives within half a refresh period.
+    auto sync = mrnetfe::StreamSync::timeWindow(mRefreshInMS / 2);
+    const auto syncEnv = GLADIUS_ENV_TOOL_STREAM_SYNC_NAME;
+    if (core::utils::envVarSet(syncEnv) &&
+        GLADIUS_SUCCESS != sync.fromStr(core::utils::getEnv(syncEnv))) {
+        GLADIUS_THROW(
+            "Invalid " + std::string(syncEnv) + ": "
+            + core::utils::getEnv(syncEnv)
+        );
+    }
+    VCOMP_COUT("Stream synchronization: " << sync.str() << std::endl);
+    const int rc = mStream.create(
+                       network,
+                       network->get_BroadcastCommunicator(),
+                       filterID,
+                       sync,
+                       [this](const MRN::PacketPtr &packet) {
+                           return mMergeMetrics(packet);
+                       }
+                   );
+    if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW_CALL_FAILED("new_Stream");
+    }
+    // Don't wait on back-ends that we have lost.
+    mStream.setLostFn(mGladiusPluginArgs.lostBackEnds);
+    //
+    VCOMP_COUT("Done Loading Filters." << std::endl);
+}
+
+/**
+ * Sends a request to all back-ends.
+ */
+void
+TopFE::mSend(
+    int tag,
+    const toolcommon::TxMessageWriter &msg
+) {
+    if (GLADIUS_SUCCESS != msg.pluginSend(mStream.stream(), tag)) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Send");
+    }
+    if (-1 == mStream.stream()->flush()) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Flush");
+    }
+}
+
+/**
+ * Merges (reduced) metrics into mCollecting. Returns the number of back-ends
+ * (ranks) that they came from.
+ */
+unsigned
+TopFE::mMergeMetrics(const MRN::PacketPtr &packet)
+{
+    toolcommon::TxMessage msg;
+    top::Metrics part;
+    if (GLADIUS_SUCCESS != msg.unpack(packet) ||
+        GLADIUS_SUCCESS != part.unpack(msg)) {
+        GLADIUS_THROW("Received Malformed Metrics.");
+    }
+    mCollecting->merge(part);
+    return part.nRanks();
+}
+
+/**
+ * Gathers one round of metrics from the back-ends, within our stream's
+ * latency budget.
+ */
+mrnetfe::SyncStream::Result
+TopFE::mCollectMetrics(
+    top::Metrics &metrics
+) {
+    // Stragglers from an earlier round don't belong in this one.
+    const unsigned nLate = mStream.discardLate();
+    if (nLate) {
+        VCOMP_COUT("Dropped " << nLate << " late result(s)." << std::endl);
+    }
+    // Rebuild the stream without back-ends that we have lost.
+    if (GLADIUS_SUCCESS != mStream.dropLost()) {
+        GLADIUS_THROW("No Back-Ends Left.");
+    }
+    //
+    mSend(top::Sample, toolcommon::TxMessageWriter());
+    //
+    mCollecting = &metrics;
+    mrnetfe::SyncStream::Result res;
+    const int rc = mStream.recv(top::Sample, res);
+    mCollecting = nullptr;
+    if (GLADIUS_ERR_MRNET == rc) {
+        GLADIUS_THROW_CALL_FAILED("Stream::Recv");
+    }
+    else if (GLADIUS_SUCCESS != rc) {
+        GLADIUS_THROW("Received Unexpected Tag.");
+    }
+    //
+    return res;
+}
+
+/**
+ * Redraws the screen.
+ */
+void
+TopFE::mDraw(
+    const top::Metrics &metrics,
+    const mrnetfe::SyncStream::Result &res
+) {
+    using namespace std;
+    //
+    const auto g = metrics.global();
+    const auto mean = [](const top::Summary &s, uint32_t n) {
+        return n ? s.sum / n : 0.0;
+    };
+    char now[16] = {'\0'};
+    const time_t t = time(nullptr);
+    (void)strftime(now, sizeof(now), "%H:%M:%S", localtime(&t));
+    //
+    ostringstream os;
+    os << fixed << setprecision(1);
+    // Home and clear.
+    os << "\033[H\033[2J";
+    os << PLUGIN_NAME " - " << now
+       << "  hosts: " << metrics.hosts().size()
+       << "  ranks: " << g.nRanks << "/" << res.nExpected
+       << (res.partial ? "  (partial)" : "") << '\n';
+    os << "CPU%   min " << setw(7) << g.cpuPct.min
+       << "  mean " << setw(7) << mean(g.cpuPct, g.nRanks)
+       << "  max " << setw(7) << g.cpuPct.max << '\n';
+    os << "RSS MB min " << setw(7) << g.rssMB.min
+       << "  mean " << setw(7) << mean(g.rssMB, g.nRanks)
+       << "  max " << setw(7) << g.rssMB.max << '\n';
+    os << "States";
+    for (int s = 0; s < top::NRankStates; ++s) {
+        os << "  " << top::rankStateChar(top::RankState(s))
+           << " " << g.states[s];
+    }
+    os << "\n\nCPU% histogram\n";
+    const uint32_t maxBin = *max_element(g.cpuHist, g.cpuHist + top::NCPUBins);
+    const int binWidth = 100 / top::NCPUBins;
+    for (int b = 0; b < top::NCPUBins; ++b) {
+        const int bar = maxBin ? int(g.cpuHist[b] * maxBarWidth / maxBin) : 0;
+        const bool last = (top::NCPUBins - 1 == b);
+        const string label = to_string(b * binWidth)
+                           + (last ? "+" : "-" + to_string((b + 1) * binWidth));
+        os << right << setw(7) << label << " "
+           << "|" << string(bar, '#') << " " << g.cpuHist[b] << '\n';
+    }
+    // Busiest hosts first.
+    using Row = const pair<const string, top::HostStats> *;
+    vector<Row> rows;
+    for (const auto &h : metrics.hosts()) rows.push_back(&h);
+    sort(rows.begin(), rows.end(), [&](Row a, Row b) {
+        return mean(a->second.cpuPct, a->second.nRanks)
+             > mean(b->second.cpuPct, b->second.nRanks);
+    });
+    os << '\n' << left << setw(24) << "HOST" << right
+       << setw(7) << "RANKS" << setw(9) << "CPU%" << setw(9) << "MAX"
+       << setw(10) << "RSS MB" << setw(10) << "MAX" << "  R/S/D/Z/T\n";
+    for (size_t i = 0; i < rows.size() && i < maxHostRows; ++i) {
+        const auto &h = rows[i]->second;
+        os << left << setw(24) << rows[i]->first.substr(0, 23) << right
+           << setw(7) << h.nRanks
+           << setw(9) << mean(h.cpuPct, h.nRanks) << setw(9) << h.cpuPct.max
+           << setw(10) << mean(h.rssMB, h.nRanks) << setw(10) << h.rssMB.max
+           << "  " << h.states[top::Running] << "/" << h.states[top::Sleeping]
+           << "/" << h.states[top::DiskWait] << "/" << h.states[top::Zombie]
+           << "/" << h.states[top::Stopped] << '\n';
+    }
+    if (rows.size() > maxHostRows) {
+        os << "... and " << rows.size() - maxHostRows << " more host(s)\n";
+    }
+    os << "\nq<Enter> to quit.\n";
+    cout << os.str() << flush;
+}
+
+/**
+ * Waits up to waitInMS for the user. Returns whether or not they asked to
+ * quit.
+ */
+bool
+TopFE::mUserQuit(int waitInMS)
+{
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + milliseconds(waitInMS);
+    while (true) {
+        const auto left = duration_cast<milliseconds>(
+                              deadline - steady_clock::now()
+                          ).count();
+        if (left <= 0) return false;
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        const int rc = poll(&pfd, 1, int(left));
+        if (-1 == rc) {
+            if (EINTR == errno) continue;
+            return true;
+        }
+        if (0 == rc) return false;
+        std::string line;
+        if (!std::getline(std::cin, line)) return true;
+        if (!line.empty() && 'q' == line[0]) return true;
+    }
+}
+
+/**
+ * The front-end REPL that drives the back-end actions.
+ */
+void
+TopFE::mEnterMainLoop(void)
+{
+    using namespace std::chrono;
+    // The back-ends sample at our refresh rate.
+    toolcommon::TxMessageWriter start;
+    start.put(uint32_t(mRefreshInMS));
+    mSend(top::Start, start);
+    //
+    bool quit = false;
+    while (!quit) {
+        const auto begin = steady_clock::now();
+        top::Metrics metrics;
+        const auto res = mCollectMetrics(metrics);
+        mDraw(metrics, res);
+        const auto took = duration_cast<milliseconds>(
+                              steady_clock::now() - begin
+                          ).count();
+        quit = mUserQuit(std::max(0, mRefreshInMS - int(took)));
+    }
+    //
+    mSend(top::Shutdown, toolcommon::TxMessageWriter());
+    //
+    VCOMP_COUT("Done with Main Loop." << std::endl);
+}
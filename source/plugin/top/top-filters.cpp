@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Filters for the top plugin. Per-host metrics are reduced at every level of
+ * the MRNet tree, so the front-end receives one record per host no matter how
+ * many ranks there are.
+ */
+
+#include "plugin/top/top-common.h"
+#include "plugin/top/top-metrics.h"
+
+#include "core/gladius-rc.h"
+
+#include "mrnet/Packet.h"
+#include "mrnet/NetworkTopology.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace MRN;
+
+/**
+ *
+ */
+extern "C" {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+const char *TopReduceFilter_format_string = TOP_METRICS_PACKET_FORMAT;
+
+/**
+ * Reduces the metrics from all children into one set of per-host metrics.
+ */
+void
+TopReduceFilter(
+    vector<PacketPtr> &inputPackets,
+    vector<PacketPtr> &outputPackets,
+    vector<PacketPtr> &,
+    void **,
+    PacketPtr &
+) {
+    using namespace gladius::toolcommon;
+    //
+    if (inputPackets.empty()) return;
+    // Not ours, so pass it along.
+    const int tag = inputPackets[0]->get_Tag();
+    if (top::Sample != tag) {
+        outputPackets = inputPackets;
+        return;
+    }
+    //
+    top::Metrics reduced;
+    for (auto &p : inputPackets) {
+        TxMessage msg;
+        // Nothing sensible to do with a bad packet but drop it.
+        if (GLADIUS_SUCCESS != msg.unpack(p)) continue;
+        (void)reduced.unpack(msg);
+    }
+    TxMessageWriter out;
+    reduced.pack(out);
+    // The packet owns (and frees) this.
+    unsigned char *buf = (unsigned char *)malloc(out.size() ? out.size() : 1);
+    if (!buf) return;
+    if (out.size()) memcpy(buf, out.data(), out.size());
+    PacketPtr packet(
+        new Packet(
+            inputPackets[0]->get_StreamId(),
+            tag,
+            TOP_METRICS_PACKET_FORMAT,
+            buf, int(out.size())
+        )
+    );
+    packet->set_DestroyData(true);
+    outputPackets.push_back(packet);
+}
+
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+#include "plugin/top/top-metrics.h"
+
+#include "core/gladius-rc.h"
+
+#include <algorithm>
+
+using namespace top;
+
+/**
+ *
+ */
+RankState
+top::rankStateFrom(char state)
+{
+    switch (state) {
+        case 'R': return Running;
+        case 'S': case 'I': return Sleeping;
+        case 'D': return DiskWait;
+        case 'Z': case 'X': return Zombie;
+        case 'T': case 't': return Stopped;
+        default: return OtherState;
+    }
+}
+
+/**
+ *
+ */
+char
+top::rankStateChar(RankState s)
+{
+    static const char names[NRankStates] = {'R', 'S', 'D', 'Z', 'T', '?'};
+    return names[s];
+}
+
+/**
+ *
+ */
+void
+Summary::add(
+    double v,
+    bool first
+) {
+    min = first ? v : std::min(min, v);
+    max = first ? v : std::max(max, v);
+    sum += v;
+}
+
+/**
+ *
+ */
+void
+Summary::merge(
+    const Summary &other,
+    bool first
+) {
+    min = first ? other.min : std::min(min, other.min);
+    max = first ? other.max : std::max(max, other.max);
+    sum += other.sum;
+}
+
+/**
+ *
+ */
+void
+HostStats::addRank(
+    double cpuPct,
+    double rssMB,
+    char state
+) {
+    const bool first = (0 == nRanks);
+    this->cpuPct.add(cpuPct, first);
+    this->rssMB.add(rssMB, first);
+    states[rankStateFrom(state)]++;
+    const int bin = int(cpuPct / (100.0 / NCPUBins));
+    cpuHist[std::max(0, std::min(NCPUBins - 1, bin))]++;
+    nRanks++;
+}
+
+/**
+ *
+ */
+void
+HostStats::merge(const HostStats &other)
+{
+    if (0 == other.nRanks) return;
+    const bool first = (0 == nRanks);
+    cpuPct.merge(other.cpuPct, first);
+    rssMB.merge(other.rssMB, first);
+    for (int s = 0; s < NRankStates; ++s) states[s] += other.states[s];
+    for (int b = 0; b < NCPUBins; ++b) cpuHist[b] += other.cpuHist[b];
+    nRanks += other.nRanks;
+}
+
+/**
+ *
+ */
+void
+Metrics::addRank(
+    const std::string &host,
+    double cpuPct,
+    double rssMB,
+    char state
+) {
+    mHosts[host].addRank(cpuPct, rssMB, state);
+}
+
+/**
+ *
+ */
+void
+Metrics::merge(const Metrics &other)
+{
+    for (const auto &h : other.mHosts) {
+        mHosts[h.first].merge(h.second);
+    }
+}
+
+/**
+ *
+ */
+HostStats
+Metrics::global(void) const
+{
+    HostStats res;
+    for (const auto &h : mHosts) res.merge(h.second);
+    return res;
+}
+
+/**
+ *
+ */
+uint32_t
+Metrics::nRanks(void) const
+{
+    uint32_t n = 0;
+    for (const auto &h : mHosts) n += h.second.nRanks;
+    return n;
+}
+
+/**
+ *
+ */
+void
+Metrics::pack(gladius::toolcommon::TxMessageWriter &msg) const
+{
+    for (const auto &h : mHosts) {
+        msg.putStr(h.first).put(h.second);
+    }
+}
+
+/**
+ *
+ */
+int
+Metrics::unpack(gladius::toolcommon::TxMessage &msg)
+{
+    while (!msg.atEnd()) {
+        std::string host;
+        HostStats stats;
+        if (!msg.getStr(host) || !msg.get(stats)) return GLADIUS_ERR;
+        mHosts[host].merge(stats);
+    }
+    return GLADIUS_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Job metrics reduced per host. Every back-end contributes one rank to its
+ * host's statistics, and statistics for the same host are merged on their way
+ * up the tree, so what reaches the front-end grows with the number of hosts,
+ * not with the number of ranks.
+ */
+
+#pragma once
+
+#include "tool-common/tx-message.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace top {
+
+// Process states that we count.
+enum RankState {
+    Running = 0,
+    Sleeping,
+    DiskWait,
+    Zombie,
+    Stopped,
+    OtherState,
+    NRankStates
+};
+
+/**
+ * Returns the RankState for a /proc/<pid>/stat state.
+ */
+RankState
+rankStateFrom(char state);
+
+/**
+ * Returns the one-letter name of s.
+ */
+char
+rankStateChar(RankState s);
+
+// The number of CPU utilization histogram bins. They split [0%, 100%) evenly;
+// the last one also takes everything above (multi-threaded ranks).
+static const int NCPUBins = 10;
+
+/**
+ * Min, max, and sum of some values.
+ */
+struct Summary {
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+
+    /**
+     * Adds v. first says whether or not v is the first value.
+     */
+    void
+    add(
+        double v,
+        bool first
+    );
+
+    /**
+     * Merges other in. first says whether or not we are empty.
+     */
+    void
+    merge(
+        const Summary &other,
+        bool first
+    );
+};
+
+/**
+ * One host's (or the whole job's) statistics. Trivially copyable, so it goes
+ * over the wire as is.
+ */
+struct HostStats {
+    // The number of ranks in the statistics.
+    uint32_t nRanks = 0;
+    // CPU utilization in percent (100 is one core).
+    Summary cpuPct;
+    // Resident set size in MB.
+    Summary rssMB;
+    // Ranks in each RankState.
+    uint32_t states[NRankStates] = {};
+    // Ranks in each CPU utilization bin.
+    uint32_t cpuHist[NCPUBins] = {};
+
+    /**
+     *
+     */
+    void
+    addRank(
+        double cpuPct,
+        double rssMB,
+        char state
+    );
+
+    /**
+     *
+     */
+    void
+    merge(const HostStats &other);
+};
+
+/**
+ * Per-host statistics.
+ */
+class Metrics {
+    //
+    std::map<std::string, HostStats> mHosts;
+
+public:
+    /**
+     *
+     */
+    void
+    addRank(
+        const std::string &host,
+        double cpuPct,
+        double rssMB,
+        char state
+    );
+
+    /**
+     *
+     */
+    void
+    merge(const Metrics &other);
+
+    /**
+     * Returns the statistics of all hosts together.
+     */
+    HostStats
+    global(void) const;
+
+    /**
+     *
+     */
+    const std::map<std::string, HostStats> &
+    hosts(void) const {
+        return mHosts;
+    }
+
+    /**
+     * Returns the number of ranks in the statistics.
+     */
+    uint32_t
+    nRanks(void) const;
+
+    /**
+     * Appends us to msg: per host, its name then its HostStats.
+     */
+    void
+    pack(gladius::toolcommon::TxMessageWriter &msg) const;
+
+    /**
+     * Merges what msg holds (everything up to its end) into us.
+     */
+    int
+    unpack(gladius::toolcommon::TxMessage &msg);
+};
+
+} // end top namespace
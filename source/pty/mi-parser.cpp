@@ -0,0 +1,290 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Implements a single-pass GDB/MI output parser. Every byte of a line is
+ * visited once and values are unescaped straight into their nodes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "pty/mi-parser.h"
+
+#include "core/core.h"
+
+#include <cctype>
+
+using namespace gladius;
+using namespace gladius::dmi;
+
+////////////////////////////////////////////////////////////////////////////////
+// MIRecord
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the index of parent's first child named name, or -1 if not found.
+ */
+int
+MIRecord::find(
+    const std::string &name,
+    int parent
+) const {
+    if (parent < 0 || parent >= int(nodes.size())) return -1;
+    for (int c = nodes[parent].firstChild; -1 != c; c = nodes[c].nextSibling) {
+        if (nodes[c].name == name) return c;
+    }
+    return -1;
+}
+
+/**
+ * Same as find, but takes a dot-separated path, e.g. "frame.func".
+ */
+int
+MIRecord::findPath(
+    const std::string &path,
+    int parent
+) const {
+    int node = parent;
+    size_t start = 0;
+    while (-1 != node && start <= path.size()) {
+        size_t dot = path.find('.', start);
+        if (std::string::npos == dot) dot = path.size();
+        node = find(path.substr(start, dot - start), node);
+        start = dot + 1;
+    }
+    return node;
+}
+
+/**
+ * Returns the value of the constant at path, or an empty string if there is no
+ * such constant.
+ */
+std::string
+MIRecord::valueOf(
+    const std::string &path,
+    int parent
+) const {
+    const int node = findPath(path, parent);
+    if (-1 == node || MINode::CONST != nodes[node].type) return "";
+    return nodes[node].value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIParser
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Parses one line of GDB/MI output (without its newline) into rec. Returns
+ * GLADIUS_SUCCESS if the line is a well-formed record.
+ */
+int
+MIParser::parseLine(
+    const std::string &line,
+    MIRecord &rec
+) {
+    rec.clear();
+    size_t pos = 0;
+    const size_t len = line.size();
+    // The prompt. Note that GDB emits a trailing space.
+    if (0 == line.compare(0, 5, "(gdb)")) {
+        rec.kind = MIRecord::PROMPT;
+        return GLADIUS_SUCCESS;
+    }
+    // Optional token.
+    if (pos < len && isdigit(line[pos])) {
+        MIToken tok = 0;
+        while (pos < len && isdigit(line[pos])) {
+            tok = (tok * 10) + (line[pos++] - '0');
+        }
+        rec.token = tok;
+    }
+    if (pos >= len) return GLADIUS_ERR;
+    //
+    const char type = line[pos++];
+    switch (type) {
+        case '^': rec.kind = MIRecord::RESULT;         break;
+        case '*': rec.kind = MIRecord::EXEC_ASYNC;     break;
+        case '+': rec.kind = MIRecord::STATUS_ASYNC;   break;
+        case '=': rec.kind = MIRecord::NOTIFY_ASYNC;   break;
+        case '~': rec.kind = MIRecord::CONSOLE_STREAM; break;
+        case '@': rec.kind = MIRecord::TARGET_STREAM;  break;
+        case '&': rec.kind = MIRecord::LOG_STREAM;     break;
+        default:
+            rec.kind = MIRecord::UNKNOWN;
+            rec.text = line;
+            return GLADIUS_ERR;
+    }
+    // Stream records are just a c-string.
+    if (rec.isStream()) {
+        return mParseCString(line, pos, rec.text);
+    }
+    // Result and async records: class (, result)*
+    const size_t classEnd = line.find(',', pos);
+    if (std::string::npos == classEnd) {
+        rec.klass.assign(line, pos, std::string::npos);
+        return GLADIUS_SUCCESS;
+    }
+    rec.klass.assign(line, pos, classEnd - pos);
+    pos = classEnd;
+    int lastChild = -1;
+    while (pos < len && ',' == line[pos]) {
+        ++pos;
+        int rc = mParseResult(line, pos, rec, rec.root(), lastChild);
+        if (GLADIUS_SUCCESS != rc) return rc;
+    }
+    return (pos == len) ? GLADIUS_SUCCESS : GLADIUS_ERR;
+}
+
+/**
+ * Appends a new child to parent and returns its index.
+ */
+int
+MIParser::mAddChild(
+    MIRecord &rec,
+    int parent,
+    int &lastChild
+) {
+    const int child = rec.nodes.size();
+    rec.nodes.push_back(MINode());
+    if (-1 == lastChild) rec.nodes[parent].firstChild = child;
+    else rec.nodes[lastChild].nextSibling = child;
+    rec.nodes[parent].nChildren++;
+    lastChild = child;
+    return child;
+}
+
+/**
+ * result ==> variable "=" value
+ */
+int
+MIParser::mParseResult(
+    const std::string &line,
+    size_t &pos,
+    MIRecord &rec,
+    int parent,
+    int &lastChild
+) {
+    const size_t eq = line.find('=', pos);
+    if (std::string::npos == eq) return GLADIUS_ERR;
+    const int child = mAddChild(rec, parent, lastChild);
+    rec.nodes[child].name.assign(line, pos, eq - pos);
+    pos = eq + 1;
+    return mParseValue(line, pos, rec, child);
+}
+
+/**
+ * value ==> const | tuple | list
+ */
+int
+MIParser::mParseValue(
+    const std::string &line,
+    size_t &pos,
+    MIRecord &rec,
+    int node
+) {
+    const size_t len = line.size();
+    if (pos >= len) return GLADIUS_ERR;
+    //
+    const char open = line[pos];
+    if ('"' == open) {
+        rec.nodes[node].type = MINode::CONST;
+        std::string value;
+        int rc = mParseCString(line, pos, value);
+        // Note: rec.nodes may have been resized, so index again.
+        rec.nodes[node].value.swap(value);
+        return rc;
+    }
+    if ('{' != open && '[' != open) return GLADIUS_ERR;
+    //
+    const char close = ('{' == open) ? '}' : ']';
+    rec.nodes[node].type = ('{' == open) ? MINode::TUPLE : MINode::LIST;
+    ++pos;
+    int lastChild = -1;
+    if (pos < len && close == line[pos]) {
+        ++pos;
+        return GLADIUS_SUCCESS;
+    }
+    do {
+        if (pos >= len) return GLADIUS_ERR;
+        int rc = GLADIUS_SUCCESS;
+        const char c = line[pos];
+        // Lists may hold plain values; tuples only hold results.
+        if (MINode::LIST == rec.nodes[node].type
+            && ('"' == c || '{' == c || '[' == c)) {
+            const int child = mAddChild(rec, node, lastChild);
+            rc = mParseValue(line, pos, rec, child);
+        }
+        else {
+            rc = mParseResult(line, pos, rec, node, lastChild);
+        }
+        if (GLADIUS_SUCCESS != rc) return rc;
+        if (pos >= len) return GLADIUS_ERR;
+        if (close == line[pos]) {
+            ++pos;
+            return GLADIUS_SUCCESS;
+        }
+        if (',' != line[pos]) return GLADIUS_ERR;
+        ++pos;
+    } while (true);
+}
+
+/**
+ * Parses and unescapes a C string starting at pos (which must be at the
+ * opening quote).
+ */
+int
+MIParser::mParseCString(
+    const std::string &line,
+    size_t &pos,
+    std::string &out
+) {
+    const size_t len = line.size();
+    if (pos >= len || '"' != line[pos]) return GLADIUS_ERR;
+    ++pos;
+    out.clear();
+    while (pos < len) {
+        // Copy runs of plain characters in one go.
+        const size_t runStart = pos;
+        while (pos < len && '"' != line[pos] && '\\' != line[pos]) ++pos;
+        out.append(line, runStart, pos - runStart);
+        if (pos >= len) break;
+        if ('"' == line[pos]) {
+            ++pos;
+            return GLADIUS_SUCCESS;
+        }
+        // Escape sequence.
+        if (++pos >= len) break;
+        const char e = line[pos++];
+        switch (e) {
+            case 'n': out.push_back('\n'); break;
+            case 't': out.push_back('\t'); break;
+            case 'r': out.push_back('\r'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'v': out.push_back('\v'); break;
+            case 'a': out.push_back('\a'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'e': out.push_back('\033'); break;
+            default:
+                // Octal escape.
+                if (e >= '0' && e <= '7') {
+                    int v = e - '0';
+                    for (int i = 0; i < 2 && pos < len
+                         && line[pos] >= '0' && line[pos] <= '7'; ++i) {
+                        v = (v * 8) + (line[pos++] - '0');
+                    }
+                    out.push_back(char(v));
+                }
+                // \" \\ and friends.
+                else {
+                    out.push_back(e);
+                }
+        }
+    }
+    // Unterminated string.
+    return GLADIUS_ERR;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * GDB/MI output records and an incremental (line at a time) parser for them.
+ * See "GDB/MI Output Syntax" in the GDB manual for the grammar.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gladius {
+namespace dmi {
+
+/**
+ * Command token type. Tokens are used to match commands to result records.
+ */
+typedef int64_t MIToken;
+
+/**
+ * Constant that means "no token."
+ */
+const MIToken noMIToken = -1;
+
+/**
+ * A node in a parsed MI value tree. Nodes live in a flat array owned by their
+ * MIRecord and are linked by index, so parsing large tuples never copies
+ * subtrees.
+ */
+struct MINode {
+    //
+    enum Type {
+        CONST, /* c-string  */
+        TUPLE, /* {...}     */
+        LIST   /* [...]     */
+    };
+    //
+    Type type = CONST;
+    // Variable name. Empty for list elements that are plain values.
+    std::string name;
+    // Unescaped value. Only meaningful for CONST nodes.
+    std::string value;
+    // Index of first child, or -1.
+    int firstChild = -1;
+    // Index of next sibling, or -1.
+    int nextSibling = -1;
+    // Number of children.
+    size_t nChildren = 0;
+};
+
+/**
+ * A single GDB/MI output record.
+ */
+struct MIRecord {
+    //
+    enum Kind {
+        RESULT,         /* ^ */
+        EXEC_ASYNC,     /* * */
+        STATUS_ASYNC,   /* + */
+        NOTIFY_ASYNC,   /* = */
+        CONSOLE_STREAM, /* ~ */
+        TARGET_STREAM,  /* @ */
+        LOG_STREAM,     /* & */
+        PROMPT,         /* (gdb) */
+        UNKNOWN
+    };
+    //
+    Kind kind = UNKNOWN;
+    // The token that prefixed the record, if any.
+    MIToken token = noMIToken;
+    // Result or async class, e.g. done, error, stopped, thread-created.
+    std::string klass;
+    // Unescaped text of a stream record.
+    std::string text;
+    // Console stream output that preceded this result record (set by DMI).
+    std::string console;
+    // The record's results. Node 0 is always the root tuple.
+    std::vector<MINode> nodes;
+
+    /**
+     *
+     */
+    MIRecord(void) {
+        clear();
+    }
+
+    /**
+     * Resets the record for reuse. Keeps allocated capacity.
+     */
+    void
+    clear(void) {
+        kind = UNKNOWN;
+        token = noMIToken;
+        klass.clear();
+        text.clear();
+        console.clear();
+        nodes.clear();
+        nodes.push_back(MINode());
+        nodes[0].type = MINode::TUPLE;
+    }
+
+    /**
+     * Returns whether or not this is an asynchronous record.
+     */
+    bool
+    isAsync(void) const {
+        return EXEC_ASYNC == kind
+            || STATUS_ASYNC == kind
+            || NOTIFY_ASYNC == kind;
+    }
+
+    /**
+     * Returns whether or not this is a stream record.
+     */
+    bool
+    isStream(void) const {
+        return CONSOLE_STREAM == kind
+            || TARGET_STREAM == kind
+            || LOG_STREAM == kind;
+    }
+
+    /**
+     * Returns the index of the root results tuple.
+     */
+    int
+    root(void) const {
+        return 0;
+    }
+    //
+    int
+    find(
+        const std::string &name,
+        int parent = 0
+    ) const;
+    //
+    int
+    findPath(
+        const std::string &path,
+        int parent = 0
+    ) const;
+    //
+    std::string
+    valueOf(
+        const std::string &path,
+        int parent = 0
+    ) const;
+};
+
+/**
+ * Parses GDB/MI output one line at a time.
+ */
+class MIParser {
+private:
+    //
+    int
+    mParseResult(
+        const std::string &line,
+        size_t &pos,
+        MIRecord &rec,
+        int parent,
+        int &lastChild
+    );
+    //
+    int
+    mParseValue(
+        const std::string &line,
+        size_t &pos,
+        MIRecord &rec,
+        int node
+    );
+    //
+    int
+    mParseCString(
+        const std::string &line,
+        size_t &pos,
+        std::string &out
+    );
+    //
+    int
+    mAddChild(
+        MIRecord &rec,
+        int parent,
+        int &lastChild
+    );
+
+public:
+    //
+    MIParser(void) = default;
+    //
+    ~MIParser(void) = default;
+    //
+    int
+    parseLine(
+        const std::string &line,
+        MIRecord &rec
+    );
+};
+
+} // end dmi namespace
+} // end gladius namespace
@@ -19,11 +19,14 @@
 
 #include "pty/pty.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <signal.h>
 #include <sys/types.h>
@@ -52,9 +55,9 @@ do {                                                                           \
 } // end namespace
 
 /**
- * The initial size of the output buffer. 16k should be plenty.
+ * The initial size of the output buffer. Grows as needed for large responses.
  */
-const size_t DMI::sInitBufSize = 1024 * 16;
+const size_t DMI::sInitBufSize = 1024 * 64;
 
 /**
  *
@@ -64,10 +67,7 @@ const std::string DMI::sPromptString = "(gdb) ";
 /**
  *
  */
-DMI::DMI(void)
-{
-    mCurLineBufSize = sInitBufSize;
-}
+DMI::DMI(void) { ; }
 
 /**
  *
@@ -75,15 +75,19 @@ DMI::DMI(void)
 DMI::~DMI(void)
 {
     using namespace std;
+    // Never started.
+    if (mGDBPID <= 0) return;
     // Wait for GDB (child)
     pid_t w;
     int status;
     do {
         w = waitpid(mGDBPID, &status, WUNTRACED | WCONTINUED);
         if (w == -1) {
+            // Can't throw from here, so just say what happened.
             int err = errno;
             auto errs = core::utils::getStrError(err);
-            GLADIUS_THROW("pipe(2): " + errs);
+            GLADIUS_CERR << "waitpid(2): " << errs << endl;
+            break;
         }
         if (WIFEXITED(status)) {
             VCOMP_COUT("GDB Exited Status: " << WEXITSTATUS(status) << endl);
@@ -98,14 +102,10 @@ DMI::~DMI(void)
             VCOMP_COUT("GDB Continued..." << endl);
         }
     } while (!WIFEXITED(status) && !WIFSIGNALED(status));
-    // Other cleanup.
-    fclose(mTo);
-    fclose(mFrom);
+    // Other cleanup. Closes mToGDB[1], too.
+    if (mTo) fclose(mTo);
     //
-    close(mToGDB[1]);
     close(mFromGDB[0]);
-    //
-    if (mFromGDBLineBuf) free(mFromGDBLineBuf);
 }
 
 /**
@@ -114,6 +114,25 @@ DMI::~DMI(void)
 void
 DMI::init(
     bool beVerbose
+) {
+    start(beVerbose);
+    //
+    if (GLADIUS_SUCCESS != mWaitForPrompt()) {
+        GLADIUS_THROW("GDB exited before presenting its prompt.");
+    }
+    //
+    assert(mFromGDBLine == sPromptString);
+    //
+    VCOMP_COUT("Done Initializing the DMI..." << std::endl);
+}
+
+/**
+ * Starts GDB, but does not wait for its prompt. GDB reads its input once it is
+ * ready, so MI commands may be sent right away.
+ */
+void
+DMI::start(
+    bool beVerbose
 ) {
     mBeVerbose = beVerbose;
     //
@@ -127,16 +146,12 @@ DMI::init(
             " Please fix this and try again."
         );
     }
-    // Allocate initial string buffer.
-    mFromGDBLineBuf = (char *)calloc(mCurLineBufSize, sizeof(*mFromGDBLineBuf));
-    if (!mFromGDBLineBuf) GLADIUS_THROW_OOR();
-    //
-    if (-1 == pipe(mToGDB) || -1 == pipe(mFromGDB)) {
+    // Close-on-exec, so GDBs started after us do not hold our pipes open.
+    if (-1 == pipe2(mToGDB, O_CLOEXEC) || -1 == pipe2(mFromGDB, O_CLOEXEC)) {
         int err = errno;
         auto errs = core::utils::getStrError(err);
-        GLADIUS_THROW("pipe(2): " + errs);
+        GLADIUS_THROW("pipe2(2): " + errs);
     }
-    // TODO set O_NONBLOCK?
     // Create new process for GDB.
     mGDBPID = fork();
     ////////////////////////////////////////////////////////////////////////////
@@ -178,69 +193,50 @@ DMI::init(
     // Close unused.
     close(mToGDB[0]);
     close(mFromGDB[1]);
-    // TODO add error checks
     mTo = fdopen(mToGDB[1], "w");
-    // TODO not sure this is needed.
-    mFrom = fdopen(mFromGDB[0], "r");
-    //
-    mWaitForPrompt();
-    //
-    assert(std::string(mFromGDBLineBuf) == sPromptString);
+    if (!mTo) {
+        int err = errno;
+        auto errs = core::utils::getStrError(err);
+        GLADIUS_THROW("fdopen(3): " + errs);
+    }
     //
-    VCOMP_COUT("Done Initializing the DMI..." << std::endl);
+    if (GLADIUS_SUCCESS != mFromGDBReader.init(mFromGDB[0], sInitBufSize)) {
+        GLADIUS_THROW_CALL_FAILED("LineReader::init");
+    }
 }
 
 /**
  *
  */
-void
+int
 DMI::mWaitForPrompt(void)
 {
-    while (0 != strcmp(mFromGDBLineBuf, sPromptString.c_str())) {
-        mGetGDBRespLine();
-    }
+    int rc = GLADIUS_SUCCESS;
+    do {
+        if (GLADIUS_SUCCESS != (rc = mGetGDBRespLine())) return rc;
+    } while (mFromGDBLine != sPromptString);
+    //
+    return GLADIUS_SUCCESS;
 }
 
 /**
- *
+ * Reads the next line of GDB output into mFromGDBLine.
  */
-size_t
-DMI::mGetGDBRespLine(void)
+int
+DMI::mGetGDBRespLine(int timeoutInMS)
 {
-    char charBuf = '\0';
-    size_t nRead = 0;
-    while (1 == read(mFromGDB[0], &charBuf, 1)) {
-        // Need more memory.
-        if (nRead == mCurLineBufSize) {
-            // Double the size.
-            mCurLineBufSize *= 2;
-            mFromGDBLineBuf = (char *)realloc(mFromGDBLineBuf, mCurLineBufSize);
-            if (!mFromGDBLineBuf) GLADIUS_THROW_OOR();
-        }
-        mFromGDBLineBuf[nRead] = charBuf;
-        if (charBuf == '\n') {
-            // Don't forget to update nRead before we break.
-            mFromGDBLineBuf[nRead++] = '\0';
-            break;
-        }
-        ++nRead;
-    }
-    return nRead;
+    return mFromGDBReader.readLine(mFromGDBLine, timeoutInMS);
 }
 
 /**
- *
+ * Reads GDB output up to and including the next prompt.
  */
-std::string
-DMI::mDrainToString(void)
-{
-    std::string result = "";
-    do {
-        mGetGDBRespLine();
-        result += std::string(mFromGDBLineBuf) + "\n";
-    } while (0 != strcmp(mFromGDBLineBuf, sPromptString.c_str()));
-
-    return result;
+int
+DMI::mDrainToString(
+    std::string &result
+) {
+    static const bool includePrompt = true;
+    return mFromGDBReader.readUntilLine(sPromptString, result, includePrompt);
 }
 
 /**
@@ -284,6 +280,181 @@ int
 DMI::recvResp(
     std::string &outputIfSuccess
 ) {
-    outputIfSuccess = mDrainToString();
+    return mDrainToString(outputIfSuccess);
+}
+
+/**
+ * Sends an MI command prefixed with a fresh token and returns that token
+ * without waiting for the result. Any number of commands may be outstanding;
+ * use recvMIResult to collect their results in any order. Returns noMIToken on
+ * failure.
+ *
+ * NOTE: do not interleave with recvResp, which consumes raw output.
+ */
+MIToken
+DMI::sendMICommand(
+    const std::string &miCMD
+) {
+    const MIToken token = mNextToken++;
+    const std::string toPut = std::to_string(token) + miCMD + "\n";
+    if (EOF == fputs(toPut.c_str(), mTo) || 0 != fflush(mTo)) {
+        return noMIToken;
+    }
+    mInFlight.push_back(token);
+    return token;
+}
+
+/**
+ * Sends a batch of MI commands with a single write, so GDB sees all of them
+ * before it acts on the first. This matters when the commands stop the process
+ * that is sending them (e.g. attaching to ourselves). tokens[i] is the token
+ * that was given to miCMDs[i].
+ */
+int
+DMI::sendMICommands(
+    const std::vector<std::string> &miCMDs,
+    std::vector<MIToken> &tokens
+) {
+    tokens.clear();
+    std::string toPut;
+    for (const auto &cmd : miCMDs) {
+        const MIToken token = mNextToken++;
+        tokens.push_back(token);
+        toPut += std::to_string(token) + cmd + "\n";
+    }
+    if (EOF == fputs(toPut.c_str(), mTo) || 0 != fflush(mTo)) {
+        return GLADIUS_ERR_IO;
+    }
+    mInFlight.insert(mInFlight.end(), tokens.begin(), tokens.end());
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Reads and dispatches a single MI output record.
+ */
+int
+DMI::mProcessNextRecord(int timeoutInMS)
+{
+    using namespace std;
+    //
+    int rc = mGetGDBRespLine(timeoutInMS);
+    if (GLADIUS_SUCCESS != rc) return rc;
+    //
+    MIRecord rec;
+    if (GLADIUS_SUCCESS != mMIParser.parseLine(mFromGDBLine, rec)) {
+        VCOMP_COUT("Ignoring malformed MI output: " << mFromGDBLine << endl);
+        return GLADIUS_SUCCESS;
+    }
+    switch (rec.kind) {
+        case MIRecord::RESULT: {
+            const MIToken token = rec.token;
+            // Hand over the console output of the command that this answers.
+            auto found = mConsoleOutputs.find(token);
+            if (found != mConsoleOutputs.end()) {
+                rec.console.swap(found->second);
+                mConsoleOutputs.erase(found);
+            }
+            // GDB is done with this command (and the ones sent before it).
+            auto done = std::find(mInFlight.begin(), mInFlight.end(), token);
+            if (done != mInFlight.end()) {
+                mInFlight.erase(mInFlight.begin(), done + 1);
+            }
+            mPendingResults[token] = std::move(rec);
+            break;
+        }
+        case MIRecord::EXEC_ASYNC:
+        case MIRecord::STATUS_ASYNC:
+        case MIRecord::NOTIFY_ASYNC:
+            mAsyncRecords.push_back(std::move(rec));
+            break;
+        case MIRecord::CONSOLE_STREAM:
+            // Output that no command is waiting on (e.g. from a running
+            // target) is only shown.
+            if (mInFlight.empty()) {
+                VCOMP_COUT("GDB: " << rec.text);
+            }
+            else {
+                mConsoleOutputs[mInFlight.front()] += rec.text;
+            }
+            break;
+        case MIRecord::TARGET_STREAM:
+        case MIRecord::LOG_STREAM:
+            VCOMP_COUT("GDB: " << rec.text);
+            break;
+        default:
+            break;
+    }
     return GLADIUS_SUCCESS;
 }
+
+/**
+ * Waits for the result record that matches token. Asynchronous records seen in
+ * the meantime are queued (see popAsyncRecord) and results for other tokens are
+ * kept until they are asked for. timeoutInMS of -1 means wait forever.
+ */
+int
+DMI::recvMIResult(
+    MIToken token,
+    MIRecord &result,
+    int timeoutInMS
+) {
+    using namespace std::chrono;
+    //
+    const auto deadline = steady_clock::now() + milliseconds(timeoutInMS);
+    do {
+        if (popMIResult(token, result)) return GLADIUS_SUCCESS;
+        int left = -1;
+        if (timeoutInMS >= 0) {
+            left = duration_cast<milliseconds>(
+                       deadline - steady_clock::now()
+                   ).count();
+            if (left < 0) left = 0;
+        }
+        int rc = mProcessNextRecord(left);
+        if (GLADIUS_SUCCESS != rc) return rc;
+    } while (true);
+}
+
+/**
+ * Convenience routine that sends an MI command and waits for its result.
+ */
+int
+DMI::execMICommand(
+    const std::string &miCMD,
+    MIRecord &result,
+    int timeoutInMS
+) {
+    const MIToken token = sendMICommand(miCMD);
+    if (noMIToken == token) return GLADIUS_ERR_IO;
+    return recvMIResult(token, result, timeoutInMS);
+}
+
+/**
+ * Pops the oldest unconsumed asynchronous record (e.g. *stopped,
+ * =thread-created). Returns false if there are none.
+ */
+bool
+DMI::popAsyncRecord(
+    MIRecord &record
+) {
+    if (mAsyncRecords.empty()) return false;
+    record = std::move(mAsyncRecords.front());
+    mAsyncRecords.pop_front();
+    return true;
+}
+
+/**
+ * Non-blocking version of recvMIResult. Returns false if the result for token
+ * has not arrived yet.
+ */
+bool
+DMI::popMIResult(
+    MIToken token,
+    MIRecord &result
+) {
+    auto found = mPendingResults.find(token);
+    if (found == mPendingResults.end()) return false;
+    result = std::move(found->second);
+    mPendingResults.erase(found);
+    return true;
+}
@@ -12,7 +12,13 @@
 
 #pragma once
 
+#include "core/line-reader.h"
+#include "pty/mi-parser.h"
+
 #include <string>
+#include <map>
+#include <deque>
+#include <vector>
 
 #include <unistd.h>
 
@@ -28,8 +34,6 @@ private:
     //
     static const size_t sInitBufSize;
     //
-    size_t mCurLineBufSize = 0;
-    //
     bool mBeVerbose = false;
     //
     std::string mPathToGDB;
@@ -39,23 +43,41 @@ private:
     int mFromGDB[2];
     // PID of GDB process.
     pid_t mGDBPID = 0;
-    //
-    char *mFromGDBLineBuf = nullptr;
+    // Buffered reader for GDB's output.
+    core::LineReader mFromGDBReader;
+    // The last line read from GDB (without its newline).
+    std::string mFromGDBLine;
     //
     pid_t mTargetPID = 0;
     //
     FILE *mTo = nullptr;
+    // Parser for GDB's MI output.
+    MIParser mMIParser;
+    // The token that will be given to the next MI command.
+    MIToken mNextToken = 1;
+    // Result records that have arrived, but not yet been asked for.
+    std::map<MIToken, MIRecord> mPendingResults;
+    // Asynchronous records that have not yet been consumed.
+    std::deque<MIRecord> mAsyncRecords;
+    // Tokens of the MI commands that have no result yet, in the order sent.
+    // GDB runs commands in order, so console output is the first one's.
+    std::deque<MIToken> mInFlight;
+    // Console stream output of the commands in mInFlight, by token.
+    std::map<MIToken, std::string> mConsoleOutputs;
     //
-    FILE *mFrom = nullptr;
-    //
-    size_t
-    mGetGDBRespLine(void);
+    int
+    mGetGDBRespLine(int timeoutInMS = -1);
     //
-    void
+    int
     mWaitForPrompt(void);
     //
-    std::string
-    mDrainToString(void);
+    int
+    mDrainToString(
+        std::string &result
+    );
+    //
+    int
+    mProcessNextRecord(int timeoutInMS);
 
 public:
     //
@@ -69,6 +91,11 @@ public:
     );
     //
     void
+    start(
+        bool beVerbose
+    );
+    //
+    void
     attach(pid_t targetPID);
     //
     int
@@ -80,10 +107,60 @@ public:
     recvResp(
         std::string &outputIfSuccess
     );
+    //
+    MIToken
+    sendMICommand(
+        const std::string &miCMD
+    );
+    //
+    int
+    sendMICommands(
+        const std::vector<std::string> &miCMDs,
+        std::vector<MIToken> &tokens
+    );
+    //
+    int
+    recvMIResult(
+        MIToken token,
+        MIRecord &result,
+        int timeoutInMS = -1
+    );
+    //
+    int
+    execMICommand(
+        const std::string &miCMD,
+        MIRecord &result,
+        int timeoutInMS = -1
+    );
+    //
+    bool
+    popAsyncRecord(
+        MIRecord &record
+    );
+    //
+    bool
+    popMIResult(
+        MIToken token,
+        MIRecord &result
+    );
+
+    /**
+     * Returns the PID of our GDB process.
+     */
+    pid_t
+    gdbPID(void) const {
+        return mGDBPID;
+    }
+
+    /**
+     * Returns the number of asynchronous records waiting to be consumed.
+     */
+    size_t
+    nAsyncRecords(void) const {
+        return mAsyncRecords.size();
+    }
 };
 
 
 } // end dmi namespace
 } // end gladius namespace
-
-#endif
@@ -28,6 +28,7 @@ GraphWidget::GraphWidget(
     QWidget *parent
 ) : QGraphicsView(parent)
   , mScene(new QGraphicsScene(this))
+  , mColorPalette(ColorPaletteFactory::getColorAlphabet2())
 {
     setOptimizationFlags(QGraphicsView::DontSavePainterState);
     setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
@@ -55,31 +56,53 @@ GraphWidget::addProcTimeline(
 ) {
     if (!mProcTimelines.contains(procDesc.procID)) {
         ProcTimeline *tl = new ProcTimeline(procDesc, this);
+        tl->setTaskColorPalette(mColorPalette);
         mProcTimelines.insert(procDesc.procID, tl);
         mScene->addItem(tl);
         updateProcTimelineLayout();
     }
 }
 
+ProcTimeline *
+GraphWidget::mGetProcTimeline(
+    procid_t procID
+) {
+    // Tasks can show up before their processor does (or without one).
+    if (!mProcTimelines.contains(procID)) {
+        addProcTimeline(ProcDesc(procID, ProcType::UNKNOWN));
+    }
+    return mProcTimelines.value(procID);
+}
+
+void
+GraphWidget::mAddTask(
+    const TaskInfo &info
+) {
+    if (!mHaveTaskTimes) {
+        mMinStartTime = info.uStartTime;
+        mMaxStopTime = info.uStopTime;
+        mHaveTaskTimes = true;
+    }
+    mMinStartTime = qMin(mMinStartTime, info.uStartTime);
+    mMaxStopTime = qMax(mMaxStopTime, info.uStopTime);
+    //
+    mGetProcTimeline(info.procID)->addTask(info);
+}
+
 void
 GraphWidget::addPlotData(
     const LegionProfData &plotData
 ) {
-    QList<QColor> colorPalette = ColorPaletteFactory::getColorAlphabet2();
     // Create the proc timelines.
     for (const auto &procDesc : plotData.procDescs) {
         addProcTimeline(procDesc);
     }
-    // Set their color palette.
-    foreach (ProcTimeline *timeline, mProcTimelines) {
-        timeline->setTaskColorPalette(colorPalette);
-    }
     // Populate them...
     for (const auto &taskInfo : plotData.taskInfos) {
-        mProcTimelines[taskInfo.procID]->addTask(taskInfo);
+        mAddTask(taskInfo);
     }
     for (const auto &metaInfo: plotData.metaInfos) {
-        mProcTimelines[metaInfo.procID]->addTask(metaInfo);
+        mAddTask(metaInfo);
     }
     //
 #if 0 // For debugging time interval data.
@@ -110,3 +133,22 @@ GraphWidget::updateProcTimelineLayout(void)
         y += procTimeline->boundingRect().height() + spacing;
     }
 }
+
+QString
+GraphWidget::getUtilizationReport(void) const
+{
+    const ustime_t window = mMaxStopTime - mMinStartTime;
+    const QString us = ' ' + QChar(0x03BC) + 's';
+    QString report = "Processor Utilization Over "
+                   + QString::number(window) + us + "\n\n";
+    foreach (const ProcTimeline *procTimeline, mProcTimelines) {
+        const auto &procDesc = procTimeline->getProcDesc();
+        const ustime_t busy = procTimeline->getBusyTime();
+        const double percent = window ? (100.0 * busy) / window : 0.0;
+        report += Common::procType2QString(procDesc.kind) + ' '
+                + QString("%1").arg(procDesc.procID, 6, 10, QChar('0'))
+                + ": " + QString::number(percent, 'f', 1) + "% ("
+                + QString::number(procTimeline->getNumTasks()) + " Tasks)\n";
+    }
+    return report;
+}
@@ -12,8 +12,11 @@
 #include "common.h"
 #include "info-types.h"
 
+#include <QColor>
 #include <QGraphicsView>
+#include <QList>
 #include <QMap>
+#include <QString>
 
 QT_BEGIN_NAMESPACE
 class QWidget;
@@ -31,16 +34,33 @@ public:
     void addProcTimeline(const ProcDesc &procDesc);
     //
     void plot(void);
-    //
+    // Adds to what is already plotted, so can be called with each new batch
+    // of live data.
     void addPlotData(const LegionProfData &plotData);
     //
     void updateProcTimelineLayout(void);
+    // Per-processor utilization over the time that we have seen.
+    QString getUtilizationReport(void) const;
 
 private:
     //
     QGraphicsScene *mScene = nullptr;
     //
     QMap<procid_t, ProcTimeline *> mProcTimelines;
+    //
+    QList<QColor> mColorPalette;
+    // The time that we have seen, over all tasks.
+    bool mHaveTaskTimes = false;
+    //
+    ustime_t mMinStartTime = 0;
+    //
+    ustime_t mMaxStopTime = 0;
+    //
+    ProcTimeline *
+    mGetProcTimeline(procid_t procID);
+    //
+    void
+    mAddTask(const TaskInfo &info);
 };
 
 #endif // TIMELINE_GRAPHWIDGET_H
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+#include "common.h"
+#include "legion-prof-live-source.h"
+
+#include <QByteArray>
+#include <QDebug>
+#include <QString>
+#include <QTcpSocket>
+#include <QTimer>
+
+LegionProfLiveSource::LegionProfLiveSource(
+    const QString &host,
+    quint16 port,
+    QObject *parent
+) : QObject(parent)
+  , mHost(host)
+  , mPort(port)
+  , mSocket(new QTcpSocket(this))
+  , mBatchTimer(new QTimer(this))
+  , mPending(new LegionProfData())
+{
+    connect(mSocket, SIGNAL(connected()), this, SLOT(mOnConnected()));
+    connect(mSocket, SIGNAL(readyRead()), this, SLOT(mOnReadyRead()));
+    connect(mSocket, SIGNAL(disconnected()), this, SLOT(mOnDisconnected()));
+    connect(
+        mSocket,
+        SIGNAL(error(QAbstractSocket::SocketError)),
+        this,
+        SLOT(mOnError(QAbstractSocket::SocketError))
+    );
+    //
+    mBatchTimer->setInterval(sBatchPeriodInMS);
+    connect(mBatchTimer, SIGNAL(timeout()), this, SLOT(mOnBatchTimeout()));
+}
+
+LegionProfLiveSource::~LegionProfLiveSource(void)
+{
+    if (mPending) {
+        delete mPending;
+        mPending = nullptr;
+    }
+}
+
+bool
+LegionProfLiveSource::parseAddress(
+    const QString &address,
+    QString &host,
+    quint16 &port
+) {
+    const int colon = address.lastIndexOf(':');
+    if (colon <= 0) return false;
+    bool ok = false;
+    const uint p = address.mid(colon + 1).toUInt(&ok);
+    if (!ok || 0 == p || p > 65535) return false;
+    host = address.left(colon);
+    port = quint16(p);
+    return true;
+}
+
+void
+LegionProfLiveSource::start(void)
+{
+    mBatchTimer->start();
+    mConnect();
+}
+
+LegionProfData *
+LegionProfLiveSource::takeBatch(void)
+{
+    if (!mHavePending()) return nullptr;
+    LegionProfData *batch = mPending;
+    mNTaskInfos += batch->taskInfos.size();
+    mPending = new LegionProfData();
+    return batch;
+}
+
+void
+LegionProfLiveSource::mConnect(void)
+{
+    mReconnectPending = false;
+    emit sigStatusChange(
+        StatusKind::INFO, "Connecting to " + getAddress()
+    );
+    mSocket->connectToHost(mHost, mPort, QIODevice::ReadOnly);
+}
+
+void
+LegionProfLiveSource::mOnConnected(void)
+{
+    emit sigStatusChange(StatusKind::INFO, "Live: " + getAddress());
+}
+
+void
+LegionProfLiveSource::mOnReadyRead(void)
+{
+    while (mSocket->canReadLine()) {
+        const QString line(mSocket->readLine());
+        (void)mLineParser.parse(line, *mPending);
+    }
+}
+
+void
+LegionProfLiveSource::mOnDisconnected(void)
+{
+    // Whatever was left is still good.
+    mOnReadyRead();
+    emit sigStatusChange(
+        StatusKind::WARN, getAddress() + " Went Away (Retrying)"
+    );
+    mScheduleReconnect();
+}
+
+void
+LegionProfLiveSource::mOnError(
+    QAbstractSocket::SocketError error
+) {
+    // Handled by mOnDisconnected.
+    if (QAbstractSocket::RemoteHostClosedError == error) return;
+    const QString errs = mSocket->errorString();
+    mSocket->abort();
+    emit sigStatusChange(
+        StatusKind::WARN, getAddress() + ": " + errs + " (Retrying)"
+    );
+    mScheduleReconnect();
+}
+
+void
+LegionProfLiveSource::mOnBatchTimeout(void)
+{
+    if (mHavePending()) emit sigBatchReady();
+}
+
+bool
+LegionProfLiveSource::mHavePending(void) const
+{
+    return !mPending->procDescs.empty()
+        || !mPending->taskKinds.empty()
+        || !mPending->taskInfos.empty()
+        || !mPending->metaInfos.empty()
+        || !mPending->metaDescs.empty();
+}
+
+void
+LegionProfLiveSource::mScheduleReconnect(void)
+{
+    if (mReconnectPending) return;
+    mReconnectPending = true;
+    QTimer::singleShot(sReconnectDelayInMS, this, SLOT(mConnect()));
+}
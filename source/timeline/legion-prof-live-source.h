@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+#ifndef TIMELINE_LEGION_PROF_LIVE_SOURCE_H
+#define TIMELINE_LEGION_PROF_LIVE_SOURCE_H
+
+#include "common.h"
+#include "info-types.h"
+#include "legion-prof-log-parser.h"
+
+#include <QObject>
+#include <QAbstractSocket>
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QTcpSocket;
+class QTimer;
+QT_END_NAMESPACE
+
+/**
+ * Legion prof records from a running job, as served by the Gladius lprof
+ * plugin (Legion prof log lines over TCP). What arrives is handed out in
+ * batches, so that views can update incrementally without redrawing per
+ * record. Reconnects until told otherwise, so the viewer can be started
+ * before the job.
+ */
+class LegionProfLiveSource : public QObject {
+    Q_OBJECT
+
+public:
+    //
+    LegionProfLiveSource(
+        const QString &host,
+        quint16 port,
+        QObject *parent = nullptr
+    );
+    //
+    ~LegionProfLiveSource(void);
+    // No copy constructor.
+    LegionProfLiveSource(const LegionProfLiveSource&) = delete;
+    // No assignment.
+    LegionProfLiveSource& operator=(const LegionProfLiveSource&) = delete;
+    // Splits "HOST:PORT". Returns whether or not address was well-formed.
+    static bool
+    parseAddress(
+        const QString &address,
+        QString &host,
+        quint16 &port
+    );
+    //
+    QString
+    getAddress(void) const {
+        return mHost + ":" + QString::number(mPort);
+    }
+    // Returns what arrived since the last call, or nullptr if nothing did.
+    // The caller owns what is returned.
+    LegionProfData *
+    takeBatch(void);
+    //
+    quint64
+    nTaskInfos(void) const { return mNTaskInfos; }
+
+public slots:
+    //
+    void start(void);
+
+signals:
+    // A batch is waiting (see takeBatch).
+    void sigBatchReady(void);
+    //
+    void sigStatusChange(StatusKind kind, QString status);
+
+private slots:
+    //
+    void mConnect(void);
+    //
+    void mOnConnected(void);
+    //
+    void mOnReadyRead(void);
+    //
+    void mOnDisconnected(void);
+    //
+    void mOnError(QAbstractSocket::SocketError error);
+    //
+    void mOnBatchTimeout(void);
+
+private:
+    // How often batches are handed out, in milliseconds.
+    static constexpr int sBatchPeriodInMS = 250;
+    // How long we wait before reconnecting, in milliseconds.
+    static constexpr int sReconnectDelayInMS = 2000;
+    //
+    QString mHost;
+    //
+    quint16 mPort = 0;
+    //
+    QTcpSocket *mSocket = nullptr;
+    //
+    QTimer *mBatchTimer = nullptr;
+    //
+    LegionProfLineParser mLineParser;
+    // What arrived since the last batch.
+    LegionProfData *mPending = nullptr;
+    //
+    quint64 mNTaskInfos = 0;
+    //
+    bool mReconnectPending = false;
+    //
+    bool
+    mHavePending(void) const;
+    //
+    void
+    mScheduleReconnect(void);
+};
+
+#endif // TIMELINE_LEGION_PROF_LIVE_SOURCE_H
@@ -18,34 +18,92 @@
 
 #include <deque>
 
-namespace {
-//
-QRegExp gTaskInfoRx(
-    "Prof Task Info ([0-9]+) ([0-9]+) "
-    "([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+)"
-);
-
-QRegExp gMetaInfoRx(
-    "Prof Meta Info ([0-9]+) ([0-9]+) "
-    "([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+)"
-);
-
-// TODO (???) (???)
-QRegExp gProcDescRx(
-    "Prof Proc Desc ([0-9]+) ([0-9]+)"
-);
-
-// (Task ID) (Task Name)
-QRegExp gTaskKindRx(
-    "Prof Task Kind ([0-9]+) ([a-zA-Z0-9_]+)"
-);
-
-// (Operation ID) (Operation Name)
-QRegExp gMetaDescRx(
-    "Prof Meta Desc ([0-9]+) ([a-zA-Z0-9_]+)"
-);
+LegionProfLineParser::LegionProfLineParser(
+    void
+) : mTaskInfoRx(
+        "Prof Task Info ([0-9]+) ([0-9]+) "
+        "([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+)"
+    )
+  , mMetaInfoRx(
+        "Prof Meta Info ([0-9]+) ([0-9]+) "
+        "([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+)"
+    )
+    // TODO (???) (???)
+  , mProcDescRx(
+        "Prof Proc Desc ([0-9]+) ([0-9]+)"
+    )
+    // (Task ID) (Task Name)
+  , mTaskKindRx(
+        "Prof Task Kind ([0-9]+) ([a-zA-Z0-9_]+)"
+    )
+    // (Operation ID) (Operation Name)
+  , mMetaDescRx(
+        "Prof Meta Desc ([0-9]+) ([a-zA-Z0-9_]+)"
+    ) { }
 
-} // end namespace
+bool
+LegionProfLineParser::parse(
+    const QString &line,
+    LegionProfData &profData
+) {
+    if (mTaskKindRx.indexIn(line) != -1) {
+        const taskid_t tid = mTaskKindRx.cap(1).toUInt();
+        const std::string tname = mTaskKindRx.cap(2).toStdString();
+        if (!profData.taskKinds.count(tid)) {
+            profData.taskKinds.insert(
+                std::make_pair(tid, new TaskKind(tid, tname))
+            );
+        }
+        return true;
+    }
+    // Timing data coming in as nanoseconds.
+    if (mTaskInfoRx.indexIn(line) != -1) {
+        profData.taskInfos.push_back(
+            TaskInfo(mTaskInfoRx.cap(1).toUInt(),
+                     mTaskInfoRx.cap(2).toUInt(),
+                     mTaskInfoRx.cap(3).toULongLong(),
+                     mTaskInfoRx.cap(4).toULongLong() / 1e3,
+                     mTaskInfoRx.cap(5).toULongLong() / 1e3,
+                     mTaskInfoRx.cap(6).toULongLong() / 1e3,
+                     mTaskInfoRx.cap(7).toULongLong() / 1e3
+            )
+        );
+        return true;
+    }
+    // Timing data coming in as nanoseconds.
+    if (mMetaInfoRx.indexIn(line) != -1) {
+        profData.metaInfos.push_back(
+            TaskInfo(mMetaInfoRx.cap(1).toUInt(),
+                     mMetaInfoRx.cap(2).toUInt(),
+                     mMetaInfoRx.cap(3).toULongLong(),
+                     mMetaInfoRx.cap(4).toULongLong() / 1e3,
+                     mMetaInfoRx.cap(5).toULongLong() / 1e3,
+                     mMetaInfoRx.cap(6).toULongLong() / 1e3,
+                     mMetaInfoRx.cap(7).toULongLong() / 1e3
+            )
+        );
+        return true;
+    }
+    if (mProcDescRx.indexIn(line) != -1) {
+        profData.procDescs.push_back(
+            ProcDesc(mProcDescRx.cap(1).toULongLong(),
+                     static_cast<ProcType>(mProcDescRx.cap(2).toUInt())
+            )
+        );
+        return true;
+    }
+    if (mMetaDescRx.indexIn(line) != -1) {
+        const opid_t opid = mMetaDescRx.cap(1).toUInt();
+        const std::string opName = mMetaDescRx.cap(2).toStdString();
+        if (!profData.metaDescs.count(opid)) {
+            profData.metaDescs.insert(
+                std::make_pair(opid, new MetaDesc(opid, opName))
+            );
+        }
+        return true;
+    }
+    return false;
+}
 
 LegionProfLogParser::LegionProfLogParser(
     QString file
@@ -84,61 +142,10 @@ LegionProfLogParser::parse(
         return;
     }
     //
+    LegionProfLineParser lineParser;
     while (!inputFile.atEnd()) {
         const QString line(inputFile.readLine());
-        //
-        if (gTaskKindRx.indexIn(line) != -1) {
-            const taskid_t tid = gTaskKindRx.cap(1).toUInt();
-            const std::string tname = gTaskKindRx.cap(2).toStdString();
-            mProfData->taskKinds.insert(
-                std::make_pair(tid, new TaskKind(tid, tname))
-            );
-            continue;
-        }
-        // Timing data coming in as nanoseconds.
-        if (gTaskInfoRx.indexIn(line) != -1) {
-            mProfData->taskInfos.push_back(
-                TaskInfo(gTaskInfoRx.cap(1).toUInt(),
-                         gTaskInfoRx.cap(2).toUInt(),
-                         gTaskInfoRx.cap(3).toULongLong(),
-                         gTaskInfoRx.cap(4).toULongLong() / 1e3,
-                         gTaskInfoRx.cap(5).toULongLong() / 1e3,
-                         gTaskInfoRx.cap(6).toULongLong() / 1e3,
-                         gTaskInfoRx.cap(7).toULongLong() / 1e3
-                )
-            );
-            continue;
-        }
-        // Timing data coming in as nanoseconds.
-        if (gMetaInfoRx.indexIn(line) != -1) {
-            mProfData->metaInfos.push_back(
-                TaskInfo(gMetaInfoRx.cap(1).toUInt(),
-                         gMetaInfoRx.cap(2).toUInt(),
-                         gMetaInfoRx.cap(3).toULongLong(),
-                         gMetaInfoRx.cap(4).toULongLong() / 1e3,
-                         gMetaInfoRx.cap(5).toULongLong() / 1e3,
-                         gMetaInfoRx.cap(6).toULongLong() / 1e3,
-                         gMetaInfoRx.cap(7).toULongLong() / 1e3
-                )
-            );
-            continue;
-        }
-        if (gProcDescRx.indexIn(line) != -1) {
-            mProfData->procDescs.push_back(
-                ProcDesc(gProcDescRx.cap(1).toULongLong(),
-                         static_cast<ProcType>(gProcDescRx.cap(2).toUInt())
-                )
-            );
-            continue;
-        }
-        if (gMetaDescRx.indexIn(line) != -1) {
-            const opid_t opid = gMetaDescRx.cap(1).toUInt();
-            const std::string opName = gMetaDescRx.cap(2).toStdString();
-            mProfData->metaDescs.insert(
-                std::make_pair(opid, new MetaDesc(opid, opName))
-            );
-            continue;
-        }
+        (void)lineParser.parse(line, *mProfData);
     }
     inputFile.close();
 #if 1
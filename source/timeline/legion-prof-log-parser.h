@@ -13,12 +13,42 @@
 #include "info-types.h"
 
 #include <QObject>
+#include <QRegExp>
 #include <deque>
 
 QT_BEGIN_NAMESPACE
 class QString;
 QT_END_NAMESPACE
 
+/**
+ * Parses Legion prof log lines, one at a time, into LegionProfData. Shared by
+ * log files and live sources. Not thread-safe (QRegExps keep match state), so
+ * every parsing thread needs its own.
+ */
+class LegionProfLineParser {
+public:
+    //
+    LegionProfLineParser(void);
+    // Returns whether or not line was a record that we know.
+    bool
+    parse(
+        const QString &line,
+        LegionProfData &profData
+    );
+
+private:
+    //
+    QRegExp mTaskInfoRx;
+    //
+    QRegExp mMetaInfoRx;
+    //
+    QRegExp mProcDescRx;
+    //
+    QRegExp mTaskKindRx;
+    //
+    QRegExp mMetaDescRx;
+};
+
 class LegionProfLogParser : public QObject {
     Q_OBJECT
 
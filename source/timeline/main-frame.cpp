@@ -9,6 +9,7 @@
 #include "main-frame.h"
 #include "graph-widget.h"
 #include "legion-prof-log-parser.h"
+#include "legion-prof-live-source.h"
 
 #include <QtCore>
 #include <QFile>
@@ -122,6 +123,11 @@ MainFrame::MainFrame(
     if (!fileNames.empty()) {
         mProcessLogFiles(fileNames);
     }
+    // And follow a running job if asked to.
+    const QString liveAddress = mGetLiveAddressFromArgv();
+    if (!liveAddress.isEmpty()) {
+        mStartLiveSource(liveAddress);
+    }
 }
 
 void
@@ -172,6 +178,48 @@ MainFrame::mGetFileNamesFromArgv(void)
     return fileNames;
 }
 
+QString
+MainFrame::mGetLiveAddressFromArgv(void)
+{
+    static const QString liveOpt = "--live=";
+    const QStringList argv = QCoreApplication::arguments();
+
+    for (int argi = 1; argi < argv.size(); ++argi) {
+        if (argv.at(argi).startsWith(liveOpt)) {
+            return argv.at(argi).mid(liveOpt.size());
+        }
+    }
+    return "";
+}
+
+void
+MainFrame::mStartLiveSource(
+    const QString &address
+) {
+    QString host;
+    quint16 port = 0;
+    if (!LegionProfLiveSource::parseAddress(address, host, port)) {
+        emit sigStatusChange(
+            StatusKind::ERR, "Invalid Live Address: '" + address + "'"
+        );
+        return;
+    }
+    mLiveSource = new LegionProfLiveSource(host, port, this);
+    connect(
+        mLiveSource,
+        SIGNAL(sigStatusChange(StatusKind, QString)),
+        this,
+        SIGNAL(sigStatusChange(StatusKind, QString))
+    );
+    connect(
+        mLiveSource,
+        SIGNAL(sigBatchReady()),
+        this,
+        SLOT(mOnLiveBatchReady())
+    );
+    mLiveSource->start();
+}
+
 void
 MainFrame::mSetupMatrix(void)
 {
@@ -280,6 +328,8 @@ MainFrame::mOnParseDone(
     //
     mGraphWidget->plot();
     //
+    mStatsTextArea->setPlainText(mGraphWidget->getUtilizationReport());
+    //
     mFitViewToScene();
     // We no longer need the parser instances, so clean them up.
     foreach (const QString fName, mLegionProfLogParsers.keys()) {
@@ -293,6 +343,31 @@ MainFrame::mOnParseDone(
     mGraphStatsButton->show();
 }
 
+void
+MainFrame::mOnLiveBatchReady(
+    void
+) {
+    LegionProfData *batch = mLiveSource->takeBatch();
+    if (!batch) return;
+    // Only what is new gets drawn.
+    mGraphWidget->addPlotData(*batch);
+    delete batch;
+    //
+    mStatsTextArea->setPlainText(mGraphWidget->getUtilizationReport());
+    //
+    if (!mLiveDataShown) {
+        mFitViewToScene();
+        mOnGraphStatsButtonPressed(false);
+        mGraphStatsButton->show();
+        mLiveDataShown = true;
+    }
+    emit sigStatusChange(
+        StatusKind::INFO,
+        "Live: " + mLiveSource->getAddress() + " ("
+        + QString::number(mLiveSource->nTaskInfos()) + " Tasks)"
+    );
+}
+
 void
 MainFrame::mOnGraphStatsButtonPressed(
     bool pressed
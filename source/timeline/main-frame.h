@@ -29,6 +29,7 @@ QT_END_NAMESPACE
 
 class GraphWidget;
 class LegionProfLogParser;
+class LegionProfLiveSource;
 
 /**
  * @brief The View class
@@ -56,6 +57,8 @@ private slots:
     //
     void mOnParseDone(void);
     //
+    void mOnLiveBatchReady(void);
+    //
     void mOnGraphStatsButtonPressed(bool pressed);
     //
     void mOnHelpButtonPressed(bool pressed);
@@ -90,6 +93,10 @@ private:
     GraphWidget *mGraphWidget = nullptr;
     // Map between log file name and parser.
     QMap<QString, LegionProfLogParser *> mLegionProfLogParsers;
+    // Where live data come from, if anywhere.
+    LegionProfLiveSource *mLiveSource = nullptr;
+    // Whether or not live data have been shown yet.
+    bool mLiveDataShown = false;
     //
     QLabel *mStatusLabel = nullptr;
     //
@@ -130,6 +137,12 @@ private:
     //
     QStringList
     mGetFileNamesFromArgv(void);
+    // Returns the HOST:PORT given with --live=, or an empty string.
+    QString
+    mGetLiveAddressFromArgv(void);
+    //
+    void
+    mStartLiveSource(const QString &address);
     //
     void
     mPopulateHelpTextArea(void);
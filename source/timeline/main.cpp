@@ -36,7 +36,8 @@ bool needsHelp(
 
 void
 displayUsage(void) {
-    QTextStream(stdout) << "usage: " APP_NAME " [log ...]" << endl;
+    QTextStream(stdout) << "usage: " APP_NAME " [--live=HOST:PORT] [log ...]"
+                        << endl;
 }
 
 } // end namespace
@@ -104,7 +104,9 @@ ProcTimeline::addTask(
         this
     );
     if (!mColorPalette.empty()) {
-        taskWidget->setFillColor(mColorPalette[info.funcID]);
+        taskWidget->setFillColor(
+            mColorPalette[info.funcID % mColorPalette.size()]
+        );
     }
     mTaskWidgets << taskWidget;
     mView->scene()->addItem(taskWidget);
@@ -114,6 +116,18 @@ ProcTimeline::addTask(
     }
 }
 
+ustime_t
+ProcTimeline::getBusyTime(void) const
+{
+    using namespace boost::icl;
+    // The intervals are split where tasks overlap, so they don't overlap.
+    ustime_t busy = 0;
+    for (const auto &interval : mTimeIntervals) {
+        busy += upper(interval.first) - lower(interval.first);
+    }
+    return busy;
+}
+
 void
 ProcTimeline::propagatePositionUpdate(void)
 {
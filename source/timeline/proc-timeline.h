@@ -59,6 +59,19 @@ public:
     //
     void
     propagatePositionUpdate(void);
+    //
+    const ProcDesc &
+    getProcDesc(void) const {
+        return mProcDesc;
+    }
+    // Time spent running (drawn) tasks. Overlapping tasks count once.
+    ustime_t
+    getBusyTime(void) const;
+    //
+    int
+    getNumTasks(void) const {
+        return mTaskWidgets.size();
+    }
 
 private:
     //
@@ -6,7 +6,7 @@
 # top-level directory of this distribution.
 #
 
-QT += core concurrent widgets gui
+QT += core concurrent widgets gui network
 
 qtHaveModule(printsupport): QT += printsupport
 qtHaveModule(opengl): QT += opengl
@@ -31,6 +31,7 @@ macx {
 SOURCES += \
 main-window.cpp \
 legion-prof-log-parser.cpp \
+legion-prof-live-source.cpp \
 main-frame.cpp \
 proc-timeline.cpp \
 main.cpp \
@@ -41,6 +42,7 @@ common.h \
 info-types.h \
 main-window.h \
 legion-prof-log-parser.h \
+legion-prof-live-source.h \
 main-frame.h \
 proc-timeline.h \
 graph-widget.h \
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Legion mapper instrumentation built on the tool back-end API. Mapper
+ * decisions are recorded as application events (see Tool::recordEvent), so
+ * they go into the recording thread's lock-free queue, and with it the
+ * processor's, and reach the tool back-end asynchronously. A mapper call only
+ * ever blocks when the tool has armed a breakpoint on it, so mapping
+ * throughput is unchanged when nobody is debugging. For example:
+ *
+ * rt->replace_default_mapper(
+ *     new gladius::legion::InstrumentedMapper<DefaultMapper>(
+ *         tool, machine, rt, proc
+ *     ),
+ *     proc
+ * );
+ *
+ * Header-only: include it from a Legion application (it needs legion.h).
+ */
+
+#pragma once
+
+#include "tool-api/gladius-toolbe.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "legion.h"
+
+namespace gladius {
+namespace legion {
+
+/**
+ * The mapper calls that are recorded.
+ */
+enum MapperCall {
+    // args: task ID, unique task ID, mapping processor, target processor.
+    SelectTaskOptions = 0,
+    // args: task ID, unique task ID, mapping processor, number of slices.
+    SliceDomain,
+    // One per region. args: task ID, unique task ID, target processor, and
+    // the region's index (high 32 bits) and first-choice memory (low 32 bits).
+    MapTask,
+    //
+    NMapperCalls
+};
+
+/**
+ * Records mapper decisions through the tool API. Knows nothing about Legion,
+ * so it can be used from mappers that InstrumentedMapper can't wrap.
+ */
+class MapperRecorder {
+    //
+    toolbe::Tool &mTool;
+    // Event IDs, by MapperCall.
+    uint32_t mIDs[NMapperCalls];
+    // Whether or not the event IDs are usable.
+    bool mOK = true;
+
+public:
+    /**
+     * The name that c's events are recorded under.
+     */
+    static const char *
+    callName(MapperCall c) {
+        switch (c) {
+            case SelectTaskOptions: return "legion.mapper.select_task_options";
+            case SliceDomain: return "legion.mapper.slice_domain";
+            case MapTask: return "legion.mapper.map_task";
+            default: return "legion.mapper.unknown";
+        }
+    }
+
+    /**
+     *
+     */
+    explicit MapperRecorder(toolbe::Tool &tool)
+        : mTool(tool)
+    {
+        for (int c = 0; c < NMapperCalls; ++c) {
+            if (GLADIUS_SUCCESS != mTool.eventID(
+                                       callName(MapperCall(c)), mIDs[c]
+                                   )) {
+                mOK = false;
+            }
+        }
+    }
+
+    /**
+     * Records a decision made by call c. Never blocks.
+     */
+    void
+    record(
+        MapperCall c,
+        uint64_t a0,
+        uint64_t a1,
+        uint64_t a2,
+        uint64_t a3
+    ) {
+        if (!mOK) return;
+        const uint64_t args[] = {a0, a1, a2, a3};
+        (void)mTool.recordEvent(mIDs[c], args, 4);
+    }
+
+    /**
+     * Stops here if the tool armed a breakpoint on c, until the tool resumes
+     * us.
+     */
+    void
+    breakpoint(MapperCall c) {
+        if (!mOK) return;
+        (void)mTool.breakpoint(mIDs[c]);
+    }
+};
+
+/**
+ * A BaseMapper (e.g., DefaultMapper) whose task mapping decisions are
+ * recorded. The base mapper decides; we record what it decided and stop
+ * afterwards if a breakpoint is armed, so the tool sees the decision that the
+ * stopped call made.
+ */
+template <class BaseMapper>
+class InstrumentedMapper : public BaseMapper {
+    //
+    MapperRecorder mRecorder;
+
+public:
+    /**
+     *
+     */
+    InstrumentedMapper(
+        toolbe::Tool &tool,
+        LegionRuntime::HighLevel::Machine machine,
+        LegionRuntime::HighLevel::HighLevelRuntime *rt,
+        LegionRuntime::HighLevel::Processor local
+    ) : BaseMapper(machine, rt, local)
+      , mRecorder(tool) { ; }
+
+    /**
+     *
+     */
+    virtual void
+    select_task_options(LegionRuntime::HighLevel::Task *task) {
+        BaseMapper::select_task_options(task);
+        mRecorder.record(
+            SelectTaskOptions,
+            task->task_id,
+            task->get_unique_task_id(),
+            this->local_proc.id,
+            task->target_proc.id
+        );
+        mRecorder.breakpoint(SelectTaskOptions);
+    }
+
+    /**
+     *
+     */
+    virtual void
+    slice_domain(
+        const LegionRuntime::HighLevel::Task *task,
+        const LegionRuntime::HighLevel::Domain &domain,
+        std::vector<LegionRuntime::HighLevel::DomainSplit> &slices
+    ) {
+        BaseMapper::slice_domain(task, domain, slices);
+        mRecorder.record(
+            SliceDomain,
+            task->task_id,
+            task->get_unique_task_id(),
+            this->local_proc.id,
+            slices.size()
+        );
+        mRecorder.breakpoint(SliceDomain);
+    }
+
+    /**
+     *
+     */
+    virtual bool
+    map_task(LegionRuntime::HighLevel::Task *task) {
+        const bool notify = BaseMapper::map_task(task);
+        for (size_t r = 0; r < task->regions.size(); ++r) {
+            const auto &ranking = task->regions[r].target_ranking;
+            const uint64_t memory = ranking.empty() ? 0 : ranking.front().id;
+            mRecorder.record(
+                MapTask,
+                task->task_id,
+                task->get_unique_task_id(),
+                task->target_proc.id,
+                (uint64_t(r) << 32) | (memory & 0xffffffffULL)
+            );
+        }
+        mRecorder.breakpoint(MapTask);
+        return notify;
+    }
+};
+
+} // end legion namespace
+} // end gladius namespace
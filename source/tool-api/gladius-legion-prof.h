@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Live Legion profiling built on the tool back-end API. What Legion prof
+ * would log (processors, task kinds, and task executions) is recorded as
+ * application events instead (see Tool::recordEvent), so it reaches the tool
+ * front-end through the tool tree while the job runs (see the lprof plugin),
+ * and nothing is written to disk. For example, from a mapper that asked
+ * Legion to profile its tasks:
+ *
+ * prof.procDesc(local_proc.id, local_proc.kind());
+ * ...
+ * prof.taskInfo(
+ *     task->get_unique_task_id(), task->task_id, task->target_proc.id,
+ *     startNS, stopNS
+ * );
+ *
+ * Header-only, and knows nothing about Legion, so it fits any Legion version.
+ */
+
+#pragma once
+
+#include "tool-api/gladius-toolbe.h"
+#include "tool-common/legion-prof-records.h"
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace gladius {
+namespace legion {
+
+/**
+ * Records Legion profiling records through the tool API. Thread-safe.
+ */
+class ProfRecorder {
+    //
+    toolbe::Tool &mTool;
+    //
+    uint32_t mProcDescID = 0;
+    //
+    uint32_t mTaskInfoID = 0;
+    // Whether or not the event IDs are usable.
+    bool mOK = true;
+    // Guards mTaskKinds.
+    std::mutex mLock;
+    // Task kinds already recorded.
+    std::set<uint32_t> mTaskKinds;
+
+public:
+    /**
+     *
+     */
+    explicit ProfRecorder(toolbe::Tool &tool)
+        : mTool(tool)
+    {
+        using namespace toolcommon::legionprof;
+        if (GLADIUS_SUCCESS != mTool.eventID(ProcDescName, mProcDescID) ||
+            GLADIUS_SUCCESS != mTool.eventID(TaskInfoName, mTaskInfoID)) {
+            mOK = false;
+        }
+    }
+
+    /**
+     * Records that processor procID (Processor::id) is of kind procKind
+     * (Processor::Kind). Recording a processor more than once is harmless.
+     */
+    void
+    procDesc(
+        uint64_t procID,
+        uint32_t procKind
+    ) {
+        if (!mOK) return;
+        const uint64_t args[] = {procID, procKind};
+        (void)mTool.recordEvent(mProcDescID, args, 2);
+    }
+
+    /**
+     * Records that the tasks with task ID taskID are called name. Only the
+     * first call for a taskID records anything.
+     */
+    void
+    taskKind(
+        uint32_t taskID,
+        const std::string &name
+    ) {
+        if (!mOK) return;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (!mTaskKinds.insert(taskID).second) return;
+        }
+        // The name travels as the event's name, which is sent only once.
+        uint32_t id = 0;
+        const auto eventName = toolcommon::legionprof::taskKindEventName(name);
+        if (GLADIUS_SUCCESS != mTool.eventID(eventName, id)) return;
+        const uint64_t args[] = {taskID};
+        (void)mTool.recordEvent(id, args, 1);
+    }
+
+    /**
+     * Records that task uniqueID, a taskID task, ran on procID from startNS to
+     * stopNS (nanoseconds, on any clock that all processors share). Never
+     * blocks.
+     */
+    void
+    taskInfo(
+        uint32_t uniqueID,
+        uint32_t taskID,
+        uint64_t procID,
+        uint64_t startNS,
+        uint64_t stopNS
+    ) {
+        if (!mOK) return;
+        const uint64_t args[] = {
+            (uint64_t(uniqueID) << 32) | taskID, procID, startNS, stopNS
+        };
+        (void)mTool.recordEvent(mTaskInfoID, args, 4);
+    }
+};
+
+} // end legion namespace
+} // end gladius namespace
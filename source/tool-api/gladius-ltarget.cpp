@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * A simulated target for the local launcher. It does nothing but host a tool
+ * back-end, so that the lash-up can be exercised at scale on a single host. For
+ * example, from the terminal with GLADIUS_TOOL_FE_TOPO_FILE set to one of the
+ * testing/topologies/local-1xN.top files:
+ *
+ * launch gladius-ltarget with local -n 1024
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "tool-api/gladius-toolbe.h"
+
+#include "core/core.h"
+#include "core/utils.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace gladius;
+
+int
+main(void)
+{
+    // Our rank is given to us by the local launcher.
+    int rank = 0;
+    if (GLADIUS_SUCCESS != core::utils::getEnvAs(
+                               GLADIUS_ENV_LOCAL_RANK_NAME, rank
+                           )) {
+        GLADIUS_CERR << GLADIUS_ENV_LOCAL_RANK_NAME << " not set. "
+                     << "Was I started by the local launcher?" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const bool beVerbose = core::utils::envVarSet(
+                               GLADIUS_ENV_TOOL_BE_VERBOSE_NAME
+                           );
+    //
+    toolbe::Tool tool;
+    if (GLADIUS_SUCCESS != tool.create(rank, beVerbose)) {
+        return EXIT_FAILURE;
+    }
+    // Returns once the tool is done with us.
+    if (GLADIUS_SUCCESS != tool.connect()) {
+        return EXIT_FAILURE;
+    }
+    //
+    return EXIT_SUCCESS;
+}
@@ -45,10 +45,113 @@ Tool::create(
 }
 
 /**
- * Wrapper for Tool::ToolBE::connect
+ * Wrapper for Tool::ToolBE::connect. Blocks until the tool is done with us.
  */
 int
 Tool::connect(void)
 {
     return mImpl->connect();
 }
+
+/**
+ * Wrapper for Tool::ToolBE::connectAsync. Returns right away; the lash-up (and
+ * everything after it) happens on a tool thread, so application startup isn't
+ * held up by the tool's. Call wait before tearing down the application's
+ * runtime (e.g., before MPI_Finalize).
+ */
+int
+Tool::connectAsync(const ConnectedFn &fn)
+{
+    return mImpl->connectAsync(fn);
+}
+
+/**
+ * Wrapper for Tool::ToolBE::connectStatus. GLADIUS_NOT_CONNECTED while
+ * connecting, GLADIUS_SUCCESS once connected, or why connecting failed.
+ */
+int
+Tool::connectStatus(void)
+{
+    return mImpl->connectStatus();
+}
+
+/**
+ * Wrapper for Tool::ToolBE::waitForConnect. Waits up to timeoutInMS (forever
+ * if negative) and returns connectStatus.
+ */
+int
+Tool::waitForConnect(int timeoutInMS)
+{
+    return mImpl->waitForConnect(timeoutInMS);
+}
+
+/**
+ * Wrapper for Tool::ToolBE::wait. Waits for the tool to be done with us.
+ */
+int
+Tool::wait(void)
+{
+    return mImpl->wait();
+}
+
+/**
+ * Returns in id the ID of the application event (or counter) called name,
+ * registering it if need be. IDs are cheap to record with, so look them up
+ * once. Safe to call from any thread.
+ */
+int
+Tool::eventID(
+    const std::string &name,
+    uint32_t &id
+) {
+    return mImpl->appEvents().nameID(name, id);
+}
+
+/**
+ * Records that application event id happened now. Never blocks: the event
+ * goes into the calling thread's queue, which the back-end drains and forwards
+ * upstream in batches. Returns GLADIUS_ERR_OOR if the queue is full (and the
+ * event is dropped). Safe to call from any thread.
+ */
+int
+Tool::recordEvent(uint32_t id)
+{
+    return mImpl->appEvents().recordEvent(id);
+}
+
+/**
+ * Like recordEvent, but with up to four integer arguments (e.g., IDs) that
+ * say more about the event. Returns GLADIUS_ERR_OOR if there are too many.
+ */
+int
+Tool::recordEvent(
+    uint32_t id,
+    const uint64_t *args,
+    uint32_t nArgs
+) {
+    return mImpl->appEvents().recordEvent(id, args, nArgs);
+}
+
+/**
+ * Like recordEvent, but for a counter's current value.
+ */
+int
+Tool::recordCounter(
+    uint32_t id,
+    double value
+) {
+    return mImpl->appEvents().recordCounter(id, value);
+}
+
+/**
+ * Stops the calling thread here if the tool has armed a breakpoint on event
+ * id, until the tool resumes it. Otherwise returns right away, at the cost of
+ * one atomic load, so it can be called at every event. Safe to call from any
+ * thread.
+ */
+int
+Tool::breakpoint(uint32_t id)
+{
+    (void)mImpl->appBreakpoints().check(id);
+    return GLADIUS_SUCCESS;
+}
@@ -14,7 +14,10 @@
 
 #include "core/gladius-rc.h"
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace gladius {
 namespace toolbe {
@@ -23,6 +26,12 @@ namespace toolbe {
 ////////////////////////////////////////////////////////////////////////////////
 class Tool {
 public:
+    /**
+     * Called once, from a tool thread, when connectAsync's lash-up is done:
+     * with GLADIUS_SUCCESS once the tool is connected, or with why it couldn't
+     * be. Must not block.
+     */
+    typedef std::function<void(int rc)> ConnectedFn;
     //
     Tool(void);
     //
@@ -36,6 +45,43 @@ public:
     //
     int
     connect(void);
+    //
+    int
+    connectAsync(const ConnectedFn &fn = ConnectedFn());
+    //
+    int
+    connectStatus(void);
+    //
+    int
+    waitForConnect(int timeoutInMS = -1);
+    //
+    int
+    wait(void);
+    //
+    int
+    eventID(
+        const std::string &name,
+        uint32_t &id
+    );
+    //
+    int
+    recordEvent(uint32_t id);
+    //
+    int
+    recordEvent(
+        uint32_t id,
+        const uint64_t *args,
+        uint32_t nArgs
+    );
+    //
+    int
+    breakpoint(uint32_t id);
+    //
+    int
+    recordCounter(
+        uint32_t id,
+        double value
+    );
 private:
     // Forward declaration of ToolBE to avoid include hell on the app side.
     class ToolBE;
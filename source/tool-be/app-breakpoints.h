@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Breakpoints that the back-end arms on application events (see
+ * AppEventQueue::nameID). An application thread that reaches an armed
+ * breakpoint stops until the back-end resumes it. While nothing is armed,
+ * checking costs one relaxed atomic load, so instrumented code can check at
+ * every event without slowing down.
+ */
+
+#pragma once
+
+#include "core/core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace gladius {
+namespace toolbe {
+
+/**
+ * Many application threads check, one back-end thread arms and resumes.
+ */
+class AppBreakpoints {
+    // The number of armed breakpoints: all that the fast path reads.
+    std::atomic<uint32_t> mNArmed;
+    // Guards everything below it.
+    std::mutex mLock;
+    //
+    std::condition_variable mResumeCV;
+    //
+    std::set<uint32_t> mArmed;
+    // Bumped by resume. Stopped threads wait for it to change.
+    uint64_t mGeneration = 0;
+    // Where threads are stopped (one entry per thread).
+    std::multiset<uint32_t> mStoppedAt;
+    // Readable when a thread stops (for the back-end's event loop).
+    int mNotifyFD = -1;
+
+    /**
+     * Stops the calling thread until resume if id is armed. Returns whether or
+     * not it stopped.
+     */
+    bool
+    mStop(uint32_t id) {
+        std::unique_lock<std::mutex> lock(mLock);
+        if (!mArmed.count(id)) return false;
+        const auto it = mStoppedAt.insert(id);
+        const uint64_t generation = mGeneration;
+        if (-1 != mNotifyFD) {
+            const uint64_t one = 1;
+            (void)!write(mNotifyFD, &one, sizeof(one));
+        }
+        mResumeCV.wait(lock, [&]() { return generation != mGeneration; });
+        mStoppedAt.erase(it);
+        return true;
+    }
+
+public:
+    /**
+     *
+     */
+    AppBreakpoints(void)
+        : mNArmed(0)
+    {
+        mNotifyFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    /**
+     * Lets every stopped thread go.
+     */
+    ~AppBreakpoints(void) {
+        disarmAll();
+        if (-1 != mNotifyFD) (void)close(mNotifyFD);
+    }
+
+    // Not copyable.
+    AppBreakpoints(const AppBreakpoints &) = delete;
+    //
+    AppBreakpoints &operator=(const AppBreakpoints &) = delete;
+
+    /**
+     * Application side: stops the calling thread here, until resume, if a
+     * breakpoint on id is armed. Returns whether or not we stopped.
+     */
+    bool
+    check(uint32_t id) {
+        if (0 == mNArmed.load(std::memory_order_relaxed)) return false;
+        return mStop(id);
+    }
+
+    /**
+     * Back-end side: arms a breakpoint on id.
+     */
+    void
+    arm(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (mArmed.insert(id).second) mNArmed++;
+    }
+
+    /**
+     * Back-end side: disarms the breakpoint on id. Threads already stopped
+     * there stay stopped until resume.
+     */
+    void
+    disarm(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (mArmed.erase(id)) mNArmed--;
+    }
+
+    /**
+     * Back-end side: disarms everything and lets every stopped thread go (e.g.
+     * at the end of a session, so that nobody waits for a tool that is gone).
+     */
+    void
+    disarmAll(void) {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mArmed.clear();
+            mNArmed = 0;
+        }
+        resume();
+    }
+
+    /**
+     * Back-end side: lets every stopped thread go. Breakpoints stay armed, so
+     * resuming steps from one stop to the next.
+     */
+    void
+    resume(void) {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            ++mGeneration;
+        }
+        mResumeCV.notify_all();
+    }
+
+    /**
+     * Back-end side: returns where threads are stopped (an ID per thread).
+     */
+    std::vector<uint32_t>
+    stoppedAt(void) {
+        std::lock_guard<std::mutex> lock(mLock);
+        return std::vector<uint32_t>(mStoppedAt.begin(), mStoppedAt.end());
+    }
+
+    /**
+     * Back-end side: a descriptor that becomes readable when a thread stops
+     * (e.g., for EventLoop::addFD). Read it (8 bytes) to clear it. -1 if it
+     * couldn't be created, in which case poll stoppedAt.
+     */
+    int
+    notifyFD(void) const {
+        return mNotifyFD;
+    }
+};
+
+} // end toolbe namespace
+} // end gladius namespace
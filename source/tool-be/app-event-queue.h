@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Where application threads leave events for the back-end. Every application
+ * thread gets its own lock-free ring on first use, so recording an event never
+ * blocks and never contends with other threads or with the back-end. The
+ * back-end drains all rings on its own schedule and forwards what it finds
+ * upstream in batches.
+ */
+
+#pragma once
+
+#include "tool-be/event-loop.h"
+#include "tool-be/spsc-ring.h"
+#include "tool-common/app-event.h"
+#include "tool-common/tx-message.h"
+
+#include "core/core.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <time.h>
+
+#include "mrnet/MRNet.h"
+
+namespace gladius {
+namespace toolbe {
+
+/**
+ * Many producers (application threads), one consumer (the back-end).
+ */
+class AppEventQueue {
+    //
+    struct Producer {
+        //
+        SPSCRing<toolcommon::AppEvent> ring;
+        //
+        uint32_t thread;
+        //
+        Producer(
+            size_t capacity,
+            uint32_t thread
+        ) : ring(capacity)
+          , thread(thread) { ; }
+        // The ring is over-aligned, which plain new ignores before C++17.
+        static void *
+        operator new(size_t n) {
+            void *p = nullptr;
+            if (0 != posix_memalign(&p, alignof(Producer), n)) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+        //
+        static void
+        operator delete(void *p) {
+            free(p);
+        }
+    };
+    // Events that each thread can have waiting.
+    size_t mRingCapacity = 0;
+    // Tells queues apart in the per-thread cache.
+    uint64_t mInstance = 0;
+    // Guards everything below it. Taken on a thread's first event, when a name
+    // is registered, and once per drain; never per event.
+    std::mutex mLock;
+    //
+    std::map<std::thread::id, std::unique_ptr<Producer>> mProducers;
+    //
+    std::unordered_map<std::string, uint32_t> mIDs;
+    //
+    std::vector<std::string> mNames;
+    // Names that have gone out in a batch.
+    size_t mNNamesSent = 0;
+    // The number of registered names (readable without mLock).
+    std::atomic<uint32_t> mNIDs;
+    // Where the consumer gathers producers for a drain.
+    std::vector<Producer *> mDrainList;
+
+    /**
+     *
+     */
+    static uint64_t
+    mNextInstance(void) {
+        static std::atomic<uint64_t> next(1);
+        return next++;
+    }
+
+    /**
+     * Returns the calling thread's producer, creating it if need be. The
+     * common case is a thread-local lookup.
+     */
+    Producer *
+    mProducer(void) {
+        struct Cache {
+            uint64_t instance = 0;
+            Producer *producer = nullptr;
+        };
+        static thread_local Cache cache;
+        if (cache.instance == mInstance) return cache.producer;
+        //
+        std::lock_guard<std::mutex> lock(mLock);
+        auto &p = mProducers[std::this_thread::get_id()];
+        if (!p) {
+            const uint32_t thread = uint32_t(mProducers.size() - 1);
+            p.reset(new Producer(mRingCapacity, thread));
+        }
+        cache.instance = mInstance;
+        cache.producer = p.get();
+        return cache.producer;
+    }
+
+    /**
+     *
+     */
+    int
+    mRecord(
+        toolcommon::AppEvent::Kind kind,
+        uint32_t id,
+        double value,
+        const uint64_t *args = nullptr,
+        uint32_t nArgs = 0
+    ) {
+        if (nArgs > uint32_t(toolcommon::AppEvent::NArgs)) {
+            return GLADIUS_ERR_OOR;
+        }
+        if (id >= mNIDs.load(std::memory_order_acquire)) return GLADIUS_ERR;
+        auto *p = mProducer();
+        //
+        toolcommon::AppEvent e;
+        struct timespec ts;
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        e.timeNS = uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+        e.id = id;
+        e.kind = kind;
+        e.thread = p->thread;
+        e.value = value;
+        e.nArgs = nArgs;
+        for (uint32_t a = 0; a < nArgs; ++a) e.args[a] = args[a];
+        return p->ring.push(e) ? GLADIUS_SUCCESS : GLADIUS_ERR_OOR;
+    }
+
+public:
+    /**
+     * Every application thread can have up to ringCapacity events waiting
+     * for the back-end. More are dropped (and counted).
+     */
+    explicit AppEventQueue(size_t ringCapacity = 8192)
+        : mRingCapacity(ringCapacity)
+        , mInstance(mNextInstance())
+        , mNIDs(0) { ; }
+
+    // Not copyable.
+    AppEventQueue(const AppEventQueue &) = delete;
+    //
+    AppEventQueue &operator=(const AppEventQueue &) = delete;
+
+    /**
+     * Returns in id the ID of the event (or counter) called name, registering
+     * the name if it is new. Thread-safe.
+     */
+    int
+    nameID(
+        const std::string &name,
+        uint32_t &id
+    ) {
+        std::lock_guard<std::mutex> lock(mLock);
+        const auto it = mIDs.find(name);
+        if (mIDs.end() != it) {
+            id = it->second;
+            return GLADIUS_SUCCESS;
+        }
+        id = uint32_t(mNames.size());
+        mIDs[name] = id;
+        mNames.push_back(name);
+        mNIDs.store(id + 1, std::memory_order_release);
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Producer side: records that event id happened now. Never blocks. Returns
+     * GLADIUS_ERR_OOR (dropping the event) if the calling thread's queue is
+     * full.
+     */
+    int
+    recordEvent(uint32_t id) {
+        return mRecord(toolcommon::AppEvent::Mark, id, 0.0);
+    }
+
+    /**
+     * Like recordEvent, but with up to AppEvent::NArgs integer arguments that
+     * say more about the event.
+     */
+    int
+    recordEvent(
+        uint32_t id,
+        const uint64_t *args,
+        uint32_t nArgs
+    ) {
+        return mRecord(toolcommon::AppEvent::Mark, id, 0.0, args, nArgs);
+    }
+
+    /**
+     * Producer side: records that counter id is value now. Never blocks.
+     * Returns GLADIUS_ERR_OOR (dropping the value) if the calling thread's
+     * queue is full.
+     */
+    int
+    recordCounter(
+        uint32_t id,
+        double value
+    ) {
+        return mRecord(toolcommon::AppEvent::Counter, id, value);
+    }
+
+    /**
+     * Consumer side: moves up to maxEvents events (taken round-robin from the
+     * application threads, oldest first), and any names that haven't gone out
+     * yet, into batch. Returns the number of events.
+     */
+    size_t
+    drain(
+        toolcommon::AppEventBatch &batch,
+        size_t maxEvents
+    ) {
+        batch.clear();
+        mDrainList.clear();
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            for (; mNNamesSent < mNames.size(); ++mNNamesSent) {
+                batch.names.emplace_back(
+                    uint32_t(mNNamesSent), mNames[mNNamesSent]
+                );
+            }
+            // Producers live as long as we do, so they can be used unlocked.
+            for (auto &p : mProducers) mDrainList.push_back(p.second.get());
+        }
+        //
+        batch.nDropped = 0;
+        for (auto *p : mDrainList) batch.nDropped += p->ring.nDropped();
+        //
+        toolcommon::AppEvent e;
+        bool more = true;
+        while (more && batch.events.size() < maxEvents) {
+            more = false;
+            for (auto *p : mDrainList) {
+                if (batch.events.size() >= maxEvents) break;
+                if (p->ring.pop(e)) {
+                    batch.events.push_back(e);
+                    more = true;
+                }
+            }
+        }
+        return batch.events.size();
+    }
+
+    /**
+     * Consumer side: every periodInMS on loop, drains everything and sends it
+     * on stream with tag (a plugin tag) in batches of up to maxBatch events.
+     * Nothing is sent when there is nothing new.
+     */
+    EventLoop::TimerID
+    forwardEvery(
+        EventLoop &loop,
+        MRN::Stream *stream,
+        int tag,
+        int32_t uid,
+        unsigned periodInMS,
+        size_t maxBatch = 4096
+    ) {
+        return loop.addTimer(periodInMS, [=]() {
+            if (GLADIUS_SUCCESS != forward(stream, tag, uid, maxBatch)) {
+                GLADIUS_CERR << "Application event forwarding failed."
+                             << std::endl;
+            }
+        });
+    }
+
+    /**
+     * Consumer side: what forwardEvery does once.
+     */
+    int
+    forward(
+        MRN::Stream *stream,
+        int tag,
+        int32_t uid,
+        size_t maxBatch = 4096
+    ) {
+        toolcommon::AppEventBatch batch;
+        batch.uid = uid;
+        size_t n = 0;
+        bool sent = false;
+        do {
+            n = drain(batch, maxBatch);
+            if (batch.empty()) break;
+            toolcommon::TxMessageWriter msg;
+            batch.pack(msg);
+            const int rc = msg.pluginSend(stream, tag);
+            if (GLADIUS_SUCCESS != rc) return rc;
+            sent = true;
+        } while (n == maxBatch);
+        //
+        if (sent && -1 == stream->flush()) return GLADIUS_ERR_MRNET;
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Consumer side: has the next drain send every name again, for a consumer
+     * (e.g., a new plugin session's front-end) that hasn't seen any of them.
+     */
+    void
+    resendNames(void) {
+        std::lock_guard<std::mutex> lock(mLock);
+        mNNamesSent = 0;
+    }
+
+    /**
+     * Returns the number of events lost because a thread's queue was full.
+     */
+    uint64_t
+    nDropped(void) {
+        std::lock_guard<std::mutex> lock(mLock);
+        uint64_t n = 0;
+        for (auto &p : mProducers) n += p.second->ring.nDropped();
+        return n;
+    }
+};
+
+} // end toolbe namespace
+} // end gladius namespace
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * The tool back-end's event loop. Instead of blocking in Network::recv, a
+ * back-end (or a back-end plugin) registers handlers for MRNet packets, timers,
+ * and local file descriptors, and the loop multiplexes them all with poll(2).
+ * Periodic local work (e.g. sampling target state) runs between front-end
+ * commands, and its results can be sent upstream in batches.
+ */
+
+#pragma once
+
+#include "tool-common/tool-common.h"
+#include "tool-common/tx-message.h"
+
+#include "core/core.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <errno.h>
+#include <poll.h>
+
+#include "mrnet/MRNet.h"
+
+namespace gladius {
+namespace toolbe {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * A single-threaded poll(2) loop. Handlers run on the thread that called run,
+ * and may add or remove handlers (or stop the loop) as they go. Only plugin
+ * tags reach the packet handler: a core protocol packet (e.g., the next
+ * session's plugin info) means that the session is over, so the loop stops
+ * and leaves that packet for the back-end (see takeCorePacket).
+ */
+class EventLoop {
+public:
+    //
+    typedef uint64_t TimerID;
+    // Called with the revents that poll(2) reported for the descriptor.
+    typedef std::function<void(short revents)> FDFn;
+    //
+    typedef std::function<void(void)> TimerFn;
+    // Called for each packet that arrives on the network.
+    typedef std::function<
+        void(int tag, const MRN::PacketPtr &packet, MRN::Stream *stream)
+    > PacketFn;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    //
+    struct Timer {
+        TimerID id;
+        Clock::time_point due;
+        std::chrono::milliseconds period;
+        bool repeat;
+        TimerFn fn;
+    };
+    // How often to look for packets if MRNet can't give us a descriptor.
+    static constexpr int sNetPollIntervalInMS = 10;
+    //
+    std::map<int, std::pair<short, FDFn>> mFDs;
+    //
+    std::vector<Timer> mTimers;
+    //
+    TimerID mNextTimerID = 1;
+    //
+    MRN::Network *mNet = nullptr;
+    // MRNet's data event descriptor. -1 if there isn't one.
+    int mNetFD = -1;
+    //
+    PacketFn mPacketFn;
+    //
+    bool mStop = false;
+    // Guards what follows. Defined in tool-be.cpp, so that every loop in the
+    // process (plugins' included) shares them.
+    static std::mutex sCorePacketLock;
+    // Whether or not sCoreTag and sCorePacket hold a packet.
+    static bool sHaveCorePacket;
+    //
+    static int sCoreTag;
+    //
+    static MRN::PacketPtr sCorePacket;
+
+    /**
+     * Hands every packet that has arrived to mPacketFn, until a core protocol
+     * packet ends the session.
+     */
+    int
+    mDrainNetwork(void) {
+        static const bool recvShouldBlock = false;
+        while (!mStop) {
+            int tag = 0;
+            MRN::PacketPtr packet;
+            MRN::Stream *stream = nullptr;
+            const int status = mNet->recv(
+                                   &tag, packet, &stream, recvShouldBlock
+                               );
+            if (-1 == status) return GLADIUS_ERR_MRNET;
+            if (0 == status) break;
+            if (!toolcommon::isPluginTag(tag)) {
+                std::lock_guard<std::mutex> lock(sCorePacketLock);
+                sHaveCorePacket = true;
+                sCoreTag = tag;
+                sCorePacket = packet;
+                mStop = true;
+                break;
+            }
+            mPacketFn(tag, packet, stream);
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Returns how long poll(2) may wait before the next timer is due (-1 if
+     * there are no timers).
+     */
+    int
+    mPollTimeoutInMS(void) const {
+        using namespace std::chrono;
+        int timeout = -1;
+        const auto now = Clock::now();
+        for (const auto &t : mTimers) {
+            const auto left = duration_cast<milliseconds>(t.due - now).count();
+            const int ms = int(std::max<decltype(left)>(
+                                   0, std::min<decltype(left)>(left, INT_MAX)
+                               ));
+            if (-1 == timeout || ms < timeout) timeout = ms;
+        }
+        if (mNet && -1 == mNetFD) {
+            if (-1 == timeout || sNetPollIntervalInMS < timeout) {
+                timeout = sNetPollIntervalInMS;
+            }
+        }
+        return timeout;
+    }
+
+    /**
+     *
+     */
+    void
+    mRunDueTimers(void) {
+        const auto now = Clock::now();
+        // Collect first: the handlers may change mTimers.
+        std::vector<TimerID> due;
+        for (const auto &t : mTimers) {
+            if (t.due <= now) due.push_back(t.id);
+        }
+        for (const auto id : due) {
+            if (mStop) return;
+            auto it = std::find_if(
+                          mTimers.begin(), mTimers.end(),
+                          [id](const Timer &t) { return t.id == id; }
+                      );
+            // Cancelled by an earlier handler.
+            if (mTimers.end() == it) continue;
+            TimerFn fn = it->fn;
+            if (it->repeat) {
+                it->due = now + it->period;
+            }
+            else {
+                mTimers.erase(it);
+            }
+            fn();
+        }
+    }
+
+public:
+    //
+    EventLoop(void) = default;
+
+    /**
+     * Hands packets that arrive on network to packetFn.
+     */
+    int
+    setNetwork(
+        MRN::Network *network,
+        const PacketFn &packetFn
+    ) {
+        if (!network || !packetFn) return GLADIUS_ERR;
+        mNet = network;
+        mPacketFn = packetFn;
+        mNetFD = mNet->get_EventNotificationFd(MRN::Event::DATA_EVENT);
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Calls fdFn when poll(2) says that fd has one of events. Replaces any
+     * earlier registration for fd.
+     */
+    int
+    addFD(
+        int fd,
+        short events,
+        const FDFn &fdFn
+    ) {
+        if (fd < 0 || !fdFn) return GLADIUS_ERR;
+        mFDs[fd] = std::make_pair(events, fdFn);
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     *
+     */
+    void
+    removeFD(int fd) {
+        mFDs.erase(fd);
+    }
+
+    /**
+     * Calls timerFn in periodInMS (and every periodInMS after that if
+     * repeat). Returns an ID for cancelTimer.
+     */
+    TimerID
+    addTimer(
+        unsigned periodInMS,
+        const TimerFn &timerFn,
+        bool repeat = true
+    ) {
+        const auto period = std::chrono::milliseconds(periodInMS);
+        Timer t = {
+            mNextTimerID++, Clock::now() + period, period, repeat, timerFn
+        };
+        mTimers.push_back(t);
+        return t.id;
+    }
+
+    /**
+     *
+     */
+    void
+    cancelTimer(TimerID id) {
+        mTimers.erase(
+            std::remove_if(
+                mTimers.begin(), mTimers.end(),
+                [id](const Timer &t) { return t.id == id; }
+            ),
+            mTimers.end()
+        );
+    }
+
+    /**
+     * Dispatches events until stop is called (or something fails).
+     */
+    int
+    run(void) {
+        mStop = false;
+        // Packets may have arrived before we started listening.
+        if (mNet) {
+            const int rc = mDrainNetwork();
+            if (GLADIUS_SUCCESS != rc) return rc;
+        }
+        std::vector<struct pollfd> pfds;
+        while (!mStop) {
+            pfds.clear();
+            if (-1 != mNetFD) pfds.push_back({mNetFD, POLLIN, 0});
+            for (const auto &fd : mFDs) {
+                pfds.push_back({fd.first, fd.second.first, 0});
+            }
+            const int timeout = mPollTimeoutInMS();
+            if (pfds.empty() && -1 == timeout) {
+                // Nothing can ever happen.
+                return GLADIUS_ERR;
+            }
+            if (-1 == poll(pfds.data(), pfds.size(), timeout)) {
+                if (EINTR == errno) continue;
+                return GLADIUS_ERR_SYS;
+            }
+            size_t first = 0;
+            if (mNet) {
+                if (-1 != mNetFD) {
+                    first = 1;
+                    if (pfds[0].revents) {
+                        mNet->clear_EventNotificationFd(
+                            MRN::Event::DATA_EVENT
+                        );
+                    }
+                }
+                // Without a descriptor, we look every time around.
+                if (-1 == mNetFD || pfds[0].revents) {
+                    const int rc = mDrainNetwork();
+                    if (GLADIUS_SUCCESS != rc) return rc;
+                }
+            }
+            for (size_t i = first; i < pfds.size() && !mStop; ++i) {
+                if (!pfds[i].revents) continue;
+                auto it = mFDs.find(pfds[i].fd);
+                // Removed by an earlier handler.
+                if (mFDs.end() == it) continue;
+                FDFn fn = it->second.second;
+                fn(pfds[i].revents);
+            }
+            mRunDueTimers();
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Makes run return once the current handler is done.
+     */
+    void
+    stop(void) {
+        mStop = true;
+    }
+
+    /**
+     * Back-end side: takes the core protocol packet that ended the last
+     * session, if any. Returns whether or not there was one.
+     */
+    static bool
+    takeCorePacket(
+        int &tag,
+        MRN::PacketPtr &packet
+    ) {
+        std::lock_guard<std::mutex> lock(sCorePacketLock);
+        if (!sHaveCorePacket) return false;
+        tag = sCoreTag;
+        packet = sCorePacket;
+        sHaveCorePacket = false;
+        sCorePacket = MRN::PacketPtr();
+        return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Collects results (TxMessages) and sends them upstream as one batch, either
+ * when enough have piled up or every flush interval. A batch is a TxMessage
+ * of nested messages, one per result, until its end.
+ */
+class UpstreamBatch {
+    //
+    MRN::Stream *mStream = nullptr;
+    //
+    int mTag = 0;
+    //
+    size_t mMaxEntries = 0;
+    //
+    toolcommon::TxMessageWriter mBatch;
+    //
+    size_t mNEntries = 0;
+
+public:
+    //
+    UpstreamBatch(void) = default;
+
+    /**
+     * Batches go out on stream with tag, which must be a plugin tag, once
+     * maxEntries are waiting.
+     */
+    int
+    create(
+        MRN::Stream *stream,
+        int tag,
+        size_t maxEntries
+    ) {
+        if (!stream || !toolcommon::isPluginTag(tag) || 0 == maxEntries) {
+            return GLADIUS_ERR;
+        }
+        mStream = stream;
+        mTag = tag;
+        mMaxEntries = maxEntries;
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Also flushes every flushIntervalInMS on loop.
+     */
+    EventLoop::TimerID
+    flushEvery(
+        EventLoop &loop,
+        unsigned flushIntervalInMS
+    ) {
+        return loop.addTimer(flushIntervalInMS, [this]() {
+            if (GLADIUS_SUCCESS != flush()) {
+                GLADIUS_CERR << "Upstream batch flush failed." << std::endl;
+            }
+        });
+    }
+
+    /**
+     *
+     */
+    int
+    add(const toolcommon::TxMessageWriter &entry) {
+        mBatch.putMessage(entry);
+        if (++mNEntries >= mMaxEntries) return flush();
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Sends whatever is waiting.
+     */
+    int
+    flush(void) {
+        if (0 == mNEntries) return GLADIUS_SUCCESS;
+        toolcommon::TxMessageWriter batch;
+        std::swap(batch, mBatch);
+        mNEntries = 0;
+        const int rc = batch.send(mStream, mTag);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        if (-1 == mStream->flush()) return GLADIUS_ERR_MRNET;
+        return GLADIUS_SUCCESS;
+    }
+};
+
+} // end toolbe namespace
+} // end gladius namespace
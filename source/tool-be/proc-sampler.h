@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Periodic sampling of target processes from the back-end. For each target,
+ * /proc/<pid>/{stat,status,schedstat,io} are opened once. After that, a sample
+ * costs one pread(2) per file, because procfs regenerates a file's contents
+ * when it is read from offset 0. Parsing happens in place in a fixed buffer.
+ * Samples go into a lock-free ring, so that sampling and consuming can happen
+ * on different threads.
+ */
+
+#pragma once
+
+#include "tool-be/event-loop.h"
+#include "tool-be/spsc-ring.h"
+
+#include "tool-common/proc-sample.h"
+
+#include "core/core.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+namespace gladius {
+namespace toolbe {
+
+/**
+ *
+ */
+class ProcSampler {
+    //
+    enum ProcFile {
+        Stat = 0,
+        Status,
+        SchedStat,
+        IO,
+        NProcFiles
+    };
+    //
+    struct Target {
+        int32_t uid;
+        pid_t pid;
+        // Descriptors for each ProcFile. -1 if it couldn't be opened.
+        int fds[NProcFiles];
+    };
+    //
+    std::vector<Target> mTargets;
+    //
+    SPSCRing<toolcommon::ProcSample> mRing;
+    //
+    long mPageSizeInKB = 4;
+    // Where files are read to. Used by the sampling thread only. Big enough
+    // for status, the largest of the files.
+    char mBuf[8192];
+
+    /**
+     *
+     */
+    static const char *
+    mFileName(int f) {
+        switch (f) {
+            case Stat: return "stat";
+            case Status: return "status";
+            case SchedStat: return "schedstat";
+            case IO: return "io";
+            default: return "";
+        }
+    }
+
+    /**
+     * Reads all of fd into mBuf (NUL-terminated). Returns false if it can't.
+     */
+    bool
+    mRead(int fd) {
+        if (-1 == fd) return false;
+        const ssize_t n = pread(fd, mBuf, sizeof(mBuf) - 1, 0);
+        if (n < 0) return false;
+        mBuf[n] = '\0';
+        return true;
+    }
+
+    /**
+     * Returns the number after key in mBuf (0 if key isn't there).
+     */
+    uint64_t
+    mValueAfter(const char *key) const {
+        const char *p = strstr(mBuf, key);
+        if (!p) return 0;
+        return strtoull(p + strlen(key), nullptr, 10);
+    }
+
+    /**
+     * Parses stat. The command name (in parens) may contain anything, so
+     * fields are counted from the last ')'.
+     */
+    bool
+    mParseStat(toolcommon::ProcSample &s) const {
+        const char *p = strrchr(mBuf, ')');
+        if (!p) return false;
+        // Field 3 (state) is first after the ')'.
+        for (int field = 3; *p; ++field) {
+            while (' ' == *p || ')' == *p) ++p;
+            if (!*p) break;
+            switch (field) {
+                case 3: s.state = *p; break;
+                case 14: s.utimeTicks = strtoull(p, nullptr, 10); break;
+                case 15: s.stimeTicks = strtoull(p, nullptr, 10); break;
+                case 20: s.nThreads = strtoul(p, nullptr, 10); break;
+                case 23: s.vmSizeKB = strtoull(p, nullptr, 10) / 1024; break;
+                case 24:
+                    s.rssKB = strtoull(p, nullptr, 10) * mPageSizeInKB;
+                    break;
+                case 39: s.processor = strtol(p, nullptr, 10); return true;
+                default: break;
+            }
+            while (*p && ' ' != *p) ++p;
+        }
+        // Old kernels: no processor field.
+        return true;
+    }
+
+    /**
+     *
+     */
+    static void
+    mCloseFDs(Target &t) {
+        for (int f = 0; f < NProcFiles; ++f) {
+            if (-1 != t.fds[f]) (void)close(t.fds[f]);
+            t.fds[f] = -1;
+        }
+    }
+
+public:
+    /**
+     * Keeps up to ringCapacity samples that haven't been drained.
+     */
+    explicit ProcSampler(size_t ringCapacity = 4096)
+        : mRing(ringCapacity)
+    {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        if (pageSize > 0) mPageSizeInKB = pageSize / 1024;
+    }
+
+    /**
+     *
+     */
+    ~ProcSampler(void) {
+        for (auto &t : mTargets) mCloseFDs(t);
+    }
+
+    // Not copyable.
+    ProcSampler(const ProcSampler &) = delete;
+    //
+    ProcSampler &operator=(const ProcSampler &) = delete;
+
+    // The ring is over-aligned, which plain new ignores before C++17.
+    static void *
+    operator new(size_t n) {
+        void *p = nullptr;
+        if (0 != posix_memalign(&p, alignof(ProcSampler), n)) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+    //
+    static void
+    operator delete(void *p) {
+        free(p);
+    }
+
+    /**
+     * Starts sampling pid, whose tool UID is uid. Files that can't be opened
+     * (e.g. io without permission) are skipped; stat is required.
+     */
+    int
+    addTarget(
+        int32_t uid,
+        pid_t pid
+    ) {
+        Target t;
+        t.uid = uid;
+        t.pid = pid;
+        const std::string base = "/proc/" + std::to_string(pid) + "/";
+        for (int f = 0; f < NProcFiles; ++f) {
+            const std::string path = base + mFileName(f);
+            t.fds[f] = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (-1 == t.fds[Stat]) {
+            mCloseFDs(t);
+            return GLADIUS_ERR_IO;
+        }
+        mTargets.push_back(t);
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Producer side: samples every target once. Targets that have gone away
+     * are dropped. Returns the number of samples taken.
+     */
+    size_t
+    sampleOnce(void) {
+        size_t n = 0;
+        for (auto it = mTargets.begin(); it != mTargets.end(); ) {
+            auto &t = *it;
+            toolcommon::ProcSample s;
+            s.uid = t.uid;
+            s.pid = int32_t(t.pid);
+            struct timespec ts;
+            (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+            s.timeNS = uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+            //
+            if (!mRead(t.fds[Stat]) || !mParseStat(s)) {
+                mCloseFDs(t);
+                it = mTargets.erase(it);
+                continue;
+            }
+            if (mRead(t.fds[Status])) {
+                s.hwmKB = mValueAfter("VmHWM:");
+                s.volCtxSwitches = mValueAfter("\nvoluntary_ctxt_switches:");
+                s.involCtxSwitches = mValueAfter(
+                                         "nonvoluntary_ctxt_switches:"
+                                     );
+            }
+            if (mRead(t.fds[SchedStat])) {
+                char *end = nullptr;
+                s.cpuNS = strtoull(mBuf, &end, 10);
+                s.runDelayNS = strtoull(end, nullptr, 10);
+            }
+            if (mRead(t.fds[IO])) {
+                s.readBytes = mValueAfter("\nread_bytes:");
+                s.writeBytes = mValueAfter("\nwrite_bytes:");
+            }
+            if (mRing.push(s)) ++n;
+            ++it;
+        }
+        return n;
+    }
+
+    /**
+     * Takes samples every periodInMS on loop.
+     */
+    EventLoop::TimerID
+    sampleEvery(
+        EventLoop &loop,
+        unsigned periodInMS
+    ) {
+        return loop.addTimer(periodInMS, [this]() { (void)sampleOnce(); });
+    }
+
+    /**
+     * Consumer side: moves the oldest sample out of the ring into s. Returns
+     * false if there are none.
+     */
+    bool
+    pop(toolcommon::ProcSample &s) {
+        return mRing.pop(s);
+    }
+
+    /**
+     * Returns the number of targets being sampled.
+     */
+    size_t
+    nTargets(void) const {
+        return mTargets.size();
+    }
+
+    /**
+     * Returns the number of samples lost because the ring was full.
+     */
+    size_t
+    nDropped(void) const {
+        return mRing.nDropped();
+    }
+};
+
+} // end toolbe namespace
+} // end gladius namespace
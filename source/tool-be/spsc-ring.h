@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * A bounded, lock-free, single-producer/single-consumer ring buffer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace gladius {
+namespace toolbe {
+
+/**
+ * One thread pushes, one (possibly other) thread pops. Neither ever blocks: a
+ * push to a full ring fails (and is counted), as does a pop from an empty one.
+ */
+template <class T>
+class SPSCRing {
+    //
+    std::vector<T> mElems;
+    // Capacity - 1 (the capacity is a power of two).
+    size_t mMask = 0;
+    // Next slot to pop. Written by the consumer only.
+    alignas(64) std::atomic<size_t> mHead;
+    // Next slot to push. Written by the producer only.
+    alignas(64) std::atomic<size_t> mTail;
+    // Pushes that found the ring full. Written by the producer only.
+    std::atomic<size_t> mNDropped;
+
+public:
+    /**
+     * A ring of at least capacity elements.
+     */
+    explicit SPSCRing(size_t capacity)
+        : mHead(0)
+        , mTail(0)
+        , mNDropped(0)
+    {
+        size_t c = 2;
+        while (c < capacity) c <<= 1;
+        mElems.resize(c);
+        mMask = c - 1;
+    }
+
+    // Not copyable.
+    SPSCRing(const SPSCRing &) = delete;
+    //
+    SPSCRing &operator=(const SPSCRing &) = delete;
+
+    /**
+     * Producer side. Returns false (dropping e) if the ring is full.
+     */
+    bool
+    push(const T &e) {
+        const size_t tail = mTail.load(std::memory_order_relaxed);
+        const size_t head = mHead.load(std::memory_order_acquire);
+        if (tail - head > mMask) {
+            mNDropped.store(
+                mNDropped.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed
+            );
+            return false;
+        }
+        mElems[tail & mMask] = e;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side. Returns false if the ring is empty.
+     */
+    bool
+    pop(T &e) {
+        const size_t head = mHead.load(std::memory_order_relaxed);
+        const size_t tail = mTail.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        e = mElems[head & mMask];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * An estimate (exact when called by the producer or consumer while the
+     * other is idle).
+     */
+    size_t
+    size(void) const {
+        return mTail.load(std::memory_order_acquire)
+               - mHead.load(std::memory_order_acquire);
+    }
+
+    /**
+     *
+     */
+    size_t
+    capacity(void) const {
+        return mMask + 1;
+    }
+
+    /**
+     *
+     */
+    size_t
+    nDropped(void) const {
+        return mNDropped.load(std::memory_order_relaxed);
+    }
+};
+
+} // end toolbe namespace
+} // end gladius namespace
@@ -22,6 +22,14 @@
 using namespace gladius;
 using namespace gladius::toolbe;
 
+////////////////////////////////////////////////////////////////////////////////
+// EventLoop
+////////////////////////////////////////////////////////////////////////////////
+std::mutex EventLoop::sCorePacketLock;
+bool EventLoop::sHaveCorePacket = false;
+int EventLoop::sCoreTag = 0;
+MRN::PacketPtr EventLoop::sCorePacket;
+
 ////////////////////////////////////////////////////////////////////////////////
 // ToolBE
 ////////////////////////////////////////////////////////////////////////////////
@@ -99,7 +107,16 @@ Tool::ToolBE::ToolBE(
 /**
  * Destructor.
  */
-Tool::ToolBE::~ToolBE(void) = default;
+Tool::ToolBE::~ToolBE(void)
+{
+    // A background lash-up may still be running a session that uses us.
+    (void)mMRNBE.wait();
+    // Before the plugin pack (and the plugin's code) goes away.
+    if (mBEPlugin) {
+        mPluginPack.pluginInfo->pluginDestroy(mBEPlugin);
+        mBEPlugin = nullptr;
+    }
+}
 
 /**
  *
@@ -121,6 +138,12 @@ Tool::ToolBE::create(int uid)
 {
     VCOMP_COUT("Creating tool back-end..." << std::endl);
     mUID = uid;
+    // Run each plugin session that the front-end starts.
+    mMRNBE.setPluginSessionFn(
+        [this](const std::string &name, const std::string &path) {
+            return mRunPluginSession(name, path);
+        }
+    );
     return mMRNBE.create(uid);
 }
 
@@ -133,3 +156,127 @@ Tool::ToolBE::connect(void)
     VCOMP_COUT("Connecting tool back-end..." << std::endl);
     return mMRNBE.connect();
 }
+
+/**
+ *
+ */
+int
+Tool::ToolBE::connectAsync(const Tool::ConnectedFn &fn)
+{
+    VCOMP_COUT("Connecting tool back-end in the background..." << std::endl);
+    return mMRNBE.connectAsync(fn);
+}
+
+/**
+ *
+ */
+int
+Tool::ToolBE::connectStatus(void)
+{
+    return mMRNBE.connectStatus();
+}
+
+/**
+ *
+ */
+int
+Tool::ToolBE::waitForConnect(int timeoutInMS)
+{
+    return mMRNBE.waitForConnect(timeoutInMS);
+}
+
+/**
+ *
+ */
+int
+Tool::ToolBE::wait(void)
+{
+    return mMRNBE.wait();
+}
+
+/**
+ *
+ */
+int
+Tool::ToolBE::mRunPluginSession(
+    const std::string &pluginName,
+    const std::string &pathToPluginPack
+) {
+    VCOMP_COUT("Starting " << pluginName << " session..." << std::endl);
+    mPluginName = pluginName;
+    mPathToPluginPack = pathToPluginPack;
+    // This session's front-end knows none of the event names yet.
+    mAppEvents.resendNames();
+    int rc = GLADIUS_SUCCESS;
+    try {
+        mLoadPlugins();
+        enterPluginMain();
+    }
+    catch (const std::exception &e) {
+        GLADIUS_CERR << e.what() << std::endl;
+        rc = GLADIUS_ERR;
+    }
+    // Nobody is left to resume application threads stopped by this session.
+    mAppBreakpoints.disarmAll();
+    // The session may have ended because the front-end moved on (e.g., its
+    // plugin failed before telling ours to stop). What it sent is ours.
+    int coreTag = 0;
+    MRN::PacketPtr corePacket;
+    if (EventLoop::takeCorePacket(coreTag, corePacket)) {
+        mMRNBE.putBackCorePacket(coreTag, corePacket);
+    }
+    //
+    return rc;
+}
+
+/**
+ *
+ */
+void
+Tool::ToolBE::mLoadPlugins(void)
+{
+    VCOMP_COUT("Loading plugins..." << std::endl);
+    // Done with the last session's plugin, if any.
+    if (mBEPlugin) {
+        mPluginPack.pluginInfo->pluginDestroy(mBEPlugin);
+        mBEPlugin = nullptr;
+    }
+    // Get the back-end plugin pack.
+    mPluginPack = mPluginManager.getPluginPackFrom(
+                      gpa::GladiusPluginPack::PluginBE,
+                      mPathToPluginPack
+                  );
+    auto *bePluginInfo = mPluginPack.pluginInfo;
+    if (mPluginName != bePluginInfo->pluginName) {
+        GLADIUS_THROW(
+            "Front-end and back-end plugin names differ: '" + mPluginName
+            + "' vs. '" + std::string(bePluginInfo->pluginName) + "'"
+        );
+    }
+    mBEPlugin = bePluginInfo->pluginConstruct();
+}
+
+/**
+ *
+ */
+void
+Tool::ToolBE::enterPluginMain(void)
+{
+    VCOMP_COUT("Entering plugin main..." << std::endl);
+    //
+    gpi::GladiusPluginArgs pluginArgs(
+        mPathToPluginPack,
+        core::Args(),
+        mMRNBE.getProtoStream(),
+        mMRNBE.getNetwork(),
+        mUID
+    );
+    pluginArgs.appEvents = &mAppEvents;
+    pluginArgs.appBreakpoints = &mAppBreakpoints;
+    ////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////
+    // Back-end Plugin Entry Point.
+    mBEPlugin->pluginMain(pluginArgs);
+    ////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////
+}
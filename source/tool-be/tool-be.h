@@ -16,6 +16,8 @@
 
 #include "core/core.h"
 #include "mrnet/mrnet-be.h"
+#include "tool-be/app-breakpoints.h"
+#include "tool-be/app-event-queue.h"
 #include "plugin/core/gp-manager.h"
 #include "plugin/core/gladius-plugin.h"
 
@@ -42,9 +44,19 @@ private:
     gpa::GladiusPluginPack mPluginPack;
     // The plugin instance pointer.
     gpi::GladiusPlugin *mBEPlugin = nullptr;
+    // Where the application leaves events for the back-end plugin.
+    AppEventQueue mAppEvents;
+    // Where the back-end plugin can stop application threads.
+    AppBreakpoints mAppBreakpoints;
     //
     void
     mLoadPlugins(void);
+    //
+    int
+    mRunPluginSession(
+        const std::string &pluginName,
+        const std::string &pathToPluginPack
+    );
 
 public:
     //
@@ -61,11 +73,33 @@ public:
     int
     connect(void);
     //
+    int
+    connectAsync(const Tool::ConnectedFn &fn);
+    //
+    int
+    connectStatus(void);
+    //
+    int
+    waitForConnect(int timeoutInMS);
+    //
+    int
+    wait(void);
+    //
     static int
     redirectOutputTo(const std::string &base);
     //
     void
     enterPluginMain(void);
+    //
+    AppEventQueue &
+    appEvents(void) {
+        return mAppEvents;
+    }
+    //
+    AppBreakpoints &
+    appBreakpoints(void) {
+        return mAppBreakpoints;
+    }
 };
 
 } // end toolbe namespace
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Events and counters recorded by instrumented applications through the tool
+ * API (see Tool::recordEvent), and the batches that carry them upstream.
+ */
+
+#pragma once
+
+#include "tool-common/tx-message.h"
+
+#include "core/gladius-rc.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gladius {
+namespace toolcommon {
+
+/**
+ * One application event. Trivially copyable, so that it can go through
+ * lock-free queues and messages as-is.
+ */
+struct AppEvent {
+    // The number of integer arguments that an event can carry.
+    static constexpr int NArgs = 4;
+    //
+    enum Kind : uint32_t {
+        // Something happened at timeNS.
+        Mark = 0,
+        // A counter had value at timeNS.
+        Counter
+    };
+    // When (CLOCK_MONOTONIC) the event was recorded.
+    uint64_t timeNS = 0;
+    // The event's name ID (see AppEventBatch::names).
+    uint32_t id = 0;
+    //
+    uint32_t kind = Mark;
+    // The application thread that recorded the event, numbered in order of
+    // first use.
+    uint32_t thread = 0;
+    // The number of args in use.
+    uint32_t nArgs = 0;
+    // Counters only.
+    double value = 0.0;
+    // Marks only: what the application said about the event (e.g., IDs).
+    uint64_t args[NArgs] = {0, 0, 0, 0};
+};
+// One cache line, so that neighboring records don't share one.
+static_assert(sizeof(AppEvent) == 64, "Unexpected AppEvent size");
+
+/**
+ * What a back-end sends upstream: the events that it drained, with the names
+ * that were registered since its last batch.
+ */
+struct AppEventBatch {
+    // The tool UID (target rank) that recorded the events.
+    int32_t uid = -1;
+    // Events lost so far because an application thread's queue was full.
+    uint64_t nDropped = 0;
+    // (ID, name) pairs new since the last batch.
+    std::vector<std::pair<uint32_t, std::string>> names;
+    //
+    std::vector<AppEvent> events;
+
+    /**
+     *
+     */
+    bool
+    empty(void) const {
+        return names.empty() && events.empty();
+    }
+
+    /**
+     *
+     */
+    void
+    clear(void) {
+        names.clear();
+        events.clear();
+    }
+
+    /**
+     *
+     */
+    void
+    pack(TxMessageWriter &msg) const {
+        msg.put(uid).put(nDropped).put(uint32_t(names.size()));
+        for (const auto &n : names) {
+            msg.put(n.first).putStr(n.second);
+        }
+        msg.putArray(events.data(), events.size());
+    }
+
+    /**
+     *
+     */
+    int
+    unpack(TxMessage &msg) {
+        clear();
+        uint32_t nNames = 0;
+        if (!msg.get(uid) || !msg.get(nDropped) || !msg.get(nNames)) {
+            return GLADIUS_ERR;
+        }
+        for (uint32_t i = 0; i < nNames; ++i) {
+            uint32_t id = 0;
+            std::string name;
+            if (!msg.get(id) || !msg.getStr(name)) return GLADIUS_ERR;
+            names.emplace_back(id, std::move(name));
+        }
+        TxListView<AppEvent> es;
+        if (!msg.getArray(es)) return GLADIUS_ERR;
+        events.assign(es.begin(), es.end());
+        return GLADIUS_SUCCESS;
+    }
+};
+
+} // end toolcommon namespace
+} // end gladius namespace
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * How Legion profiling records (processor descriptions, task kinds, and task
+ * executions) are carried as application events (see AppEvent): the event
+ * names that they are recorded under, and what their arguments mean. Shared by
+ * the recording side (tool-api/gladius-legion-prof.h) and the lprof plugin.
+ * Depends on nothing, so that applications can include it.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace gladius {
+namespace toolcommon {
+namespace legionprof {
+
+// A processor. args: processor ID, processor kind (Legion's Processor::Kind).
+static const char *const ProcDescName = "legion.prof.proc_desc";
+// A task kind. The kind's name follows the prefix. args: task ID.
+static const char *const TaskKindPrefix = "legion.prof.task_kind:";
+// A task execution. args: unique ID (high 32 bits) and task ID (low 32 bits),
+// processor ID, start and stop times (in nanoseconds).
+static const char *const TaskInfoName = "legion.prof.task_info";
+
+/**
+ * Returns the event name that a task kind called name is recorded under. The
+ * log format only allows [a-zA-Z0-9_] in names, so anything else becomes '_'.
+ */
+inline std::string
+taskKindEventName(const std::string &name) {
+    std::string n = name.empty() ? "unnamed" : name;
+    for (auto &c : n) {
+        const bool ok = ('_' == c) || ('0' <= c && c <= '9') ||
+                        ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+        if (!ok) c = '_';
+    }
+    return TaskKindPrefix + n;
+}
+
+} // end legionprof namespace
+} // end toolcommon namespace
+} // end gladius namespace
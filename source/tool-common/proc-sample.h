@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Samples of target process state, as read from /proc by the back-ends.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace gladius {
+namespace toolcommon {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * One look at one target.
+ */
+struct ProcSample {
+    // The target's tool UID (rank).
+    int32_t uid = -1;
+    //
+    int32_t pid = -1;
+    // When the sample was taken (CLOCK_MONOTONIC, so only good for
+    // differences between samples of the same target).
+    uint64_t timeNS = 0;
+    // From stat (in clock ticks).
+    uint64_t utimeTicks = 0;
+    uint64_t stimeTicks = 0;
+    // From schedstat: time on a CPU and time waiting for one.
+    uint64_t cpuNS = 0;
+    uint64_t runDelayNS = 0;
+    // From stat and status.
+    uint64_t vmSizeKB = 0;
+    uint64_t rssKB = 0;
+    uint64_t hwmKB = 0;
+    // From io (storage I/O, not page cache hits).
+    uint64_t readBytes = 0;
+    uint64_t writeBytes = 0;
+    // From status.
+    uint64_t volCtxSwitches = 0;
+    uint64_t involCtxSwitches = 0;
+    //
+    uint32_t nThreads = 0;
+    // The CPU that the target last ran on.
+    int32_t processor = -1;
+    // R, S, D, Z, T, etc.
+    char state = '?';
+};
+
+} // end toolcommon namespace
+} // end gladius namespace
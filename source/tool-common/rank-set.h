@@ -0,0 +1,23 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * RankSet lives in core (see core/rank-set.h), so that core types like
+ * ProcessLandscape can use it. Tool code knows it by its old name.
+ */
+
+#pragma once
+
+#include "core/rank-set.h"
+
+namespace gladius {
+namespace toolcommon {
+//
+using core::RankSet;
+} // end toolcommon namespace
+} // end gladius namespace
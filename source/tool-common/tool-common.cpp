@@ -11,6 +11,9 @@
 
 #include "mrnet/MRNet.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace gladius;
 using namespace gladius::toolcommon;
 
@@ -40,12 +43,187 @@ ProcessTable::dumpTo(
         return;
     }
     for (decltype(mNEntries) i = 0; i < mNEntries; ++i) {
-        os << outp << "Host Name: " << mProcTab[i].pd.host_name << endl;
+        const auto &pd = mProcTab[i].pd;
+        os << outp << "Host Name: "
+           << (pd.host_name ? pd.host_name : "(null)") << endl;
         os << outp << "Executable Name: "
-           << mProcTab[i].pd.executable_name << endl;
+           << (pd.executable_name ? pd.executable_name : "(null)") << endl;
         os << outp << "PID: " << mProcTab[i].pd.pid << " "
            // TID: "Task ID"
            << "TID: " << mProcTab[i].mpirank
            << endl;
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// StringArena
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the interned copy of s, copying s into the arena if it is new.
+ */
+const char *
+StringArena::intern(const char *s)
+{
+    if (!s) return nullptr;
+    auto found = mStrings.find(s);
+    if (found != mStrings.end()) return *found;
+    //
+    const size_t len = strlen(s) + 1;
+    if (len > mBlockLeft) {
+        // Strings that are larger than a block get their own.
+        const size_t blockSize = std::max(len, size_t(sBlockSize));
+        mBlocks.emplace_back(new char[blockSize]);
+        mNext = mBlocks.back().get();
+        mBlockLeft = blockSize;
+    }
+    char *res = mNext;
+    memcpy(res, s, len);
+    mNext += len;
+    mBlockLeft -= len;
+    mStrings.insert(res);
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ProcessTable
+////////////////////////////////////////////////////////////////////////////////
+const uint32_t ProcessTable::sNoEntry;
+
+/**
+ * Makes this (empty) table a copy of other. Strings are interned into our own
+ * arena, so each distinct string is copied once.
+ */
+void
+ProcessTable::mCopyFrom(const ProcessTable &other)
+{
+    mAllocate(other.mNEntries);
+    for (decltype(mNEntries) i = 0; i < mNEntries; ++i) {
+        const auto &from = other.mProcTab[i];
+        setEntry(
+            i,
+            from.pd.host_name,
+            from.pd.executable_name,
+            from.pd.pid,
+            from.mpirank,
+            from.cnodeid
+        );
+    }
+}
+
+/**
+ * Sets entry number entry. Names are interned, so callers keep ownership of
+ * the strings they pass in.
+ */
+void
+ProcessTable::setEntry(
+    size_t entry,
+    const char *hostName,
+    const char *executableName,
+    int pid,
+    int mpiRank,
+    int cnodeID
+) {
+    if (entry >= mNEntries) {
+        GLADIUS_THROW_INVLD_ARG();
+    }
+    auto &e = mProcTab[entry];
+    e.pd.host_name = const_cast<char *>(mStrings.intern(hostName));
+    e.pd.executable_name = const_cast<char *>(mStrings.intern(executableName));
+    e.pd.pid = pid;
+    e.mpirank = mpiRank;
+    e.cnodeid = cnodeID;
+    mIndexDirty = true;
+}
+
+/**
+ * Rebuilds the rank and host indices in one pass over the table.
+ */
+void
+ProcessTable::mBuildIndex(void) const
+{
+    mRankToEntry.clear();
+    mSparseRankToEntry.clear();
+    mHostNames.clear();
+    mHostIDs.clear();
+    mHostRanks.clear();
+    mHostNameSet.clear();
+    //
+    int maxRank = -1;
+    for (decltype(mNEntries) i = 0; i < mNEntries; ++i) {
+        maxRank = std::max(maxRank, mProcTab[i].mpirank);
+    }
+    // Use a flat map when ranks are (about) dense, which is the usual case.
+    const bool dense = (maxRank >= 0)
+                    && (size_t(maxRank) < (2 * size_t(mNEntries)) + 1024);
+    if (dense) mRankToEntry.assign(maxRank + 1, sNoEntry);
+    //
+    for (decltype(mNEntries) i = 0; i < mNEntries; ++i) {
+        const auto &e = mProcTab[i];
+        if (e.mpirank >= 0) {
+            if (dense) mRankToEntry[e.mpirank] = i;
+            else mSparseRankToEntry[e.mpirank] = i;
+        }
+        if (!e.pd.host_name) continue;
+        // Interned names, so the pointer is the identity.
+        const char *hn = e.pd.host_name;
+        auto found = mHostIDs.find(hn);
+        uint32_t hid = 0;
+        if (found == mHostIDs.end()) {
+            hid = mHostNames.size();
+            mHostIDs.insert(std::make_pair(hn, hid));
+            mHostNames.push_back(hn);
+            mHostRanks.push_back(RankSet());
+            mHostNameSet.insert(hn);
+        }
+        else {
+            hid = found->second;
+        }
+        if (e.mpirank >= 0) mHostRanks[hid].insert(e.mpirank);
+    }
+    mIndexDirty = false;
+}
+
+/**
+ * Returns the entry for the given MPI rank, or nullptr if there is none. O(1).
+ */
+const MPIR_PROCDESC_EXT *
+ProcessTable::entryForRank(int mpiRank) const
+{
+    mEnsureIndex();
+    if (mpiRank < 0) return nullptr;
+    if (!mRankToEntry.empty()) {
+        if (size_t(mpiRank) >= mRankToEntry.size()) return nullptr;
+        const uint32_t e = mRankToEntry[mpiRank];
+        return (sNoEntry == e) ? nullptr : &mProcTab[e];
+    }
+    auto found = mSparseRankToEntry.find(mpiRank);
+    return (found == mSparseRankToEntry.end()) ? nullptr
+                                               : &mProcTab[found->second];
+}
+
+/**
+ * Returns the ID of the given host, or -1 if it is not in the table. O(1).
+ */
+int
+ProcessTable::hostID(const std::string &hostName) const
+{
+    mEnsureIndex();
+    const char *hn = mStrings.find(hostName.c_str());
+    if (!hn) return -1;
+    auto found = mHostIDs.find(hn);
+    return (found == mHostIDs.end()) ? -1 : int(found->second);
+}
+
+/**
+ * Returns the ID of the host that the given MPI rank is on, or -1 if the rank
+ * is not in the table. O(1).
+ */
+int
+ProcessTable::hostIDOfRank(int mpiRank) const
+{
+    const auto *e = entryForRank(mpiRank);
+    if (!e || !e->pd.host_name) return -1;
+    // Interned names, so no string compares.
+    auto found = mHostIDs.find(e->pd.host_name);
+    return (found == mHostIDs.end()) ? -1 : int(found->second);
+}
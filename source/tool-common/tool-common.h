@@ -16,6 +16,7 @@
 
 #include "tool-common/faux-mpir.h"
 #include "tool-common/gladius-tli.h"
+#include "tool-common/rank-set.h"
 
 #include "core/core.h"
 #include "core/utils.h"
@@ -24,10 +25,13 @@
 #include <cstdint>
 #include <string>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <cstdlib>
 #include <ostream>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include <limits.h>
 
@@ -63,6 +67,9 @@ genNotInPathErrString(
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 static const int GladiusFirstApplicationTag = GLADIUS_MRNET_FIRST_APP_TAG;
+// Tool back-end threads take MRNet ranks from this base up (see MRNetBE), so a
+// back-end's UID is its MRNet rank less the base.
+static const int GladiusBEMRNetRankBase = 10000;
 enum MRNetCoreTags {
     // Tag for initial lash-up handshake.
     InitHandshake = GladiusFirstApplicationTag,
@@ -72,10 +79,31 @@ enum MRNetCoreTags {
     BackEndPluginsReady,
     // Shutdown tag.
     Shutdown,
+    // Heartbeat configuration (FE to BEs) and heartbeats (BEs to FE).
+    Heartbeat,
     // First plugin tag.
     FirstPluginTag
 };
 
+/**
+ * Returns whether or not tag is one that plugins may use. Tags below
+ * FirstPluginTag belong to the core protocol.
+ */
+constexpr bool
+isPluginTag(int tag) {
+    return tag >= FirstPluginTag;
+}
+
+/**
+ * Checks, at compile time, that a plugin's protocol tags start at or above
+ * FirstPluginTag. For example: GLADIUS_CHECK_PLUGIN_TAG(hello::SayHello);
+ */
+#define GLADIUS_CHECK_PLUGIN_TAG(tag)                                          \
+static_assert(                                                                 \
+    gladius::toolcommon::isPluginTag(tag),                                     \
+    #tag " collides with core protocol tags (must be >= FirstPluginTag)"       \
+)
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 /**
@@ -86,7 +114,7 @@ template <class T>
 class TxList {
     //
     T *
-    dupElems(size_t ne, T *es)
+    dupElems(size_t ne, const T *es)
     {
         if (0 == ne || !es) return nullptr;
         auto res = (T *)calloc(ne, sizeof(T));
@@ -95,6 +123,18 @@ class TxList {
         return res;
     }
 
+    /**
+     *
+     */
+    void
+    mFree(void) {
+        if (elems) {
+            free(elems);
+            elems = nullptr;
+        }
+        nElems = 0;
+    }
+
 public:
     // The length of the elems array.
     size_t nElems = 0;
@@ -112,20 +152,25 @@ public:
      *
      */
     ~TxList(void) {
-        if (elems) {
-            free(elems);
-            elems = nullptr;
-        }
-        nElems = 0;
+        mFree();
     }
 
     /**
      * Copy constructor.
      */
     TxList(const TxList &other)
+        : nElems(other.nElems)
+        , elems(dupElems(other.nElems, other.elems)) { ; }
+
+    /**
+     * Move constructor. Steals other's elements.
+     */
+    TxList(TxList &&other) noexcept
+        : nElems(other.nElems)
+        , elems(other.elems)
     {
-        nElems = other.nElems;
-        elems = dupElems(nElems, other.elems);
+        other.nElems = 0;
+        other.elems = nullptr;
     }
 
     /**
@@ -134,22 +179,296 @@ public:
     TxList &
     operator=(const TxList &other)
     {
-        nElems = other.nElems;
-        elems = dupElems(nElems, other.elems);
+        if (this != &other) {
+            T *newElems = dupElems(other.nElems, other.elems);
+            mFree();
+            elems = newElems;
+            nElems = other.nElems;
+        }
+        return *this;
+    }
+
+    /**
+     *
+     */
+    TxList &
+    operator=(TxList &&other) noexcept
+    {
+        if (this != &other) {
+            mFree();
+            elems = other.elems;
+            nElems = other.nElems;
+            other.elems = nullptr;
+            other.nElems = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * Returns a TxList that takes ownership of es, which must have been
+     * allocated with malloc(3) (e.g. an array from MRN::Packet::unpack).
+     */
+    static TxList
+    adopt(
+        T *es,
+        size_t ne
+    ) {
+        TxList res;
+        res.elems = es;
+        res.nElems = es ? ne : 0;
+        return res;
+    }
+
+    /**
+     * Gives up ownership of the elements (e.g. to a packet that frees its
+     * data) and returns them. Sets ne to their number.
+     */
+    T *
+    release(size_t &ne) {
+        T *res = elems;
+        ne = nElems;
+        elems = nullptr;
+        nElems = 0;
+        return res;
+    }
+};
+
+/**
+ * A non-owning, read-only view of an array of T. Cheap to copy and pass by
+ * value. The viewed memory must outlive the view.
+ */
+template <class T>
+class TxListView {
+    //
+    const T *mElems = nullptr;
+    //
+    size_t mNElems = 0;
+
+public:
+    //
+    TxListView(void) = default;
+
+    /**
+     *
+     */
+    TxListView(
+        const T *es,
+        size_t ne
+    ) : mElems(es)
+      , mNElems(es ? ne : 0) { ; }
+
+    /**
+     *
+     */
+    TxListView(
+        const TxList<T> &list
+    ) : mElems(list.elems)
+      , mNElems(list.nElems) { ; }
+
+    /**
+     *
+     */
+    TxListView(
+        const std::vector<T> &vec
+    ) : mElems(vec.data())
+      , mNElems(vec.size()) { ; }
+
+    /**
+     * Returns the number of elements in view.
+     */
+    size_t
+    size(void) const {
+        return mNElems;
+    }
+
+    /**
+     *
+     */
+    bool
+    empty(void) const {
+        return 0 == mNElems;
+    }
+
+    /**
+     *
+     */
+    const T *
+    data(void) const {
+        return mElems;
+    }
+
+    /**
+     *
+     */
+    const T &
+    operator[](size_t i) const {
+        return mElems[i];
+    }
+
+    /**
+     *
+     */
+    const T *
+    begin(void) const {
+        return mElems;
+    }
+
+    /**
+     *
+     */
+    const T *
+    end(void) const {
+        return mElems + mNElems;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Stores each distinct string once in large blocks. Interned strings have
+ * stable addresses for the life of the arena (moves included), so equal
+ * strings can be compared by pointer.
+ */
+class StringArena {
+    //
+    static constexpr size_t sBlockSize = 64 * 1024;
+
+    /**
+     * FNV-1a over a C string.
+     */
+    struct CStrHash {
+        size_t
+        operator()(const char *s) const {
+            size_t h = 14695981039346656037ULL;
+            for (; *s; ++s) {
+                h ^= (unsigned char)*s;
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
+    };
+
+    /**
+     *
+     */
+    struct CStrEq {
+        bool
+        operator()(const char *a, const char *b) const {
+            return 0 == strcmp(a, b);
+        }
+    };
+    // String storage.
+    std::vector<std::unique_ptr<char[]> > mBlocks;
+    // Bytes left in the current (last) block.
+    size_t mBlockLeft = 0;
+    // Next free byte in the current block.
+    char *mNext = nullptr;
+    // The interned strings (pointers into mBlocks).
+    std::unordered_set<const char *, CStrHash, CStrEq> mStrings;
+
+public:
+    //
+    StringArena(void) = default;
+    //
+    StringArena(const StringArena &other) = delete;
+    //
+    StringArena &
+    operator=(const StringArena &other) = delete;
+    /**
+     * Takes other's strings. other is left empty, so that it can't write into
+     * blocks that it no longer owns.
+     */
+    StringArena(StringArena &&other)
+        : mBlocks(std::move(other.mBlocks))
+        , mBlockLeft(other.mBlockLeft)
+        , mNext(other.mNext)
+        , mStrings(std::move(other.mStrings))
+    {
+        other.clear();
+    }
+
+    /**
+     * Same as the move constructor.
+     */
+    StringArena &
+    operator=(StringArena &&other) {
+        if (this != &other) {
+            mBlocks = std::move(other.mBlocks);
+            mBlockLeft = other.mBlockLeft;
+            mNext = other.mNext;
+            mStrings = std::move(other.mStrings);
+            other.clear();
+        }
         return *this;
     }
+    //
+    const char *
+    intern(const char *s);
+
+    /**
+     * Returns the interned copy of s, or nullptr if s was never interned.
+     */
+    const char *
+    find(const char *s) const {
+        if (!s) return nullptr;
+        auto found = mStrings.find(s);
+        return (found == mStrings.end()) ? nullptr : *found;
+    }
+
+    /**
+     * Returns the number of distinct strings.
+     */
+    size_t
+    size(void) const {
+        return mStrings.size();
+    }
+
+    /**
+     *
+     */
+    void
+    clear(void) {
+        mStrings.clear();
+        mBlocks.clear();
+        mBlockLeft = 0;
+        mNext = nullptr;
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 /**
- * Process table class.
+ * Process table class. Entries keep the MPIR layout, but live in one
+ * allocation and their host and executable names are interned, so a table of
+ * N processes on H hosts costs one entry array plus H + (number of distinct
+ * executables) strings. Lookups by rank and by host go through a cached index
+ * that is rebuilt lazily after the table changes.
+ *
+ * NOTE: the cached index makes const lookups not thread-safe.
  */
 class ProcessTable {
+    //
+    static constexpr uint32_t sNoEntry = UINT32_MAX;
     //
     unsigned int mNEntries = 0;
     //
     MPIR_PROCDESC_EXT *mProcTab = nullptr;
+    // Owns every host_name and executable_name in mProcTab.
+    StringArena mStrings;
+    // Whether or not the cached index below needs to be rebuilt.
+    mutable bool mIndexDirty = true;
+    // Rank to entry index when ranks are dense, else empty.
+    mutable std::vector<uint32_t> mRankToEntry;
+    // Rank to entry index when ranks are sparse.
+    mutable std::unordered_map<int, uint32_t> mSparseRankToEntry;
+    // Host ID to (interned) host name.
+    mutable std::vector<const char *> mHostNames;
+    // Interned host name to host ID. Keyed by pointer.
+    mutable std::unordered_map<const char *, uint32_t> mHostIDs;
+    // Host ID to the ranks on that host.
+    mutable std::vector<RankSet> mHostRanks;
+    // Cached result of hostNamesInTable.
+    mutable std::set<std::string> mHostNameSet;
 
     /**
      * Allocates space for process table.
@@ -157,6 +476,8 @@ class ProcessTable {
     void
     mAllocate(size_t nEntries) {
         mNEntries = nEntries;
+        mIndexDirty = true;
+        if (0 == nEntries) return;
         // Now that we know this, allocate the process table.
         mProcTab = (MPIR_PROCDESC_EXT *)calloc(nEntries, sizeof(*mProcTab));
         if (!mProcTab) GLADIUS_THROW_OOR();
@@ -168,46 +489,26 @@ class ProcessTable {
     void
     mDeallocate(void) {
         if (mProcTab) {
-            for (decltype(mNEntries) i = 0; i < mNEntries; ++i) {
-                if (mProcTab[i].pd.executable_name) {
-                    free(mProcTab[i].pd.executable_name);
-                }
-                if (mProcTab[i].pd.host_name) {
-                    free(mProcTab[i].pd.host_name);
-                }
-            }
             free(mProcTab);
             mProcTab = nullptr;
         }
+        mStrings.clear();
         mNEntries = 0;
+        mIndexDirty = true;
     }
+    //
+    void
+    mCopyFrom(const ProcessTable &other);
+    //
+    void
+    mBuildIndex(void) const;
 
     /**
      *
      */
-    static MPIR_PROCDESC_EXT *
-    dupMPIRProcDescExt(
-        unsigned int nEntries,
-        MPIR_PROCDESC_EXT *from
-    ) {
-        if (!from || 0 == nEntries) return nullptr;
-        MPIR_PROCDESC_EXT *res = nullptr;
-        res = (MPIR_PROCDESC_EXT *)calloc(nEntries, sizeof(*res));
-        if (!res) GLADIUS_THROW_OOR();
-        for (decltype(nEntries) i = 0; i < nEntries; ++i) {
-            res[i].cnodeid = from[i].cnodeid;
-            res[i].mpirank = from[i].mpirank;
-            res[i].pd.pid = from[i].pd.pid;
-            if (from[i].pd.host_name) {
-                res[i].pd.host_name = strdup(from[i].pd.host_name);
-                if (!res[i].pd.host_name) GLADIUS_THROW_OOR();
-            }
-            if (from[i].pd.executable_name) {
-                res[i].pd.executable_name = strdup(from[i].pd.executable_name);
-                if (!res[i].pd.executable_name) GLADIUS_THROW_OOR();
-            }
-        }
-        return res;
+    void
+    mEnsureIndex(void) const {
+        if (mIndexDirty) mBuildIndex();
     }
 
 public:
@@ -228,8 +529,22 @@ public:
     ProcessTable(
         const ProcessTable &other
     ) {
-        mNEntries = other.mNEntries;
-        mProcTab = dupMPIRProcDescExt(mNEntries, other.mProcTab);
+        mCopyFrom(other);
+    }
+
+    /**
+     * Move constructor. Steals other's table and strings.
+     */
+    ProcessTable(
+        ProcessTable &&other
+    ) noexcept
+        : mNEntries(other.mNEntries)
+        , mProcTab(other.mProcTab)
+        , mStrings(std::move(other.mStrings))
+    {
+        other.mNEntries = 0;
+        other.mProcTab = nullptr;
+        other.mIndexDirty = true;
     }
 
     /**
@@ -246,8 +561,29 @@ public:
     operator=(
         const ProcessTable &other
     ) {
-        mNEntries = other.mNEntries;
-        mProcTab = dupMPIRProcDescExt(mNEntries, other.mProcTab);
+        if (this != &other) {
+            mDeallocate();
+            mCopyFrom(other);
+        }
+        return *this;
+    }
+
+    /**
+     *
+     */
+    ProcessTable &
+    operator=(
+        ProcessTable &&other
+    ) noexcept {
+        if (this != &other) {
+            mDeallocate();
+            mNEntries = other.mNEntries;
+            mProcTab = other.mProcTab;
+            mStrings = std::move(other.mStrings);
+            other.mNEntries = 0;
+            other.mProcTab = nullptr;
+            other.mIndexDirty = true;
+        }
         return *this;
     }
     //
@@ -257,6 +593,16 @@ public:
         const std::string &outPrefix = "",
         core::colors::Color color = core::colors::Color::NONE
     ) const;
+    //
+    void
+    setEntry(
+        size_t entry,
+        const char *hostName,
+        const char *executableName,
+        int pid,
+        int mpiRank,
+        int cnodeID = 0
+    );
 
     /**
      * Returns the number of entries in the process table.
@@ -267,23 +613,65 @@ public:
     };
 
     /**
-     * Returns pointer to the process table.
+     * Returns pointer to the (read-only) process table. Use setEntry to change
+     * it.
      */
-    MPIR_PROCDESC_EXT *
-    procTab(void) {
+    const MPIR_PROCDESC_EXT *
+    procTab(void) const {
         return mProcTab;
     }
 
     /**
-     * Returns a set of node (host) names.
+     * Returns a read-only view of the process table.
      */
-    std::set<std::string>
+    TxListView<MPIR_PROCDESC_EXT>
+    entries(void) const {
+        return TxListView<MPIR_PROCDESC_EXT>(mProcTab, mNEntries);
+    }
+    //
+    const MPIR_PROCDESC_EXT *
+    entryForRank(int mpiRank) const;
+    //
+    int
+    hostID(const std::string &hostName) const;
+    //
+    int
+    hostIDOfRank(int mpiRank) const;
+
+    /**
+     * Returns the number of distinct hosts in the table.
+     */
+    size_t
+    nHosts(void) const {
+        mEnsureIndex();
+        return mHostNames.size();
+    }
+
+    /**
+     * Returns the name of the host with the given ID.
+     */
+    const char *
+    hostName(size_t hostID) const {
+        mEnsureIndex();
+        return mHostNames.at(hostID);
+    }
+
+    /**
+     * Returns the ranks on the host with the given ID.
+     */
+    const RankSet &
+    ranksOnHost(size_t hostID) const {
+        mEnsureIndex();
+        return mHostRanks.at(hostID);
+    }
+
+    /**
+     * Returns a set of node (host) names. Cached.
+     */
+    const std::set<std::string> &
     hostNamesInTable(void) const {
-        std::set<std::string> nameSet;
-        for (decltype(mNEntries) te = 0; te < mNEntries; ++te) {
-            nameSet.insert(mProcTab[te].pd.host_name);
-        }
-        return nameSet;
+        mEnsureIndex();
+        return mHostNameSet;
     }
 };
 
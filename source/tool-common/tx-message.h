@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Gladius protocol messages. A message's fields (scalars, strings, and arrays
+ * of scalars) are packed into one contiguous buffer that travels as a single
+ * MRNet byte array. The receiver unpacks that buffer once and reads typed
+ * views into it, so there are no per-field heap allocations (and nothing for
+ * callers to free). Fields are read back in the order that they were written.
+ */
+
+#pragma once
+
+#include "tool-common/tool-common.h"
+
+#include "core/core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mrnet/MRNet.h"
+
+// The MRNet format of every TxMessage.
+#define GLADIUS_TX_MESSAGE_FMT "%auc"
+
+namespace gladius {
+namespace toolcommon {
+
+// Where nested messages start. Received buffers come from malloc(3), so they
+// are at least this aligned.
+static const size_t sTxMessageAlign = alignof(std::max_align_t);
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Packs message fields into a contiguous buffer. Every field starts at an
+ * offset that is a multiple of its alignment, so that arrays can be viewed in
+ * place by the receiver. Strings and arrays are prefixed by their lengths.
+ */
+class TxMessageWriter {
+    //
+    std::vector<unsigned char> mBuf;
+
+    /**
+     * Pads the buffer to a multiple of align, then appends n bytes from p.
+     */
+    void
+    mAppend(
+        const void *p,
+        size_t n,
+        size_t align
+    ) {
+        const size_t start = (mBuf.size() + align - 1) / align * align;
+        mBuf.resize(start + n);
+        if (n) (void)memcpy(mBuf.data() + start, p, n);
+    }
+
+public:
+    //
+    TxMessageWriter(void) = default;
+
+    /**
+     * Pre-sizes the buffer for messages of about nBytes.
+     */
+    explicit TxMessageWriter(size_t nBytes) {
+        mBuf.reserve(nBytes);
+    }
+
+    /**
+     * Appends a scalar (or any other trivially copyable value).
+     */
+    template <class T>
+    TxMessageWriter &
+    put(const T &v) {
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "TxMessage fields must be trivially copyable"
+        );
+        mAppend(&v, sizeof(T), alignof(T));
+        return *this;
+    }
+
+    /**
+     * Appends an array of ne T's.
+     */
+    template <class T>
+    TxMessageWriter &
+    putArray(
+        const T *es,
+        size_t ne
+    ) {
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "TxMessage fields must be trivially copyable"
+        );
+        put(uint64_t(es ? ne : 0));
+        mAppend(es, es ? sizeof(T) * ne : 0, alignof(T));
+        return *this;
+    }
+
+    /**
+     *
+     */
+    template <class T>
+    TxMessageWriter &
+    putArray(TxListView<T> es) {
+        return putArray(es.data(), es.size());
+    }
+
+    /**
+     * Appends a string. It is NUL-terminated on the wire, so the receiver can
+     * use it as a C string in place.
+     */
+    TxMessageWriter &
+    putStr(
+        const char *s,
+        size_t len
+    ) {
+        put(uint64_t(len));
+        mAppend(s, len, 1);
+        mBuf.push_back('\0');
+        return *this;
+    }
+
+    /**
+     *
+     */
+    TxMessageWriter &
+    putStr(const std::string &s) {
+        return putStr(s.data(), s.size());
+    }
+
+    /**
+     * Appends (a copy of) another message. Nested messages start on a
+     * max-aligned offset, so views into them are as aligned as views into any
+     * other message.
+     */
+    TxMessageWriter &
+    putMessage(const TxMessageWriter &m) {
+        put(uint64_t(m.size()));
+        mAppend(m.data(), m.size(), sTxMessageAlign);
+        return *this;
+    }
+
+    /**
+     *
+     */
+    const unsigned char *
+    data(void) const {
+        return mBuf.data();
+    }
+
+    /**
+     *
+     */
+    size_t
+    size(void) const {
+        return mBuf.size();
+    }
+
+    /**
+     * Sends the message on stream with tag. Does not flush.
+     */
+    int
+    send(
+        MRN::Stream *stream,
+        int tag
+    ) const {
+        if (!stream) return GLADIUS_ERR;
+        // MRNet copies the array, so mBuf stays ours.
+        if (-1 == stream->send(
+                      tag,
+                      GLADIUS_TX_MESSAGE_FMT,
+                      mBuf.data(),
+                      int(mBuf.size())
+                  )) {
+            return GLADIUS_ERR_MRNET;
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Like send, but for plugins: tag must not be a core protocol tag.
+     */
+    int
+    pluginSend(
+        MRN::Stream *stream,
+        int tag
+    ) const {
+        if (!isPluginTag(tag)) return GLADIUS_ERR;
+        return send(stream, tag);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * A received message. Owns the packet's single buffer and hands out views into
+ * it, which are valid for as long as the TxMessage is. Reads past the end of
+ * the message (or of a field) fail, after which every read fails.
+ */
+class TxMessage {
+    // Owns the bytes of messages that came out of a packet.
+    TxList<unsigned char> mBuf;
+    // The message's bytes.
+    const unsigned char *mData = nullptr;
+    //
+    size_t mSize = 0;
+    // Read offset.
+    size_t mOff = 0;
+    //
+    bool mOK = false;
+
+    /**
+     * Returns a pointer to the next n bytes (at a multiple of align) and moves
+     * past them, or nullptr if the message is too short.
+     */
+    const unsigned char *
+    mTake(
+        size_t n,
+        size_t align
+    ) {
+        if (!mOK) return nullptr;
+        const size_t start = (mOff + align - 1) / align * align;
+        if (start > mSize || n > mSize - start) {
+            mOK = false;
+            return nullptr;
+        }
+        mOff = start + n;
+        return mData + start;
+    }
+
+public:
+    //
+    TxMessage(void) = default;
+
+    /**
+     * A message over bytes that someone else owns (e.g. a message nested in
+     * another). The bytes must outlive the TxMessage.
+     */
+    explicit TxMessage(TxListView<unsigned char> bytes)
+        : mData(bytes.data())
+        , mSize(bytes.size())
+        , mOK(true) { ; }
+
+    // Views point into mData, so no copies.
+    TxMessage(const TxMessage &) = delete;
+    //
+    TxMessage &operator=(const TxMessage &) = delete;
+    // Moves keep mBuf's elements where they are, so views stay valid.
+    TxMessage(TxMessage &&) = default;
+    //
+    TxMessage &operator=(TxMessage &&) = default;
+
+    /**
+     * Takes the message out of packet. Returns GLADIUS_SUCCESS if packet
+     * carried a TxMessage.
+     */
+    int
+    unpack(const MRN::PacketPtr &packet) {
+        mBuf = TxList<unsigned char>();
+        mData = nullptr;
+        mSize = 0;
+        mOff = 0;
+        mOK = false;
+        //
+        unsigned char *buf = nullptr;
+        int len = 0;
+        if (0 != packet->unpack(GLADIUS_TX_MESSAGE_FMT, &buf, &len)) {
+            return GLADIUS_ERR_MRNET;
+        }
+        mBuf = TxList<unsigned char>::adopt(buf, len < 0 ? 0 : size_t(len));
+        mData = mBuf.elems;
+        mSize = mBuf.nElems;
+        mOK = true;
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Returns whether or not every read so far succeeded.
+     */
+    bool
+    ok(void) const {
+        return mOK;
+    }
+
+    /**
+     * Returns whether or not everything in the message has been read.
+     */
+    bool
+    atEnd(void) const {
+        return mOK && mOff == mSize;
+    }
+
+    /**
+     * Reads a scalar.
+     */
+    template <class T>
+    bool
+    get(T &v) {
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "TxMessage fields must be trivially copyable"
+        );
+        const auto *p = mTake(sizeof(T), alignof(T));
+        if (!p) return false;
+        (void)memcpy(&v, p, sizeof(T));
+        return true;
+    }
+
+    /**
+     * Reads an array as a view into the message.
+     */
+    template <class T>
+    bool
+    getArray(TxListView<T> &es) {
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "TxMessage fields must be trivially copyable"
+        );
+        uint64_t ne = 0;
+        if (!get(ne)) return false;
+        if (ne > mSize / (sizeof(T) ? sizeof(T) : 1)) {
+            mOK = false;
+            return false;
+        }
+        const auto *p = mTake(sizeof(T) * size_t(ne), alignof(T));
+        if (!p) return false;
+        es = TxListView<T>(reinterpret_cast<const T *>(p), size_t(ne));
+        return true;
+    }
+
+    /**
+     * Reads a string as a NUL-terminated view into the message. If len is not
+     * nullptr, sets it to the string's length.
+     */
+    bool
+    getStr(
+        const char *&s,
+        size_t *len = nullptr
+    ) {
+        uint64_t n = 0;
+        if (!get(n)) return false;
+        if (n >= mSize) {
+            mOK = false;
+            return false;
+        }
+        const auto *p = mTake(size_t(n) + 1, 1);
+        if (!p) return false;
+        if ('\0' != p[n]) {
+            mOK = false;
+            return false;
+        }
+        s = reinterpret_cast<const char *>(p);
+        if (len) *len = size_t(n);
+        return true;
+    }
+
+    /**
+     * Reads a message that was nested with TxMessageWriter::putMessage. m views
+     * our bytes, so it must not outlive us.
+     */
+    bool
+    getMessage(TxMessage &m) {
+        uint64_t n = 0;
+        if (!get(n)) return false;
+        if (n > mSize) {
+            mOK = false;
+            return false;
+        }
+        const auto *p = mTake(size_t(n), sTxMessageAlign);
+        if (!p) return false;
+        m = TxMessage(TxListView<unsigned char>(p, size_t(n)));
+        return true;
+    }
+
+    /**
+     * Reads a string into s (which does allocate).
+     */
+    bool
+    getStr(std::string &s) {
+        const char *p = nullptr;
+        size_t len = 0;
+        if (!getStr(p, &len)) return false;
+        s.assign(p, len);
+        return true;
+    }
+};
+
+} // end toolcommon namespace
+} // end gladius namespace
@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2016      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Pipelined request/response over a plugin's stream. The front-end queues
+ * requests (an operation code and a TxMessage payload each), and sends many of
+ * them as one batch with a single flush. Back-ends answer a whole batch with
+ * one reply batch. Replies are matched to requests by ID, so any number of
+ * requests can be outstanding, and they are delivered to futures or callbacks.
+ *
+ * On the wire, a batch (requests or replies) is a TxMessage sent with the
+ * pipeline's tag that holds entries until its end:
+ *   requests: uint64 id, int32 op,                     nested payload
+ *   replies:  uint64 id, int32 status, uint32 nBackEnds, nested payload
+ */
+
+#pragma once
+
+#include "tool-common/tool-common.h"
+#include "tool-common/tx-message.h"
+#include "tool-common/rank-set.h"
+
+#include "core/core.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+
+#include "mrnet/MRNet.h"
+
+namespace gladius {
+namespace toolcommon {
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * One reply to a request.
+ */
+struct TxReply {
+    // What the replier's handler returned.
+    int status = GLADIUS_SUCCESS;
+    // The number of back-ends that this reply speaks for.
+    unsigned nBackEnds = 0;
+    // The reply's payload. Views the batch that it came in.
+    TxMessage message;
+    // Keeps that batch alive.
+    std::shared_ptr<TxMessage> batch;
+};
+
+/**
+ * Everything that came back for a request.
+ */
+struct TxReplies {
+    // GLADIUS_SUCCESS unless a replier failed (then, what it returned).
+    int status = GLADIUS_SUCCESS;
+    // The number of back-ends that we heard from.
+    unsigned nBackEnds = 0;
+    // Whether or not replies from back-ends that we lost are missing.
+    bool partial = false;
+    //
+    std::vector<TxReply> replies;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * The front-end's end of a pipeline.
+ */
+class TxPipelineFE {
+public:
+    /**
+     * Called with what came back for a request.
+     */
+    typedef std::function<void(TxReplies &)> ReplyFn;
+
+    /**
+     * Returns the UIDs of the back-ends that have been lost so far.
+     */
+    typedef std::function<RankSet(void)> LostFn;
+
+private:
+    // How often drain looks for lost back-ends.
+    static constexpr int sLostCheckIntervalInMS = 100;
+    // Requests waiting for their replies.
+    struct Outstanding {
+        ReplyFn replyFn;
+        TxReplies replies;
+    };
+    //
+    MRN::Stream *mStream = nullptr;
+    // The tag that batches travel with.
+    int mTag = 0;
+    // Queued requests are sent once there are this many.
+    size_t mMaxBatch = 64;
+    // The number of back-ends on the stream.
+    unsigned mNExpected = 0;
+    // The UIDs of the back-ends on the stream.
+    RankSet mEndPoints;
+    //
+    LostFn mLostFn;
+    //
+    uint64_t mNextID = 1;
+    // The batch that is being built.
+    TxMessageWriter mBatch;
+    //
+    size_t mNQueued = 0;
+    //
+    std::unordered_map<uint64_t, Outstanding> mOutstanding;
+    // Packets with other tags that arrived on the stream, for takeOther.
+    std::deque<std::pair<int, MRN::PacketPtr>> mOthers;
+
+    /**
+     *
+     */
+    uint64_t
+    mQueue(
+        int op,
+        const TxMessageWriter &payload,
+        const ReplyFn &replyFn
+    ) {
+        const uint64_t id = mNextID++;
+        mBatch.put(id).put(int32_t(op)).putMessage(payload);
+        ++mNQueued;
+        Outstanding o;
+        o.replyFn = replyFn;
+        mOutstanding.emplace(id, std::move(o));
+        // Errors will show up again at the next flush or progress.
+        if (mNQueued >= mMaxBatch) (void)flush();
+        return id;
+    }
+
+    /**
+     * Returns the number of back-ends on the stream that we haven't lost.
+     */
+    unsigned
+    mNLive(void) const {
+        if (!mLostFn) return mNExpected;
+        unsigned nLost = 0;
+        mLostFn().forEachRange([&](RankSet::Rank lo, RankSet::Rank hi) {
+            for (auto uid = lo; uid <= hi; ++uid) {
+                if (mEndPoints.contains(uid)) ++nLost;
+                if (uid == hi) break;
+            }
+        });
+        return mNExpected - std::min(mNExpected, nLost);
+    }
+
+    /**
+     * Hands replies to the requests that have heard from everyone we haven't
+     * lost.
+     */
+    void
+    mCompleteLost(void) {
+        const unsigned nLive = mNLive();
+        if (nLive == mNExpected) return;
+        for (auto it = mOutstanding.begin(); it != mOutstanding.end(); ) {
+            if (it->second.replies.nBackEnds < nLive) {
+                ++it;
+                continue;
+            }
+            auto o = std::move(it->second);
+            it = mOutstanding.erase(it);
+            o.replies.partial = true;
+            if (o.replyFn) o.replyFn(o.replies);
+        }
+    }
+
+    /**
+     * Waits up to timeoutInMS for packets to arrive.
+     */
+    void
+    mWaitForData(int timeoutInMS) {
+        const int dataFD = mStream->get_DataNotificationFd();
+        if (-1 != dataFD) {
+            struct pollfd pfd = {dataFD, POLLIN, 0};
+            (void)poll(&pfd, 1, timeoutInMS);
+            mStream->clear_DataNotificationFd();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    /**
+     * Hands one reply batch out to the requests that it answers.
+     */
+    int
+    mDispatch(const MRN::PacketPtr &packet) {
+        auto batch = std::make_shared<TxMessage>();
+        int rc = batch->unpack(packet);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        const unsigned nLive = mNLive();
+        while (!batch->atEnd()) {
+            uint64_t id = 0;
+            int32_t status = 0;
+            uint32_t nBackEnds = 0;
+            TxReply reply;
+            if (!batch->get(id) || !batch->get(status) ||
+                !batch->get(nBackEnds) || !batch->getMessage(reply.message)) {
+                return GLADIUS_ERR;
+            }
+            auto it = mOutstanding.find(id);
+            // Not ours (any more).
+            if (mOutstanding.end() == it) continue;
+            reply.status = status;
+            reply.nBackEnds = nBackEnds;
+            reply.batch = batch;
+            auto &replies = it->second.replies;
+            replies.nBackEnds += nBackEnds;
+            if (GLADIUS_SUCCESS != status) replies.status = status;
+            replies.replies.push_back(std::move(reply));
+            if (replies.nBackEnds < nLive) continue;
+            // Everyone (that we haven't lost) has answered.
+            auto o = std::move(it->second);
+            mOutstanding.erase(it);
+            o.replies.partial = o.replies.nBackEnds < mNExpected;
+            if (o.replyFn) o.replyFn(o.replies);
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+public:
+    //
+    TxPipelineFE(void) = default;
+
+    /**
+     * A pipeline over stream whose batches are tagged with tag, which must be
+     * a plugin tag.
+     */
+    int
+    create(
+        MRN::Stream *stream,
+        int tag,
+        size_t maxBatch = 64
+    ) {
+        if (!stream || !isPluginTag(tag) || 0 == maxBatch) {
+            return GLADIUS_ERR;
+        }
+        mStream = stream;
+        mTag = tag;
+        mMaxBatch = maxBatch;
+        mNExpected = stream->get_EndPoints().size();
+        mEndPoints.clear();
+        for (const auto rank : stream->get_EndPoints()) {
+            if (rank < MRN::Rank(GladiusBEMRNetRankBase)) continue;
+            mEndPoints.insert(rank - GladiusBEMRNetRankBase);
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Sets how we find out which back-ends have been lost. Without one, drain
+     * waits for everyone.
+     */
+    void
+    setLostFn(const LostFn &lostFn) {
+        mLostFn = lostFn;
+    }
+
+    /**
+     * Queues a request whose replies go to replyFn (from progress or drain).
+     * Returns the request's ID.
+     */
+    uint64_t
+    submit(
+        int op,
+        const TxMessageWriter &payload,
+        const ReplyFn &replyFn
+    ) {
+        return mQueue(op, payload, replyFn);
+    }
+
+    /**
+     * Queues a request whose replies are delivered through the returned
+     * future. The future is ready once progress or drain has seen them.
+     */
+    std::future<TxReplies>
+    submit(
+        int op,
+        const TxMessageWriter &payload = TxMessageWriter()
+    ) {
+        auto promise = std::make_shared<std::promise<TxReplies>>();
+        auto future = promise->get_future();
+        (void)mQueue(op, payload, [promise](TxReplies &replies) {
+            promise->set_value(std::move(replies));
+        });
+        return future;
+    }
+
+    /**
+     * Sends what is queued as one batch and flushes the stream.
+     */
+    int
+    flush(void) {
+        if (0 == mNQueued) return GLADIUS_SUCCESS;
+        TxMessageWriter batch;
+        std::swap(batch, mBatch);
+        mNQueued = 0;
+        int rc = batch.send(mStream, mTag);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        if (-1 == mStream->flush()) return GLADIUS_ERR_MRNET;
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Handles replies that have arrived. If block, waits for at least one
+     * batch of them (if anything is outstanding). Packets with other tags are
+     * set aside for takeOther.
+     */
+    int
+    progress(bool block) {
+        int tag = 0;
+        MRN::PacketPtr packet;
+        bool shouldBlock = block && !mOutstanding.empty();
+        while (true) {
+            const int status = mStream->recv(&tag, packet, shouldBlock);
+            if (-1 == status) return GLADIUS_ERR_MRNET;
+            if (0 == status) return GLADIUS_SUCCESS;
+            if (tag != mTag) {
+                mOthers.emplace_back(tag, packet);
+                continue;
+            }
+            int rc = mDispatch(packet);
+            if (GLADIUS_SUCCESS != rc) return rc;
+            shouldBlock = false;
+        }
+    }
+
+    /**
+     * Sends what is queued and waits until every outstanding request has its
+     * replies (from everyone that we haven't lost, given a LostFn). Gives up
+     * with GLADIUS_TIMEOUT after timeoutInMS, if not negative. Requests that
+     * are still outstanding then stay that way.
+     */
+    int
+    drain(int timeoutInMS = -1) {
+        using namespace std::chrono;
+        int rc = flush();
+        if (GLADIUS_SUCCESS != rc) return rc;
+        const auto giveUpAt = steady_clock::now() + milliseconds(timeoutInMS);
+        while (!mOutstanding.empty()) {
+            if (!mLostFn && timeoutInMS < 0) {
+                rc = progress(true);
+                if (GLADIUS_SUCCESS != rc) return rc;
+                continue;
+            }
+            rc = progress(false);
+            if (GLADIUS_SUCCESS != rc) return rc;
+            mCompleteLost();
+            if (mOutstanding.empty()) break;
+            int waitInMS = sLostCheckIntervalInMS;
+            if (timeoutInMS >= 0) {
+                const auto left = duration_cast<milliseconds>(
+                                      giveUpAt - steady_clock::now()
+                                  ).count();
+                if (left <= 0) return GLADIUS_TIMEOUT;
+                waitInMS = int(std::min<long long>(waitInMS, left));
+            }
+            mWaitForData(waitInMS);
+        }
+        return GLADIUS_SUCCESS;
+    }
+
+    /**
+     * Hands out (in order of arrival) a packet with a tag other than the
+     * pipeline's that came in on the stream. Returns false if there is none.
+     */
+    bool
+    takeOther(
+        int &tag,
+        MRN::PacketPtr &packet
+    ) {
+        if (mOthers.empty()) return false;
+        tag = mOthers.front().first;
+        packet = mOthers.front().second;
+        mOthers.pop_front();
+        return true;
+    }
+
+    /**
+     * Returns the number of requests without (all of) their replies.
+     */
+    size_t
+    nOutstanding(void) const {
+        return mOutstanding.size();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * The back-end's end of a pipeline.
+ */
+class TxPipelineBE {
+public:
+    /**
+     * Handles request op with payload req, writing its answer into reply.
+     * What it returns is the reply's status.
+     */
+    typedef std::function<
+        int(int op, TxMessage &req, TxMessageWriter &reply)
+    > RequestFn;
+
+    /**
+     * Answers every request in batch (a packet that came in with the
+     * pipeline's tag) with one reply batch on stream.
+     */
+    static int
+    serve(
+        MRN::Stream *stream,
+        int tag,
+        const MRN::PacketPtr &batch,
+        const RequestFn &requestFn
+    ) {
+        TxMessage requests;
+        int rc = requests.unpack(batch);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        TxMessageWriter replies;
+        while (!requests.atEnd()) {
+            uint64_t id = 0;
+            int32_t op = 0;
+            TxMessage req;
+            if (!requests.get(id) || !requests.get(op) ||
+                !requests.getMessage(req)) {
+                return GLADIUS_ERR;
+            }
+            TxMessageWriter reply;
+            const int32_t status = requestFn(op, req, reply);
+            replies.put(id).put(status).put(uint32_t(1)).putMessage(reply);
+        }
+        rc = replies.send(stream, tag);
+        if (GLADIUS_SUCCESS != rc) return rc;
+        if (-1 == stream->flush()) return GLADIUS_ERR_MRNET;
+        return GLADIUS_SUCCESS;
+    }
+};
+
+} // end toolcommon namespace
+} // end gladius namespace
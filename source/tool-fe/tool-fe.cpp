@@ -17,8 +17,13 @@
 #include "core/env.h"
 
 #include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <future>
 #include <string>
+#include <thread>
 
+#include <signal.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -60,6 +65,9 @@ static const std::vector<core::EnvironmentVar> compEnvVars = {
     {ENV_VAR_CONNECT_MAX_RETRIES,
      "Maximum number of connection retries. Default: " +
      std::to_string(ToolFE::sDefaultMaxRetries) + "."
+    },
+    {GLADIUS_ENV_TOOL_FE_PERSISTENT_NAME,
+     "If set, keeps the tool tree and daemons up between plugin sessions."
     }
 };
 
@@ -100,6 +108,23 @@ ToolFE::ToolFE(
     memset(mSessionKey, '\0', sizeof(mSessionKey));
 }
 
+/**
+ * Tool front-end destructor. Takes down the tool tree if it is still up.
+ */
+ToolFE::~ToolFE(void)
+{
+    try {
+        shutdown();
+    }
+    catch (...) {
+        // Nothing we can do about it now.
+    }
+    if (mFEPlugin) {
+        mPluginPack.pluginInfo->pluginDestroy(mFEPlugin);
+        mFEPlugin = nullptr;
+    }
+}
+
 /**
  * Component registration.
  */
@@ -123,6 +148,7 @@ ToolFE::mGetStateFromEnvs(void)
     if (core::utils::envVarSet(GLADIUS_ENV_TOOL_FE_VERBOSE_NAME)) {
         mBeVerbose = true;
     }
+    mPersistent = core::utils::envVarSet(GLADIUS_ENV_TOOL_FE_PERSISTENT_NAME);
     //
     auto rc = core::utils::getEnvAs(
                   ENV_VAR_CONNECT_MAX_RETRIES,
@@ -167,14 +193,28 @@ ToolFE::mGetStateFromEnvs(void)
 int
 ToolFE::mSetupCore(void)
 {
-    string whatsWrong;
-    static const auto envMode = GLADIUS_ENV_DOMAIN_MODE_NAME;
     int rc = GLADIUS_SUCCESS;
     //
     if (GLADIUS_SUCCESS != (rc = mGetStateFromEnvs())) {
         return rc;
     }
     //
+    if (GLADIUS_SUCCESS != (rc = mFindPluginPack())) {
+        return rc;
+    }
+    //
+    return mInitializeParallelLauncher();
+}
+
+/**
+ * Finds a usable plugin pack for the current mode.
+ */
+int
+ToolFE::mFindPluginPack(void)
+{
+    string whatsWrong;
+    static const auto envMode = GLADIUS_ENV_DOMAIN_MODE_NAME;
+    //
     if (!core::utils::envVarSet(envMode)) {
         whatsWrong = "Cannot determine current mode.\nPlease set '"
                    + string(envMode) +  "' and try again.";
@@ -199,7 +239,7 @@ ToolFE::mSetupCore(void)
     // Set member, so we can get the plugin pack later...
     mPathToPluginPack = pathToPluginPackIfAvail;
     //
-    return mInitializeParallelLauncher();
+    return GLADIUS_SUCCESS;
 }
 
 /**
@@ -284,16 +324,49 @@ ToolFE::main(
         if (GLADIUS_SUCCESS != (rc = mSetupCore())) return rc;
         // Perform any actions that need to take place before lash-up.
         if (GLADIUS_SUCCESS != (rc = mPreToolInitActons())) return rc;
+        // Everything launched from here on needs to know the session key.
+        if (GLADIUS_SUCCESS != (rc = mSetSessionKey())) return rc;
+        mLauncherPersonality.setForwardEnvs(mForwardEnvsToBEsIfSetOnFE());
         // Figure out the relevant job characteristics.
         if (GLADIUS_SUCCESS != (rc = mDetermineProcLandscape())) return rc;
-        // Build MRNet network.
-        if (GLADIUS_SUCCESS != (rc = mBuildNetwork())) return rc;
-        // Start lash-up.
+        // Start lash-up (this also builds the MRNet network).
         if (GLADIUS_SUCCESS != (rc = mInitiateToolLashUp())) return rc;
+        mTreeUp = true;
         //
         if (GLADIUS_SUCCESS != (rc = mPostToolInitActons())) return rc;
-        // Now that the base infrastructure is up, now load the user-specified
-        // plugin pack.
+        // Now that the base infrastructure is up, run the first session.
+        rc = newSession();
+        // In persistent mode the tree waits for the next session.
+        if (!mPersistent) {
+            const int src = shutdown();
+            if (GLADIUS_SUCCESS == rc) rc = src;
+        }
+    }
+    catch (const exception &e) {
+        GLADIUS_THROW(e.what());
+    }
+    //
+    return rc;
+}
+
+/**
+ * Runs a plugin session over the tool tree that is already up: the plugin
+ * pack for the current mode is (re)loaded, the BEs are told about it over the
+ * existing protocol stream, and the plugin takes over. None of the lash-up is
+ * repeated, so this is cheap compared to main().
+ */
+int
+ToolFE::newSession(void)
+{
+    VCOMP_COUT("Starting new plugin session..." << endl);
+    //
+    if (!mTreeUp) return GLADIUS_NOT_CONNECTED;
+    //
+    int rc = GLADIUS_SUCCESS;
+    try {
+        // The mode (and so the plugin pack) may have changed since last time.
+        if (GLADIUS_SUCCESS != (rc = mFindPluginPack())) return rc;
+        // Load the user-specified plugin pack.
         if (GLADIUS_SUCCESS != (rc = mLoadPlugins())) return rc;
         // Let the BEs know what plugins they are loading.
         if (GLADIUS_SUCCESS != (rc = mSendPluginInfoToBEs())) return rc;
@@ -307,6 +380,26 @@ ToolFE::main(
     return rc;
 }
 
+/**
+ * Takes down the tool tree. The daemons exit once they see the shutdown.
+ */
+int
+ToolFE::shutdown(void)
+{
+    if (!mTreeUp) return GLADIUS_SUCCESS;
+    //
+    VCOMP_COUT("Shutting down tool tree..." << endl);
+    mTreeUp = false;
+    const int rc = mMRNFE.shutdownBCast();
+    mMRNFE.finalize();
+    // The application carries on without us. Don't leave its launcher behind
+    // as a zombie once it is done.
+    VCOMP_COUT("Waiting for the application to exit..." << endl);
+    mReapApp(-1);
+    //
+    return rc;
+}
+
 /**
  *
  */
@@ -376,9 +469,8 @@ ToolFE::mConnectMRNetTree(void)
     bool connectSuccess = false;
     do {
         VCOMP_COUT("Connection attempt: " << attempt << endl);
-        // Take a break and let things happen...
-        sleep(1);
-        // Try to connect.
+        // Try to connect. Don't sleep first: by the time we get here the
+        // back-ends may well have all reported back.
         const int status = mMRNFE.connect();
         // All done - Get outta here...
         if (GLADIUS_SUCCESS == status) {
@@ -394,13 +486,15 @@ ToolFE::mConnectMRNetTree(void)
             return GLADIUS_ERR;
         }
         // Unlimited retries, so just continue.
-        if (toolcommon::unlimitedRetries == mMaxRetries) continue;
-        if (++attempt >= mMaxRetries) {
+        if (toolcommon::unlimitedRetries != mMaxRetries
+            && ++attempt >= mMaxRetries) {
             GLADIUS_CERR << "Giving up after " << attempt
                          << ((attempt > 1) ? " attempts. " : " attempt. ")
                          << "Not all tool processes reported back..." << endl;
             return GLADIUS_ERR;
         }
+        // Take a break and let things happen...
+        sleep(1);
     } while (true);
     //
     if (connectSuccess) {
@@ -428,7 +522,8 @@ ToolFE::mForwardEnvsToBEsIfSetOnFE(void)
     static const vector<string> envVars = {
         GLADIUS_ENV_GLADIUS_SESSION_KEY,
         GLADIUS_ENV_TOOL_BE_LOG_DIR_NAME,
-        GLADIUS_ENV_TOOL_BE_VERBOSE_NAME
+        GLADIUS_ENV_TOOL_BE_VERBOSE_NAME,
+        GLADIUS_ENV_TOOL_BE_CONNECT_TIMEOUT_NAME
     };
     //
     vector <pair<string, string> > envTups;
@@ -450,15 +545,6 @@ int
 ToolFE::mPublishConnectionInfo(void)
 {
     VCOMP_COUT("Publishing connection information..." << endl);
-    // Set session key. Not ideal, but good enough for now...
-    snprintf(
-        mSessionKey,
-        sizeof(mSessionKey),
-        "%s-%s-%s",
-        "gladius",
-        utils::getHostname().c_str(),
-        to_string(getpid()).c_str()
-    );
     // First get the connection map from the TBON.
     int rc = GLADIUS_SUCCESS;
     vector<toolcommon::ToolLeafInfoT> leafInfos;
@@ -479,16 +565,27 @@ ToolFE::mPublishConnectionInfo(void)
         sLeafInfos.push_back(utils::base64Encode(tmp));
     }
     // Now pushlish to distributed resources
-    if (GLADIUS_SUCCESS !=
-        (rc = mDSI.publishConnectionInfo(mSessionKey, sLeafInfos))) {
-        return rc;
-    }
-    // Done with DSI, so shut it down
-    if (GLADIUS_SUCCESS != (rc = mDSI.shutdown())) {
-        return rc;
-    }
-    //
-    return GLADIUS_SUCCESS;
+    return mDSI.publishConnectionInfo(mSessionKey, sLeafInfos);
+}
+
+/**
+ * Sets the session key and pushes it into the environment, so that anything
+ * we launch (e.g. the user application) can find its connection info. Done
+ * once, before any of the concurrent lash-up steps start.
+ */
+int
+ToolFE::mSetSessionKey(void)
+{
+    // Not ideal, but good enough for now...
+    snprintf(
+        mSessionKey,
+        sizeof(mSessionKey),
+        "%s-%s-%s",
+        "gladius",
+        utils::getHostname().c_str(),
+        to_string(getpid()).c_str()
+    );
+    return utils::setEnv(GLADIUS_ENV_GLADIUS_SESSION_KEY, mSessionKey);
 }
 
 /**
@@ -497,60 +594,133 @@ ToolFE::mPublishConnectionInfo(void)
 int
 ToolFE::mLaunchUserApp(void)
 {
-    // Push session key into the environment.
-    int rc = utils::setEnv(
-                 GLADIUS_ENV_GLADIUS_SESSION_KEY,
-                 mSessionKey
-             );
+    VCOMP_COUT("Launching user application..." << endl);
+    //
+    const int rc = mLauncherPersonality.launch(mAppArgs, mAppPIDs);
     if (GLADIUS_SUCCESS != rc) return rc;
-    // TODO FIXME
-    vector<string> argv = mLauncherArgs.toArgv();
-    vector<string> aargv = mAppArgs.toArgv();
-    argv.insert(end(argv), begin(aargv), end(aargv));
-    core::Args a(argv);
+    VCOMP_COUT("Started " << mAppPIDs.size() << " process(es)." << endl);
     //
-    pid_t p = fork();
-    // child
-    if (0 == p) {
-        execvp(a.argv()[0], a.argv());
-        perror("execvp");
-        _exit(127);
-    }
-    else if (-1 == p) {
-        return GLADIUS_ERR;
+    return GLADIUS_SUCCESS;
+}
+
+/**
+ * Reaps the processes that we started to launch the application, waiting up to
+ * timeoutInMS (-1 means forever) for them to exit. The ones that are still
+ * running stay in mAppPIDs.
+ */
+void
+ToolFE::mReapApp(int timeoutInMS)
+{
+    using namespace std::chrono;
+    //
+    const auto giveUpAt = steady_clock::now() + milliseconds(timeoutInMS);
+    const int options = (timeoutInMS < 0) ? 0 : WNOHANG;
+    while (!mAppPIDs.empty()) {
+        for (auto it = mAppPIDs.begin(); it != mAppPIDs.end(); ) {
+            const pid_t w = waitpid(*it, nullptr, options);
+            if (0 == w) {
+                ++it;
+                continue;
+            }
+            if (-1 == w && EINTR == errno) continue;
+            // Reaped (or not ours to reap).
+            it = mAppPIDs.erase(it);
+        }
+        if (mAppPIDs.empty() || steady_clock::now() >= giveUpAt) break;
+        std::this_thread::sleep_for(milliseconds(10));
     }
+}
+
+/**
+ * Takes down (and reaps) the processes that we started to launch the
+ * application. They get sAppTermGraceInMS to exit after SIGTERM before they
+ * are sent SIGKILL.
+ */
+void
+ToolFE::mKillApp(void)
+{
+    if (mAppPIDs.empty()) return;
     //
-    return GLADIUS_SUCCESS;
+    VCOMP_COUT("Terminating user application..." << endl);
+    for (const auto pid : mAppPIDs) (void)utils::sendSignal(pid, SIGTERM);
+    mReapApp(sAppTermGraceInMS);
+    for (const auto pid : mAppPIDs) (void)utils::sendSignal(pid, SIGKILL);
+    mReapApp(-1);
 }
 
 /**
- * Initiates the tool lash-up bits.
+ * Initiates the tool lash-up bits. Steps that do not depend on one another run
+ * concurrently:
+ *
+ *   landscape --+--> build network --> publish --+--> DSI shutdown
+ *               |                                |
+ *               +--> launch app -----------------+--> connect --> handshake
+ *
+ * The application starts up while the comm nodes are coming up, and its
+ * back-ends wait for their connection info to be published. DSI is shut down
+ * while we wait for the back-ends to connect. If lash-up fails, the
+ * application is taken down with it.
  */
 int
 ToolFE::mInitiateToolLashUp(void)
 {
+    using namespace std::chrono;
+    //
     VCOMP_COUT("Initiating tool lashup..." << endl);
+    const auto start = steady_clock::now();
     try {
         echoLaunchStart(mLauncherArgs, mAppArgs);
-        // Publish connection information across the system.
-        int rc = mPublishConnectionInfo();
-        if (GLADIUS_SUCCESS != rc) return rc;
         // Launch user application containing links into our tool
         // infrastructure.
-        if (GLADIUS_SUCCESS != (rc = mLaunchUserApp())) return rc;
-        // Wait for MRNet tree connections.
-        if (GLADIUS_SUCCESS != (rc = mConnectMRNetTree())) return rc;
+        auto appLaunched = std::async(
+                               std::launch::async,
+                               &ToolFE::mLaunchUserApp,
+                               this
+                           );
+        // Meanwhile, build the MRNet network and publish connection
+        // information across the system.
+        int rc = mBuildNetwork();
+        if (GLADIUS_SUCCESS == rc) rc = mPublishConnectionInfo();
+        // Done with DSI, so shut it down in the background.
+        std::future<int> dsiDown;
+        if (GLADIUS_SUCCESS == rc) {
+            dsiDown = std::async(
+                          std::launch::async,
+                          &dsi::DSI::shutdown,
+                          &mDSI
+                      );
+        }
+        const int appRC = appLaunched.get();
+        if (GLADIUS_SUCCESS == rc) rc = appRC;
+        if (GLADIUS_SUCCESS == rc) {
+            // Wait for MRNet tree connections.
+            rc = mConnectMRNetTree();
+        }
+        const int dsiRC = dsiDown.valid() ? dsiDown.get() : GLADIUS_SUCCESS;
+        if (GLADIUS_SUCCESS == rc) rc = dsiRC;
         // Setup connected MRNet network for core infrastructure.
-        if (GLADIUS_SUCCESS != (rc = mMRNFE.networkInit())) return rc;
+        if (GLADIUS_SUCCESS == rc) rc = mMRNFE.networkInit();
         // Make sure that our core filters are working by performing a handshake
         // between the tool front-end and all the tool leaves (where all
         // communication is going through a set of core filters).
-        if (GLADIUS_SUCCESS != (rc = mMRNFE.handshake())) return rc;
+        if (GLADIUS_SUCCESS == rc) rc = mMRNFE.handshake();
+        if (GLADIUS_SUCCESS != rc) {
+            mKillApp();
+            return rc;
+        }
     }
     catch (const exception &e) {
+        // The launch (if it got that far) is over by now.
+        mKillApp();
         GLADIUS_THROW(e.what());
     }
     //
+    VCOMP_COUT(
+        "Lash-up took "
+        << duration_cast<milliseconds>(steady_clock::now() - start).count()
+        << " ms." << endl
+    );
+    //
     return GLADIUS_SUCCESS;
 }
 
@@ -561,6 +731,11 @@ int
 ToolFE::mLoadPlugins(void)
 {
     VCOMP_COUT("Loading plugins..." << endl);
+    // Done with the last session's plugin, if any.
+    if (mFEPlugin) {
+        mPluginPack.pluginInfo->pluginDestroy(mFEPlugin);
+        mFEPlugin = nullptr;
+    }
     // Get the front-end plugin pack.
     mPluginPack = mPluginManager.getPluginPackFrom(
                       gpa::GladiusPluginPack::PluginFE,
@@ -605,6 +780,7 @@ ToolFE::mEnterPluginMain(void)
             mMRNFE.getProtoStream(),
             mMRNFE.getNetwork()
         );
+        pluginArgs.lostBackEnds = [this] { return mMRNFE.lostBackEnds(); };
         ////////////////////////////////////////////////////////////////////////
         ////////////////////////////////////////////////////////////////////////
         // Front-end Plugin Entry Point.
@@ -615,6 +791,14 @@ ToolFE::mEnterPluginMain(void)
     catch (const exception &e) {
         GLADIUS_THROW(e.what());
     }
+    // The session's results are partial if we lost anyone along the way.
+    const auto lost = mMRNFE.lostBackEnds();
+    if (!lost.empty()) {
+        GLADIUS_CERR_WARN << "Session results exclude " << lost.size()
+                          << " of " << mMRNFE.nExpectedBackEnds()
+                          << " back-end(s), which were lost: " << lost.str()
+                          << endl;
+    }
     //
     return GLADIUS_SUCCESS;
 }
@@ -33,6 +33,10 @@ class ToolFE {
 private:
     // Flag indicating whether or not we'll be verbose about our actions.
     bool mBeVerbose;
+    // Flag indicating whether or not the tool tree outlives plugin sessions.
+    bool mPersistent = false;
+    // Flag indicating whether or not the tool tree is up.
+    bool mTreeUp = false;
 #if 0
     // stdin copy
     int mStdInCopy = 0;
@@ -53,6 +57,8 @@ private:
     core::Args mAppArgs;
     // Launcher arguments.
     core::Args mLauncherArgs;
+    // PIDs of the processes that we started to launch the application.
+    std::vector<pid_t> mAppPIDs;
     // Connection timeout (in seconds).
     toolcommon::timeout_t mConnectionTimeoutInSec;
     // Max number of connection retries.
@@ -71,6 +77,9 @@ private:
     mGetStateFromEnvs(void);
     //
     int
+    mFindPluginPack(void);
+    //
+    int
     mInitializeParallelLauncher(void);
     //
     int
@@ -89,8 +98,17 @@ private:
     mPostToolInitActons(void);
     //
     int
+    mSetSessionKey(void);
+    //
+    int
     mLaunchUserApp(void);
     //
+    void
+    mReapApp(int timeoutInMS);
+    //
+    void
+    mKillApp(void);
+    //
     int
     mInitiateToolLashUp(void);
     //
@@ -111,10 +129,12 @@ public:
     static constexpr toolcommon::timeout_t sDefaultTimeout = 30;
     // Default max number of retry attempts.
     static constexpr toolcommon::retry_t sDefaultMaxRetries = 8;
+    // How long the application gets to exit after SIGTERM (in milliseconds).
+    static constexpr int sAppTermGraceInMS = 5000;
     //
     ToolFE(void);
     //
-    ~ToolFE(void) = default;
+    ~ToolFE(void);
     //
     int
     main(
@@ -123,6 +143,20 @@ public:
     );
     //
     int
+    newSession(void);
+    //
+    int
+    shutdown(void);
+
+    /**
+     * Returns whether or not the tool tree is up (and can take new sessions).
+     */
+    bool
+    treeUp(void) const {
+        return mTreeUp;
+    }
+    //
+    int
     mConnectMRNetTree(void);
     //
     static void
@@ -14,6 +14,8 @@
 #include "core/env.h"
 #include "tool-fe/tool-fe.h"
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -36,6 +38,17 @@ echoCommandUsage(
                       << trmCMD->shortUsage()
                       << std::endl;
 }
+
+/**
+ * Returns the tool front-end whose tool tree is kept up between sessions
+ * (persistent mode), if any.
+ */
+std::unique_ptr<gladius::toolfe::ToolFE> &
+warmToolFE(void)
+{
+    static std::unique_ptr<gladius::toolfe::ToolFE> toolFE;
+    return toolFE;
+}
 }
 
 namespace gladius {
@@ -65,6 +78,8 @@ quitCMDCallback(const EvalInputCmdCallBackArgs &args)
     char answer[8];
     cin.getline(answer, sizeof(answer));
     if (0 == strcmp("Y", answer)) {
+        // Take down a warm tool tree before we go.
+        warmToolFE().reset();
         // Done with REPL
         return false;
     }
@@ -224,13 +239,174 @@ launchCMDCallback(const EvalInputCmdCallBackArgs &args)
         return true;
     }
     //
+    auto &warm = warmToolFE();
+    if (warm && warm->treeUp()) {
+        GLADIUS_CERR_WARN << "A tool tree is already up. Use 'session' to "
+                             "start a new session over it or 'teardown' to "
+                             "take it down." << endl;
+        return true;
+    }
+    //
     args.terminal->TheTerminal().uninstallSignalHandlers();
     // A new instance every time we are here.
-    toolfe::ToolFE toolFE;
+    std::unique_ptr<toolfe::ToolFE> toolFE(new toolfe::ToolFE());
     // Enter the tool's main loop.
-    (void)toolFE.main(core::Args(appArgv), core::Args(launcherArgv));
+    (void)toolFE->main(core::Args(appArgv), core::Args(launcherArgv));
+    // In persistent mode the tree is still up, so hang on to it.
+    if (toolFE->treeUp()) warm = std::move(toolFE);
+    //
+    args.terminal->TheTerminal().installSignalHandlers();
+    // Continue REPL
+    return true;
+}
+
+/**
+ * Starts a new plugin session over a tool tree that is already up.
+ * Expecting:
+ * session
+ */
+inline bool
+sessionCMDCallback(const EvalInputCmdCallBackArgs &args)
+{
+    using namespace std;
     //
+    if (args.argc != 1) {
+        echoCommandUsage(args, args.argv[0]);
+        return true;
+    }
+    auto &warm = warmToolFE();
+    if (!warm || !warm->treeUp()) {
+        GLADIUS_CERR_WARN << "No tool tree is up. Please launch first "
+                             "(with " GLADIUS_ENV_TOOL_FE_PERSISTENT_NAME
+                             " set)." << endl;
+        return true;
+    }
+    args.terminal->TheTerminal().uninstallSignalHandlers();
+    (void)warm->newSession();
+    args.terminal->TheTerminal().installSignalHandlers();
+    // Continue REPL
+    return true;
+}
+
+/**
+ * Runs a session of the plugin mode in the warm tool tree, regardless of the
+ * current mode, after setting envName to envValue (if envName isn't empty).
+ * The mode and envName are put back when the session is over.
+ */
+inline void
+runWarmSessionInMode(
+    const EvalInputCmdCallBackArgs &args,
+    const std::string &mode,
+    const std::string &envName = "",
+    const std::string &envValue = ""
+) {
+    using namespace std;
+    //
+    auto &warm = warmToolFE();
+    if (!warm || !warm->treeUp()) {
+        GLADIUS_CERR_WARN << "No tool tree is up. Please launch first "
+                             "(with " GLADIUS_ENV_TOOL_FE_PERSISTENT_NAME
+                             " set)." << endl;
+        return;
+    }
+    // Sets name to value for the session, and returns what puts name back.
+    const auto setForSession = [](
+        const string &name,
+        const string &value
+    ) -> function<void()> {
+        const bool hadValue = core::utils::envVarSet(name);
+        const string prevValue = hadValue ? core::utils::getEnv(name) : "";
+        (void)core::utils::setEnv(name, value);
+        return [=]() {
+            if (hadValue) {
+                (void)core::utils::setEnv(name, prevValue);
+            }
+            else {
+                int err = 0;
+                (void)core::utils::unsetEnv(name, err);
+            }
+        };
+    };
+    const auto restoreMode = setForSession(
+                                 GLADIUS_ENV_DOMAIN_MODE_NAME, mode
+                             );
+    function<void()> restoreEnv;
+    if (!envName.empty()) {
+        restoreEnv = setForSession(envName, envValue);
+    }
+    args.terminal->TheTerminal().uninstallSignalHandlers();
+    (void)warm->newSession();
     args.terminal->TheTerminal().installSignalHandlers();
+    // Put back the user's environment.
+    if (restoreEnv) restoreEnv();
+    restoreMode();
+}
+
+/**
+ * Runs the live job metrics (top) plugin in the warm tool tree, regardless of
+ * the current mode. The mode is put back when the user quits.
+ * Expecting:
+ * top [REFRESH_MS]
+ */
+inline bool
+topCMDCallback(const EvalInputCmdCallBackArgs &args)
+{
+    if (args.argc < 1 || args.argc > 2) {
+        echoCommandUsage(args, args.argv[0]);
+        return true;
+    }
+    if (2 == args.argc) {
+        runWarmSessionInMode(
+            args, "top", GLADIUS_ENV_TOP_REFRESH_MS_NAME, args.argv[1]
+        );
+    }
+    else {
+        runWarmSessionInMode(args, "top");
+    }
+    // Continue REPL
+    return true;
+}
+
+/**
+ * Runs the live Legion profiling (lprof) plugin in the warm tool tree,
+ * regardless of the current mode. The mode is put back when the user quits.
+ * Expecting:
+ * lprof [PORT]
+ */
+inline bool
+lprofCMDCallback(const EvalInputCmdCallBackArgs &args)
+{
+    if (args.argc < 1 || args.argc > 2) {
+        echoCommandUsage(args, args.argv[0]);
+        return true;
+    }
+    if (2 == args.argc) {
+        runWarmSessionInMode(
+            args, "lprof", GLADIUS_ENV_LPROF_PORT_NAME, args.argv[1]
+        );
+    }
+    else {
+        runWarmSessionInMode(args, "lprof");
+    }
+    // Continue REPL
+    return true;
+}
+
+/**
+ * Takes down a tool tree that was kept up between sessions.
+ * Expecting:
+ * teardown
+ */
+inline bool
+teardownCMDCallback(const EvalInputCmdCallBackArgs &args)
+{
+    if (args.argc != 1) {
+        echoCommandUsage(args, args.argv[0]);
+        return true;
+    }
+    auto &warm = warmToolFE();
+    if (warm) (void)warm->shutdown();
+    warm.reset();
     // Continue REPL
     return true;
 }
@@ -110,6 +110,34 @@ TermCommands Terminal::sTermCommands {
         "launch Help",
         launchCMDCallback
     ),
+    TermCommand(
+        "session",
+        "",
+        "session",
+        "session Help",
+        sessionCMDCallback
+    ),
+    TermCommand(
+        "top",
+        "",
+        "top [REFRESH_MS]",
+        "top Help",
+        topCMDCallback
+    ),
+    TermCommand(
+        "lprof",
+        "",
+        "lprof [PORT]",
+        "lprof Help",
+        lprofCMDCallback
+    ),
+    TermCommand(
+        "teardown",
+        "",
+        "teardown",
+        "teardown Help",
+        teardownCMDCallback
+    ),
     TermCommand(
         "modes",
         "",
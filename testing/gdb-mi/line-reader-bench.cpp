@@ -0,0 +1,213 @@
+/*
+ * Copyright (c)      2016 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the Gladius project. See the LICENSE.txt file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * Micro-benchmark that compares the legacy byte-at-a-time DMI response reader
+ * against core::LineReader on large synthetic GDB/MI responses.
+ *
+ * To Build (from the top-level source directory, after configure)
+ * g++ -std=c++11 -O2 -DHAVE_CONFIG_H -I. -Isource \
+ *     -o line-reader-bench testing/gdb-mi/line-reader-bench.cpp \
+ *     source/core/line-reader.cpp source/core/utils.cpp \
+ *     source/core/exception.cpp source/core/colors.cpp source/core/base64.c
+ *
+ * Usage: line-reader-bench [nFrames] [nResponses]
+ */
+
+#include "core/line-reader.h"
+#include "core/gladius-rc.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+namespace {
+
+const std::string prompt = "(gdb) ";
+
+/**
+ * Builds one synthetic MI response: a console stream record per frame, a
+ * large result record with a stack list, then the prompt.
+ */
+std::string
+genResponse(int nFrames)
+{
+    std::string resp;
+    std::string stack = "^done,stack=[";
+    for (int f = 0; f < nFrames; ++f) {
+        const std::string fs = std::to_string(f);
+        resp += "~\"#" + fs + "  0x00000000004005d6 in compute_" + fs
+              + " (n=42) at target-exe.cpp:" + fs + "\\n\"\n";
+        if (f) stack += ",";
+        stack += "frame={level=\"" + fs + "\",addr=\"0x00000000004005d6\","
+                 "func=\"compute_" + fs + "\",file=\"target-exe.cpp\","
+                 "fullname=\"/tmp/target-exe.cpp\",line=\"" + fs + "\"}";
+    }
+    resp += stack + "]\n" + prompt + "\n";
+    return resp;
+}
+
+/**
+ * Forks a child that writes nResponses copies of resp to a pipe. Returns the
+ * read end.
+ */
+int
+startWriter(
+    const std::string &resp,
+    int nResponses,
+    pid_t &child
+) {
+    int fds[2];
+    if (-1 == pipe(fds)) {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+    child = fork();
+    if (0 == child) {
+        close(fds[0]);
+        for (int r = 0; r < nResponses; ++r) {
+            size_t off = 0;
+            while (off < resp.size()) {
+                ssize_t n = write(fds[1], resp.data() + off, resp.size() - off);
+                if (n <= 0) _exit(EXIT_FAILURE);
+                off += n;
+            }
+        }
+        close(fds[1]);
+        _exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+/**
+ * The reader that DMI used to use: one read(2) per byte and a string
+ * concatenation per line.
+ */
+size_t
+legacyDrain(
+    int fd,
+    char *&lineBuf,
+    size_t &lineBufSize,
+    std::string &result
+) {
+    result = "";
+    do {
+        char c = '\0';
+        size_t nRead = 0;
+        while (1 == read(fd, &c, 1)) {
+            if (nRead == lineBufSize) {
+                lineBufSize *= 2;
+                lineBuf = (char *)realloc(lineBuf, lineBufSize);
+            }
+            lineBuf[nRead] = c;
+            if ('\n' == c) {
+                lineBuf[nRead++] = '\0';
+                break;
+            }
+            ++nRead;
+        }
+        if (0 == nRead) break;
+        result += std::string(lineBuf) + "\n";
+    } while (0 != strcmp(lineBuf, prompt.c_str()));
+    return result.size();
+}
+
+/**
+ *
+ */
+double
+runLegacy(
+    const std::string &resp,
+    int nResponses
+) {
+    pid_t child;
+    const int fd = startWriter(resp, nResponses, child);
+    size_t lineBufSize = 1024 * 16;
+    char *lineBuf = (char *)calloc(lineBufSize, 1);
+    std::string result;
+    //
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < nResponses; ++r) {
+        legacyDrain(fd, lineBuf, lineBufSize, result);
+    }
+    const std::chrono::duration<double> el =
+        std::chrono::steady_clock::now() - start;
+    //
+    free(lineBuf);
+    close(fd);
+    waitpid(child, nullptr, 0);
+    return el.count();
+}
+
+/**
+ *
+ */
+double
+runLineReader(
+    const std::string &resp,
+    int nResponses
+) {
+    pid_t child;
+    const int fd = startWriter(resp, nResponses, child);
+    gladius::core::LineReader reader;
+    if (GLADIUS_SUCCESS != reader.init(fd)) exit(EXIT_FAILURE);
+    std::string result;
+    //
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < nResponses; ++r) {
+        if (GLADIUS_SUCCESS != reader.readUntilLine(prompt, result, true)) {
+            std::cerr << "readUntilLine failed!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    const std::chrono::duration<double> el =
+        std::chrono::steady_clock::now() - start;
+    //
+    if (result != resp) {
+        std::cerr << "Response mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    waitpid(child, nullptr, 0);
+    return el.count();
+}
+
+} // end namespace
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    const int nFrames = (argc > 1) ? atoi(argv[1]) : 2048;
+    const int nResponses = (argc > 2) ? atoi(argv[2]) : 64;
+    //
+    const std::string resp = genResponse(nFrames);
+    const double mib = double(resp.size()) * nResponses / (1024.0 * 1024.0);
+    //
+    const double tLegacy = runLegacy(resp, nResponses);
+    const double tReader = runLineReader(resp, nResponses);
+    //
+    std::cout << "Response Size : " << resp.size() << " B" << std::endl;
+    std::cout << "Responses     : " << nResponses << std::endl;
+    std::cout << "Legacy        : " << tLegacy << " s ("
+              << mib / tLegacy << " MiB/s)" << std::endl;
+    std::cout << "LineReader    : " << tReader << " s ("
+              << mib / tReader << " MiB/s)" << std::endl;
+    std::cout << "Speedup       : " << tLegacy / tReader << "x" << std::endl;
+    //
+    return EXIT_SUCCESS;
+}